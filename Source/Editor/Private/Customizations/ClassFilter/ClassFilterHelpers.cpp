@@ -1,16 +1,27 @@
 // Copyright 2015-2020 Piperift. All Rights Reserved.
 
 #include "ClassFilterHelpers.h"
+#include <Algo/BinarySearch.h>
 #include <Misc/HotReloadInterface.h>
 #include <Editor.h>
 #include <UObject/CoreRedirects.h>
+#include <UObject/UObjectHash.h>
 #include <Animation/AnimBlueprint.h>
 
 #include "UnloadedBlueprintData.h"
 
+#define LOCTEXT_NAMESPACE "ClassFilterHelpers"
+
 
 namespace ClassFilter
 {
+	namespace Helpers
+	{
+		TSharedPtr< FClassHierarchy > ClassHierarchy;
+		FPopulateClassFilter PopulateClassFilterDelegate;
+		bool bPopulateClassHierarchy = false;
+	}
+
 	static void OnModulesChanged(FName ModuleThatChanged, EModuleChangeReason ReasonForChange)
 	{
 		ClassFilter::Helpers::RequestPopulateClassHierarchy();
@@ -28,9 +39,10 @@ namespace ClassFilter
 		IHotReloadInterface& HotReloadSupport = FModuleManager::LoadModuleChecked<IHotReloadInterface>("HotReload");
 		HotReloadSupport.OnHotReload().AddRaw(this, &FClassHierarchy::OnHotReload);
 
-		// Register to have Populate called when a Blueprint is compiled.
-		OnBlueprintCompiledRequestPopulateClassHierarchyDelegateHandle = GEditor->OnBlueprintCompiled().AddStatic(ClassFilter::Helpers::RequestPopulateClassHierarchy);
-		OnClassPackageLoadedOrUnloadedRequestPopulateClassHierarchyDelegateHandle = GEditor->OnClassPackageLoadedOrUnloaded().AddStatic(ClassFilter::Helpers::RequestPopulateClassHierarchy);
+		// Compiled blueprints are updated in place
+		OnBlueprintPreCompileDelegateHandle = GEditor->OnBlueprintPreCompile().AddRaw(this, &FClassHierarchy::OnBlueprintPreCompile);
+		OnBlueprintCompiledDelegateHandle = GEditor->OnBlueprintCompiled().AddRaw(this, &FClassHierarchy::OnBlueprintCompiled);
+		OnClassPackageLoadedOrUnloadedDelegateHandle = GEditor->OnClassPackageLoadedOrUnloaded().AddRaw(this, &FClassHierarchy::OnClassPackageLoadedOrUnloaded);
 
 		FModuleManager::Get().OnModulesChanged().AddStatic(&OnModulesChanged);
 	}
@@ -54,16 +66,16 @@ namespace ClassFilter
 
 			if (GEditor)
 			{
-				// Unregister to have Populate called when a Blueprint is compiled.
-				GEditor->OnBlueprintCompiled().Remove(OnBlueprintCompiledRequestPopulateClassHierarchyDelegateHandle);
-				GEditor->OnClassPackageLoadedOrUnloaded().Remove(OnClassPackageLoadedOrUnloadedRequestPopulateClassHierarchyDelegateHandle);
+				GEditor->OnBlueprintPreCompile().Remove(OnBlueprintPreCompileDelegateHandle);
+				GEditor->OnBlueprintCompiled().Remove(OnBlueprintCompiledDelegateHandle);
+				GEditor->OnClassPackageLoadedOrUnloaded().Remove(OnClassPackageLoadedOrUnloadedDelegateHandle);
 			}
 		}
 
 		FModuleManager::Get().OnModulesChanged().RemoveAll(this);
 	}
 
-	static FSEClassFilterNodePtr CreateNodeForClass(UClass* Class, const TMultiMap<FName, FAssetData>& BlueprintPackageToAssetDataMap)
+	static FSEClassFilterNodePtr CreateNodeForClass(UClass* Class)
 	{
 		// Create the new node so it can be passed to AddChildren, fill it in with if it is placeable, abstract, and/or a brush.
 		TSharedPtr<FSEClassFilterNode> NewNode = MakeShared<FSEClassFilterNode>(Class->GetName(), Class->GetDisplayNameText().ToString());
@@ -78,67 +90,81 @@ namespace ClassFilter
 		return NewNode;
 	}
 
-	void FClassHierarchy::OnHotReload(bool bWasTriggeredAutomatically)
+	FORCEINLINE bool SortClassFilterNodes(const FSEClassFilterNodePtr& A, const FSEClassFilterNodePtr& B)
 	{
-		ClassFilter::Helpers::RequestPopulateClassHierarchy();
+		check(A.IsValid());
+		check(B.IsValid());
+
+		// Pull out the FString, for ease of reading.
+		const FString& AString = *A->GetClassName();
+		const FString& BString = *B->GetClassName();
+
+		return AString < BString;
 	}
 
-	void FClassHierarchy::AddChildren_NoFilter(FSEClassFilterNodePtr& InOutRootNode, const TMultiMap<FName, FAssetData>& BlueprintPackageToAssetDataMap)
+	/** Adds a child keeping the children of a node sorted */
+	static void InsertChildSorted(const FSEClassFilterNodePtr& Parent, const FSEClassFilterNodePtr& Child)
 	{
-		UClass* RootClass = UObject::StaticClass();
-
-		ObjectClassRoot = MakeShared<FSEClassFilterNode>(RootClass->GetName(), RootClass->GetDisplayNameText().ToString());
-		ObjectClassRoot->Class = RootClass;
+		TArray<FSEClassFilterNodePtr>& Children = Parent->GetChildrenList();
+		Children.Insert(Child, Algo::LowerBound(Children, Child, SortClassFilterNodes));
+		Child->ParentNode = Parent;
+	}
 
-		TMap<UClass*, FSEClassFilterNodePtr> Nodes;
+	static bool IsIgnoredClass(const UClass* Class)
+	{
+		// Ignore deprecated and temporary trash classes.
+		return Class->HasAnyClassFlags(CLASS_Deprecated | CLASS_NewerVersionExists) ||
+			FKismetEditorUtilities::IsClassABlueprintSkeleton(Class);
+	}
 
-		Nodes.Add(RootClass, ObjectClassRoot);
+	void FClassHierarchy::OnHotReload(bool bWasTriggeredAutomatically)
+	{
+		ClassFilter::Helpers::RequestPopulateClassHierarchy();
+	}
 
-		TSet<UClass*> Visited;
-		Visited.Add(RootClass);
+	void FClassHierarchy::OnBlueprintPreCompile(UBlueprint* Blueprint)
+	{
+		CompiledBlueprints.AddUnique(Blueprint);
+	}
 
-		// Go through all of the classes children and see if they should be added to the list.
-		for (TObjectIterator<UClass> ClassIt; ClassIt; ++ClassIt)
+	void FClassHierarchy::OnBlueprintCompiled()
+	{
+		if (CompiledBlueprints.Num() <= 0)
 		{
-			UClass* CurrentClass = *ClassIt;
-
-			// Ignore deprecated and temporary trash classes.
-			if (CurrentClass->HasAnyClassFlags(CLASS_Deprecated | CLASS_NewerVersionExists) ||
-				FKismetEditorUtilities::IsClassABlueprintSkeleton(CurrentClass))
-			{
-				continue;
-			}
+			return;
+		}
 
-			FSEClassFilterNodePtr& Entry = Nodes.FindOrAdd(CurrentClass);
-			if (Visited.Contains(CurrentClass))
-			{
-				continue;
-			}
-			else
+		for (const TWeakObjectPtr<UBlueprint>& Blueprint : CompiledBlueprints)
+		{
+			if (Blueprint.IsValid())
 			{
-				while (CurrentClass->GetSuperClass() != nullptr)
+				AddOrUpdateClass(Blueprint->GeneratedClass);
+				if (IsRebuilding())
 				{
-					FSEClassFilterNodePtr& ParentEntry = Nodes.FindOrAdd(CurrentClass->GetSuperClass());
-					if (!ParentEntry.IsValid())
-					{
-						ParentEntry = CreateNodeForClass(CurrentClass->GetSuperClass(), BlueprintPackageToAssetDataMap);
-					}
+					// The rebuild may have listed the class before it was compiled
+					Rebuild->CompiledClasses.Add(Blueprint->GeneratedClass);
+				}
+			}
+		}
+		CompiledBlueprints.Reset();
 
-					FSEClassFilterNodePtr& MyEntry = Nodes.FindOrAdd(CurrentClass);
-					if (!MyEntry.IsValid())
-					{
-						MyEntry = CreateNodeForClass(CurrentClass, BlueprintPackageToAssetDataMap);
-					}
+		// All viewers must refresh.
+		ClassFilter::Helpers::RefreshAll();
+	}
 
-					if (!Visited.Contains(CurrentClass))
-					{
-						ParentEntry->AddChild(MyEntry);
-						Visited.Add(CurrentClass);
-					}
+	void FClassHierarchy::OnClassPackageLoadedOrUnloaded()
+	{
+		if (IsRebuilding())
+		{
+			// Applied to the new tree once it replaces the current one
+			Rebuild->bClassesChanged = true;
+			return;
+		}
 
-					CurrentClass = CurrentClass->GetSuperClass();
-				}
-			}
+		if (SyncLoadedClasses())
+		{
+			// All viewers must refresh.
+			ClassFilter::Helpers::RefreshAll();
 		}
 	}
 
@@ -181,6 +207,12 @@ namespace ClassFilter
 
 	FSEClassFilterNodePtr FClassHierarchy::FindNodeByClassName(const FSEClassFilterNodePtr& InRootNode, const FString& InClassName)
 	{
+		if (InRootNode == ObjectClassRoot)
+		{
+			const FSEClassFilterNodePtr Node = NodesByPath.FindRef(FName{ *InClassName });
+			return (Node.IsValid() && Node->Class.IsValid())? Node : FSEClassFilterNodePtr{};
+		}
+
 		FString NodeClassName = InRootNode->Class.IsValid() ? InRootNode->Class->GetPathName() : FString();
 		if (NodeClassName == InClassName)
 		{
@@ -203,6 +235,12 @@ namespace ClassFilter
 
 	FSEClassFilterNodePtr FClassHierarchy::FindNodeByClass(const FSEClassFilterNodePtr& InRootNode, const UClass* Class)
 	{
+		if (Class && InRootNode == ObjectClassRoot)
+		{
+			const FSEClassFilterNodePtr Node = NodesByPath.FindRef(FName{ *Class->GetPathName() });
+			return (Node.IsValid() && Node->Class == Class)? Node : FSEClassFilterNodePtr{};
+		}
+
 		if (InRootNode->Class.IsValid() && InRootNode->Class == Class)
 		{
 			return InRootNode;
@@ -224,6 +262,11 @@ namespace ClassFilter
 
 	FSEClassFilterNodePtr FClassHierarchy::FindNodeByGeneratedClassPath(const FSEClassFilterNodePtr& InRootNode, FName InGeneratedClassPath)
 	{
+		if (InRootNode == ObjectClassRoot)
+		{
+			return NodesByPath.FindRef(InGeneratedClassPath);
+		}
+
 		if (InRootNode->ClassPath == InGeneratedClassPath)
 		{
 			return InRootNode;
@@ -254,31 +297,6 @@ namespace ClassFilter
 		}
 	}
 
-	bool FClassHierarchy::FindAndRemoveNodeByClassPath(const FSEClassFilterNodePtr& InRootNode, FName InClassPath)
-	{
-		bool bReturnValue = false;
-
-		// Search the children recursively, one of them might have the parent.
-		FSEClassFilterNodePtr ReturnNode;
-		for (int32 i = 0; i < InRootNode->GetChildrenList().Num(); ++i)
-		{
-			const auto& Child = InRootNode->GetChildrenList()[i];
-			if (Child->ClassPath == InClassPath)
-			{
-				InRootNode->GetChildrenList().RemoveAt(i);
-				return true;
-			}
-
-			// Check the child, then check the return to see if it is valid. If it is valid, end the recursion.
-			bReturnValue |= FindAndRemoveNodeByClassPath(Child, InClassPath);
-			if (bReturnValue)
-			{
-				break;
-			}
-		}
-		return bReturnValue;
-	}
-
 	void FClassHierarchy::RemoveAsset(const FAssetData& InRemovedAssetData)
 	{
 		FString ClassObjectPath;
@@ -287,7 +305,14 @@ namespace ClassFilter
 			ClassObjectPath = FPackageName::ExportTextPathToObjectPath(ClassObjectPath);
 		}
 
-		if (FindAndRemoveNodeByClassPath(ObjectClassRoot, FName(*ClassObjectPath)))
+		const FName ClassPath{ *ClassObjectPath };
+		if (IsRebuilding())
+		{
+			// The rebuild listed assets before this one was removed. It is removed once the rebuild finishes
+			Rebuild->RemovedPaths.Add(ClassPath);
+		}
+
+		if (RemoveNode(ClassPath))
 		{
 			// All viewers must refresh.
 			ClassFilter::Helpers::RefreshAll();
@@ -310,8 +335,15 @@ namespace ClassFilter
 					ClassObjectPath = FPackageName::ExportTextPathToObjectPath(ClassObjectPath);
 				}
 
+				if (IsRebuilding())
+				{
+					// The rebuild listed assets before this one was added
+					Rebuild->Blueprints.Add(InAddedAssetData);
+					Rebuild->RemovedPaths.Remove(FName(*ClassObjectPath));
+				}
+
 				// Make sure that the node does not already exist. There is a bit of double adding going on at times and this prevents it.
-				if (!FindNodeByGeneratedClassPath(ObjectClassRoot, FName(*ClassObjectPath)).IsValid())
+				if (!NodesByPath.Contains(FName(*ClassObjectPath)))
 				{
 					FSEClassFilterNodePtr NewNode;
 					LoadUnloadedTagData(NewNode, InAddedAssetData);
@@ -322,13 +354,17 @@ namespace ClassFilter
 					// Resolve the parent's class name locally and use it to find the parent's class.
 					FString ParentClassPath = NewNode->ParentClassPath.ToString();
 					UClass* ParentClass = FindObject<UClass>(nullptr, *ParentClassPath);
-					FSEClassFilterNodePtr ParentNode = FindParent(ObjectClassRoot, NewNode->ParentClassPath, ParentClass);
-					if (ParentNode.IsValid())
+					FSEClassFilterNodePtr ParentNode = NodesByPath.FindRef(NewNode->ParentClassPath);
+					if (!ParentNode.IsValid() && ParentClass)
 					{
-						ParentNode->AddChild(NewNode);
+						ParentNode = FindNodeByClass(ObjectClassRoot, ParentClass);
+					}
 
-						// Make sure the children are properly sorted.
-						SortChildren(ObjectClassRoot);
+					if (ParentNode.IsValid())
+					{
+						// Only this node is sorted, not the whole tree
+						InsertChildSorted(ParentNode, NewNode);
+						IndexNodes(NewNode);
 
 						// All Viewers must repopulate.
 						ClassFilter::Helpers::RefreshAll();
@@ -338,16 +374,146 @@ namespace ClassFilter
 		}
 	}
 
-	FORCEINLINE bool SortClassFilterNodes(const FSEClassFilterNodePtr& A, const FSEClassFilterNodePtr& B)
+	void FClassHierarchy::AddOrUpdateClass(UClass* Class)
 	{
-		check(A.IsValid());
-		check(B.IsValid());
+		if (!Class || IsIgnoredClass(Class))
+		{
+			return;
+		}
 
-		// Pull out the FString, for ease of reading.
-		const FString& AString = *A->GetClassName();
-		const FString& BString = *B->GetClassName();
+		FSEClassFilterNodePtr ParentNode;
+		if (UClass* SuperClass = Class->GetSuperClass())
+		{
+			const FName ParentClassPath{ *SuperClass->GetPathName() };
+			ParentNode = NodesByPath.FindRef(ParentClassPath);
+			if (!ParentNode.IsValid())
+			{
+				AddOrUpdateClass(SuperClass);
+				ParentNode = NodesByPath.FindRef(ParentClassPath);
+			}
+		}
 
-		return AString < BString;
+		const FName ClassPath{ *Class->GetPathName() };
+		FSEClassFilterNodePtr Node = NodesByPath.FindRef(ClassPath);
+		if (!Node.IsValid())
+		{
+			if (ParentNode.IsValid())
+			{
+				Node = CreateNodeForClass(Class);
+				InsertChildSorted(ParentNode, Node);
+				NodesByPath.Add(ClassPath, Node);
+			}
+			return;
+		}
+
+		Node->Class = Class;
+		Node->Blueprint = ClassFilter::Helpers::GetBlueprint(Class);
+		if (ParentNode.IsValid())
+		{
+			Node->ParentClassPath = ParentNode->ClassPath;
+			if (Node->ParentNode.Pin() != ParentNode)
+			{
+				// The blueprint was reparented
+				ReparentNode(Node, ParentNode);
+			}
+		}
+	}
+
+	bool FClassHierarchy::RemoveNode(FName InClassPath)
+	{
+		const FSEClassFilterNodePtr Node = NodesByPath.FindRef(InClassPath);
+		if (!Node.IsValid() || Node == ObjectClassRoot)
+		{
+			return false;
+		}
+
+		if (const FSEClassFilterNodePtr Parent = Node->ParentNode.Pin())
+		{
+			Parent->GetChildrenList().Remove(Node);
+		}
+		Node->ParentNode.Reset();
+		UnindexNodes(Node);
+		return true;
+	}
+
+	bool FClassHierarchy::SyncLoadedClasses()
+	{
+		if (!ObjectClassRoot.IsValid())
+		{
+			return false;
+		}
+
+		bool bChanged = false;
+
+		// Native classes of unloaded packages. Blueprint nodes stay, they are shown as unloaded
+		TArray<FName> UnloadedPaths;
+		TSet<const UClass*> TreeClasses;
+		TreeClasses.Reserve(NodesByPath.Num());
+		for (const auto& Entry : NodesByPath)
+		{
+			const FSEClassFilterNodePtr& Node = Entry.Value;
+			if (const UClass* Class = Node->Class.Get())
+			{
+				TreeClasses.Add(Class);
+			}
+			else if (Node->BlueprintAssetPath.IsNone() && Node != ObjectClassRoot)
+			{
+				UnloadedPaths.Add(Entry.Key);
+			}
+		}
+		for (const FName& Path : UnloadedPaths)
+		{
+			bChanged |= RemoveNode(Path);
+		}
+
+		// Classes are found through the class hash instead of iterating all objects
+		TArray<UObject*> Classes;
+		GetObjectsOfClass(UClass::StaticClass(), Classes, true);
+		for (UObject* Object : Classes)
+		{
+			UClass* Class = static_cast<UClass*>(Object);
+			if (!TreeClasses.Contains(Class) && !IsIgnoredClass(Class))
+			{
+				AddOrUpdateClass(Class);
+				bChanged = true;
+			}
+		}
+		return bChanged;
+	}
+
+	void FClassHierarchy::ReparentNode(const FSEClassFilterNodePtr& Node, const FSEClassFilterNodePtr& NewParent)
+	{
+		check(Node.IsValid() && NewParent.IsValid());
+		if (const FSEClassFilterNodePtr Parent = Node->ParentNode.Pin())
+		{
+			Parent->GetChildrenList().Remove(Node);
+		}
+		InsertChildSorted(NewParent, Node);
+	}
+
+	void FClassHierarchy::IndexNodes(const FSEClassFilterNodePtr& InRootNode)
+	{
+		if (!InRootNode->ClassPath.IsNone())
+		{
+			NodesByPath.Add(InRootNode->ClassPath, InRootNode);
+		}
+		for (const auto& Child : InRootNode->GetChildrenList())
+		{
+			IndexNodes(Child);
+		}
+	}
+
+	void FClassHierarchy::UnindexNodes(const FSEClassFilterNodePtr& InRootNode)
+	{
+		const FSEClassFilterNodePtr* Indexed = NodesByPath.Find(InRootNode->ClassPath);
+		if (Indexed && *Indexed == InRootNode)
+		{
+			NodesByPath.Remove(InRootNode->ClassPath);
+		}
+		for (const auto& Child : InRootNode->GetChildrenList())
+		{
+			UnindexNodes(Child);
+		}
 	}
 
 	void FClassHierarchy::SortChildren(FSEClassFilterNodePtr& InRootNode)
@@ -440,69 +606,191 @@ namespace ClassFilter
 
 	void FClassHierarchy::PopulateClassHierarchy()
 	{
-		TArray< FSEClassFilterNodePtr > RootLevelClasses;
+		GWarn->BeginSlowTask(LOCTEXT("RebuildingClassHierarchy", "Rebuilding Class Hierarchy"), true);
+		BeginRebuild();
+		TickRebuild(0.0);
+		GWarn->EndSlowTask();
+	}
 
-		FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry"));
+	void FClassHierarchy::BeginRebuild()
+	{
+		// Assets and classes are listed by TickRebuild, so that starting a rebuild doesn't stall
+		Rebuild = MakeUnique<FRebuild>();
 
-		// Retrieve all blueprint classes
-		TArray<FAssetData> BlueprintList;
+		UClass* RootClass = UObject::StaticClass();
+		Rebuild->Root = CreateNodeForClass(RootClass);
+		Rebuild->Nodes.Add(Rebuild->Root->ClassPath, Rebuild->Root);
+	}
 
-		FARFilter Filter;
-		Filter.ClassNames.Add(UBlueprint::StaticClass()->GetFName());
-		Filter.ClassNames.Add(UAnimBlueprint::StaticClass()->GetFName());
-		Filter.ClassNames.Add(UBlueprintGeneratedClass::StaticClass()->GetFName());
+	bool FClassHierarchy::TickRebuild(double MaxSeconds)
+	{
+		if (!Rebuild.IsValid())
+		{
+			return true;
+		}
 
-		// Include any Blueprint based objects as well, this includes things like Blutilities, UMG, and GameplayAbility objects
-		Filter.bRecursiveClasses = true;
-		AssetRegistryModule.Get().GetAssets(Filter, BlueprintList);
+		const bool bTimeSliced = MaxSeconds > 0.0;
+		if (bTimeSliced)
+		{
+			// Many viewers may tick in the same frame
+			if (LastRebuildFrame == GFrameCounter)
+			{
+				return false;
+			}
+			LastRebuildFrame = GFrameCounter;
+		}
+
+		const double EndTime = FPlatformTime::Seconds() + MaxSeconds;
+		int32 Steps = 0;
+		auto IsOutOfTime = [bTimeSliced, EndTime, &Steps]()
+		{
+			return bTimeSliced && (++Steps % 64) == 0 && FPlatformTime::Seconds() > EndTime;
+		};
+
+		if (!Rebuild->bListedAssets)
+		{
+			FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry"));
+
+			// Retrieve all blueprint classes
+			FARFilter Filter;
+			Filter.ClassNames.Add(UBlueprint::StaticClass()->GetFName());
+			Filter.ClassNames.Add(UAnimBlueprint::StaticClass()->GetFName());
+			Filter.ClassNames.Add(UBlueprintGeneratedClass::StaticClass()->GetFName());
+
+			// Include any Blueprint based objects as well, this includes things like Blutilities, UMG, and GameplayAbility objects
+			Filter.bRecursiveClasses = true;
+
+			// Assets added since the rebuild started may already be listed. Duplicates are skipped below
+			TArray<FAssetData> Assets;
+			AssetRegistryModule.Get().GetAssets(Filter, Assets);
+			Rebuild->Blueprints.Append(MoveTemp(Assets));
+			Rebuild->bListedAssets = true;
+			if (bTimeSliced)
+			{
+				return false;
+			}
+		}
+
+		if (!Rebuild->bListedClasses)
+		{
+			// Classes are found through the class hash instead of iterating all objects
+			TArray<UObject*> Classes;
+			GetObjectsOfClass(UClass::StaticClass(), Classes, true);
+			Rebuild->Classes.Reserve(Classes.Num());
+			for (UObject* Class : Classes)
+			{
+				Rebuild->Classes.Add(static_cast<UClass*>(Class));
+			}
+			Rebuild->bListedClasses = true;
+			if (bTimeSliced)
+			{
+				return false;
+			}
+		}
 
-		TMultiMap<FName, FAssetData> BlueprintPackageToAssetDataMap;
-		for (int32 AssetIdx = 0; AssetIdx < BlueprintList.Num(); ++AssetIdx)
+		// Blueprint assets go first, so their loaded classes use the nodes with unloaded data
+		while (Rebuild->NextBlueprint < Rebuild->Blueprints.Num())
 		{
 			FSEClassFilterNodePtr NewNode;
-			LoadUnloadedTagData(NewNode, BlueprintList[AssetIdx]);
-			RootLevelClasses.Add(NewNode);
+			LoadUnloadedTagData(NewNode, Rebuild->Blueprints[Rebuild->NextBlueprint++]);
 
-			// Find the blueprint if it's loaded.
-			FindClass(NewNode);
+			// Assets added during the rebuild may already be in the tree as loaded classes
+			if (!Rebuild->Nodes.Contains(NewNode->ClassPath))
+			{
+				// Find the blueprint if it's loaded.
+				FindClass(NewNode);
 
+				Rebuild->BlueprintNodes.Add(NewNode);
+				if (!NewNode->ClassPath.IsNone())
+				{
+					Rebuild->Nodes.Add(NewNode->ClassPath, NewNode);
+				}
+			}
 
-			BlueprintPackageToAssetDataMap.Add(BlueprintList[AssetIdx].PackageName, BlueprintList[AssetIdx]);
+			if (IsOutOfTime())
+			{
+				return false;
+			}
 		}
 
-		AddChildren_NoFilter(ObjectClassRoot, BlueprintPackageToAssetDataMap);
+		while (Rebuild->NextClass < Rebuild->Classes.Num())
+		{
+			UClass* Class = Rebuild->Classes[Rebuild->NextClass++].Get();
+			if (Class && !IsIgnoredClass(Class))
+			{
+				GetOrAddClassNode(Class, Rebuild->Nodes, Rebuild->Root);
+			}
 
-		RootLevelClasses.Add(ObjectClassRoot);
+			if (IsOutOfTime())
+			{
+				return false;
+			}
+		}
 
-		// Second pass to link them to parents.
-		for (int32 CurrentNodeIdx = 0; CurrentNodeIdx < RootLevelClasses.Num(); ++CurrentNodeIdx)
+		// Link unloaded blueprints to their parents by path
+		for (FSEClassFilterNodePtr& Node : Rebuild->BlueprintNodes)
 		{
-			if (RootLevelClasses[CurrentNodeIdx]->ParentClassPath != NAME_None)
+			if (!Node->ParentNode.IsValid() && !Node->ParentClassPath.IsNone())
 			{
-				// Resolve the parent's class name locally and use it to find the parent's class.
-				FString ParentClassPath = RootLevelClasses[CurrentNodeIdx]->ParentClassPath.ToString();
-				const UClass* ParentClass = FindObject<UClass>(nullptr, *ParentClassPath);
-
-				for (int32 SearchNodeIdx = 0; SearchNodeIdx < RootLevelClasses.Num(); ++SearchNodeIdx)
+				if (const FSEClassFilterNodePtr* ParentNode = Rebuild->Nodes.Find(Node->ParentClassPath))
 				{
-					FSEClassFilterNodePtr ParentNode = FindParent(RootLevelClasses[SearchNodeIdx], RootLevelClasses[CurrentNodeIdx]->ParentClassPath, ParentClass);
-					if (ParentNode.IsValid())
-					{
-						// AddUniqueChild makes sure that when a node was generated one by EditorClassHierarchy and one from LoadUnloadedTagData - the proper one is selected
-						ParentNode->AddUniqueChild(RootLevelClasses[CurrentNodeIdx]);
-						RootLevelClasses.RemoveAtSwap(CurrentNodeIdx);
-						--CurrentNodeIdx;
-						break;
-					}
+					(*ParentNode)->AddChild(Node);
 				}
-
 			}
 		}
 
+		FSEClassFilterNodePtr Root = MoveTemp(Rebuild->Root);
+		const TSet<FName> RemovedPaths = MoveTemp(Rebuild->RemovedPaths);
+		const TArray<TWeakObjectPtr<UClass>> CompiledClasses = MoveTemp(Rebuild->CompiledClasses);
+		const bool bClassesChanged = Rebuild->bClassesChanged;
+		Rebuild.Reset();
+
 		// Recursively sort the children.
-		SortChildren(ObjectClassRoot);
+		SortChildren(Root);
+
+		ObjectClassRoot = Root;
+		NodesByPath.Reset();
+		IndexNodes(ObjectClassRoot);
+
+		for (const FName& RemovedPath : RemovedPaths)
+		{
+			RemoveNode(RemovedPath);
+		}
+
+		// Changes that happened after the rebuild listed classes
+		for (const TWeakObjectPtr<UClass>& Class : CompiledClasses)
+		{
+			AddOrUpdateClass(Class.Get());
+		}
+		if (bClassesChanged)
+		{
+			SyncLoadedClasses();
+		}
 
 		// All viewers must refresh.
 		ClassFilter::Helpers::RefreshAll();
+		return true;
+	}
+
+	FSEClassFilterNodePtr FClassHierarchy::GetOrAddClassNode(UClass* Class, TMap<FName, FSEClassFilterNodePtr>& Nodes, const FSEClassFilterNodePtr& Root)
+	{
+		const FName ClassPath{ *Class->GetPathName() };
+		FSEClassFilterNodePtr Node = Nodes.FindRef(ClassPath);
+		if (!Node.IsValid())
+		{
+			Node = CreateNodeForClass(Class);
+			Nodes.Add(ClassPath, Node);
+		}
+
+		if (Node != Root && !Node->ParentNode.IsValid())
+		{
+			if (UClass* SuperClass = Class->GetSuperClass())
+			{
+				GetOrAddClassNode(SuperClass, Nodes, Root)->AddChild(Node);
+			}
+		}
+		return Node;
 	}
 }
+
+#undef LOCTEXT_NAMESPACE
@@ -35,13 +35,50 @@ namespace ClassFilter
 	class FClassHierarchy
 	{
 	private:
+		/** State of a full rebuild that is spread over many frames */
+		struct FRebuild
+		{
+			/** Assets and classes are listed on their own frames */
+			bool bListedAssets = false;
+			bool bListedClasses = false;
+
+			TArray<FAssetData> Blueprints;
+			TArray<FSEClassFilterNodePtr> BlueprintNodes;
+			TArray<TWeakObjectPtr<UClass>> Classes;
+			int32 NextBlueprint = 0;
+			int32 NextClass = 0;
+
+			FSEClassFilterNodePtr Root;
+			TMap<FName, FSEClassFilterNodePtr> Nodes;
+
+			/** Blueprints removed after the rebuild listed its assets */
+			TSet<FName> RemovedPaths;
+
+			/** Blueprints compiled during the rebuild. Applied to the new tree once it replaces the current one */
+			TArray<TWeakObjectPtr<UClass>> CompiledClasses;
+
+			/** Class packages were loaded or unloaded during the rebuild */
+			bool bClassesChanged = false;
+		};
+
 		/** The "Object" class node that is used as a rooting point for the Class Viewer. */
 		FSEClassFilterNodePtr ObjectClassRoot;
 
-		/** Handles to various registered RequestPopulateClassHierarchy delegates */
+		/** All nodes in the tree by class path */
+		TMap<FName, FSEClassFilterNodePtr> NodesByPath;
+
+		/** Full rebuild in progress, if any. The current tree is used until it finishes */
+		TUniquePtr<FRebuild> Rebuild;
+		uint64 LastRebuildFrame = 0;
+
+		/** Blueprints compiled since the last OnBlueprintCompiled */
+		TArray<TWeakObjectPtr<UBlueprint>> CompiledBlueprints;
+
+		/** Handles to various registered delegates */
 		FDelegateHandle OnFilesLoadedRequestPopulateClassHierarchyDelegateHandle;
-		FDelegateHandle OnBlueprintCompiledRequestPopulateClassHierarchyDelegateHandle;
-		FDelegateHandle OnClassPackageLoadedOrUnloadedRequestPopulateClassHierarchyDelegateHandle;
+		FDelegateHandle OnBlueprintPreCompileDelegateHandle;
+		FDelegateHandle OnBlueprintCompiledDelegateHandle;
+		FDelegateHandle OnClassPackageLoadedOrUnloadedDelegateHandle;
 
 
 	public:
@@ -51,6 +88,37 @@ namespace ClassFilter
 		/** Populates the class hierarchy tree, pulling all the loaded and unloaded classes into a master tree. */
 		void PopulateClassHierarchy();
 
+		/** Starts a full rebuild of the tree that will be done by TickRebuild. Restarts it if already in progress.
+		 *	Assets added or removed, blueprints compiled and packages loaded meanwhile are applied to the rebuild instead of restarting it
+		 */
+		void BeginRebuild();
+
+		/** Continues a full rebuild for up to MaxSeconds (0 is unlimited). Only runs once per frame unless unlimited.
+		 *	@return true if there is no rebuild in progress anymore
+		 */
+		bool TickRebuild(double MaxSeconds);
+
+		bool IsRebuilding() const
+		{
+			return Rebuild.IsValid();
+		}
+
+		/** Inserts a loaded class into the tree, or updates its node and moves it if its parent changed. */
+		void AddOrUpdateClass(UClass* Class);
+
+		/** Removes a node and all its children from the tree.
+		 *	@return true if the node existed
+		 */
+		bool RemoveNode(FName InClassPath);
+
+		/** Adds loaded classes missing from the tree and removes native classes that were unloaded.
+		 *	@return true if the tree changed
+		 */
+		bool SyncLoadedClasses();
+
+		/** Moves a node with all its children under a new parent, keeping children sorted. */
+		void ReparentNode(const FSEClassFilterNodePtr& Node, const FSEClassFilterNodePtr& NewParent);
+
 		/** Recursive function to sort a tree.
 		 *	@param InOutRootNode						The current node to sort.
 		 */
@@ -98,15 +166,24 @@ namespace ClassFilter
 
 
 	private:
-		/** Recursive function to build a tree, will not filter.
-		 *	@param InOutRootNode						The node that this function will add the children of to the tree.
-		 *  @param PackageNameToAssetDataMap			The asset registry map of blueprint package names to blueprint data
-		 */
-		void AddChildren_NoFilter(FSEClassFilterNodePtr& InOutRootNode, const TMultiMap<FName, FAssetData>& BlueprintPackageToAssetDataMap);
-
 		/** Called when hot reload has finished */
 		void OnHotReload(bool bWasTriggeredAutomatically);
 
+		void OnBlueprintPreCompile(UBlueprint* Blueprint);
+		void OnBlueprintCompiled();
+
+		/** Called when packages containing classes are loaded or unloaded */
+		void OnClassPackageLoadedOrUnloaded();
+
+		/** @return the node of a class, creating it and the nodes of its parents if needed. Used by rebuilds */
+		FSEClassFilterNodePtr GetOrAddClassNode(UClass* Class, TMap<FName, FSEClassFilterNodePtr>& Nodes, const FSEClassFilterNodePtr& Root);
+
+		/** Adds all nodes under a node to the path index. */
+		void IndexNodes(const FSEClassFilterNodePtr& InRootNode);
+
+		/** Removes all nodes under a node from the path index. */
+		void UnindexNodes(const FSEClassFilterNodePtr& InRootNode);
+
 		/** Finds the node, recursively going deeper into the hierarchy. Does so by comparing generated class package names.
 		 *	@param InGeneratedClassPath		The path of the generated class to find the node for.
 		 *
@@ -129,16 +206,6 @@ namespace ClassFilter
 		 */
 		void FindClass(FSEClassFilterNodePtr InOutClassNode);
 
-		/**
-		 * Recursively searches through the hierarchy to find and remove the asset. Used when deleting assets.
-		 *
-		 * @param InRootNode	The node to start the search with.
-		 * @param InClassPath	The class path of the asset to delete
-		 *
-		 * @return Returns true if the asset was found and deleted successfully.
-		 */
-		bool FindAndRemoveNodeByClassPath(const FSEClassFilterNodePtr& InRootNode, FName InClassPath);
-
 		/** Callback registered to the Asset Registry to be notified when an asset is added. */
 		void AddAsset(const FAssetData& InAddedAssetData);
 
@@ -151,14 +218,19 @@ namespace ClassFilter
 	{
 		DECLARE_MULTICAST_DELEGATE( FPopulateClassFilter );
 
-		/** The class hierarchy that manages the unfiltered class tree for the Class Viewer. */
-		static TSharedPtr< FClassHierarchy > ClassHierarchy;
+		/** Maximum time per frame spent rebuilding the class hierarchy */
+		static constexpr double RebuildSecondsPerFrame = 0.005;
+
+		/** The class hierarchy that manages the unfiltered class tree for the Class Viewer.
+		 * Shared by all translation units, defined in ClassFilterHelpers.cpp
+		 */
+		extern TSharedPtr< FClassHierarchy > ClassHierarchy;
 
 		/** Used to inform any registered Class Viewers to refresh. */
-		static FPopulateClassFilter PopulateClassFilterDelegate;
+		extern FPopulateClassFilter PopulateClassFilterDelegate;
 
 		/** true if the Class Hierarchy should be populated. */
-		static bool bPopulateClassHierarchy;
+		extern bool bPopulateClassHierarchy;
 
 		// Pre-declare these functions.
 		static bool CheckIfBlueprintBase( FSEClassFilterNodePtr InNode );
@@ -214,9 +286,7 @@ namespace ClassFilter
 				ClassHierarchy = MakeShared<FClassHierarchy>();
 
 				// When created, populate the hierarchy.
-				GWarn->BeginSlowTask( LOCTEXT("RebuildingClassHierarchy", "Rebuilding Class Hierarchy"), true );
 				ClassHierarchy->PopulateClassHierarchy();
-				GWarn->EndSlowTask();
 			}
 		}
 
@@ -226,17 +296,17 @@ namespace ClassFilter
 			ClassHierarchy.Reset();
 		}
 
-		/** Will populate the class hierarchy tree if previously requested. */
+		/** Will populate the class hierarchy tree if previously requested.
+		 * The tree is rebuilt over many frames, viewers keep showing the current one until it finishes.
+		 */
 		static void PopulateClassHierarchy()
 		{
 			if(bPopulateClassHierarchy)
 			{
 				bPopulateClassHierarchy = false;
-
-				GWarn->BeginSlowTask( LOCTEXT("RebuildingClassHierarchy", "Rebuilding Class Hierarchy"), true );
-				ClassHierarchy->PopulateClassHierarchy();
-				GWarn->EndSlowTask();
+				ClassHierarchy->BeginRebuild();
 			}
+			ClassHierarchy->TickRebuild(RebuildSecondsPerFrame);
 		}
 
 		/** Will enable the Class Hierarchy to be populated next Tick. */
@@ -9,11 +9,19 @@
 #include <Serialization/ArchiveSaveCompressedProxy.h>
 #include <Serialization/ArchiveLoadCompressedProxy.h>
 #include <SaveGameSystem.h>
+#include <Misc/ScopeLock.h>
 
+#include "Misc/DictionaryCompression.h"
+#include "Misc/SaveEncryption.h"
 #include "SavePreset.h"
 #include "SlotInfo.h"
+#include "SlotCache.h"
 #include "SlotData.h"
+#include "SlotObjectPool.h"
 #include "Multithreading/SaveFileTask.h"
+#include "Storage/FileStorageBackend.h"
+#include "Storage/MemoryStorageBackend.h"
+#include "Storage/PackedStorageBackend.h"
 
 
 static const int SE_SAVEGAME_FILE_TYPE_TAG = 0x0001;		// "sAvG"
@@ -32,23 +40,60 @@ struct FSaveGameFileVersion
 	};
 };
 
-FScopedFileWriter::FScopedFileWriter(FStringView Filename, int32 Flags)
+/** How slot data is compressed. Older files stored a bool, matching None and Zlib */
+enum class ESaveDataCompression : uint32
 {
-	if (!Filename.IsEmpty())
+	None = 0,
+	Zlib = 1,
+	ZlibDictionary = 2
+};
+
+/** Set on the compression of encrypted data. Compression is applied before encryption */
+static const uint32 SE_ENCRYPTED_DATA_FLAG = 0x80000000;
+
+/** Writes to the same slot are serialized, so that checks done before a write still hold while writing */
+namespace SlotLocks
+{
+	struct FSlotLock
+	{
+		FCriticalSection Lock;
+		uint32 Revision = 0;
+	};
+
+	static FCriticalSection RegistryLock;
+	static TMap<FString, TUniquePtr<FSlotLock>> Registry;
+
+
+	static FSlotLock& Find(FStringView SlotName)
+	{
+		FScopeLock ScopeLock(&RegistryLock);
+		TUniquePtr<FSlotLock>& SlotLock = Registry.FindOrAdd(FString(SlotName));
+		if (!SlotLock)
+		{
+			SlotLock = MakeUnique<FSlotLock>();
+		}
+		// Entries are never removed, so the reference stays valid
+		return *SlotLock;
+	}
+}
+
+FScopedFileWriter::FScopedFileWriter(ISaveStorageBackend& Storage, FStringView SlotName)
+{
+	if (!SlotName.IsEmpty())
 	{
-		Writer = IFileManager::Get().CreateFileWriter(Filename.GetData(), Flags);
+		Writer = Storage.CreateWriter(SlotName);
 	}
 }
 
-FScopedFileReader::FScopedFileReader(FStringView Filename, int32 Flags)
-	: ScopedLoadingState(Filename.GetData())
+FScopedFileReader::FScopedFileReader(ISaveStorageBackend& Storage, FStringView SlotName)
+	: ScopedLoadingState(SlotName.GetData())
 {
-	if (!Filename.IsEmpty())
+	if (!SlotName.IsEmpty())
 	{
-		Reader = IFileManager::Get().CreateFileReader(Filename.GetData(), Flags);
-		if (!Reader && !(Flags & FILEREAD_Silent))
+		Reader = Storage.CreateReader(SlotName);
+		if (!Reader)
 		{
-			UE_LOG(LogSaveExtension, Warning, TEXT("Failed to read file '%s' error."), Filename.GetData());
+			UE_LOG(LogSaveExtension, Warning, TEXT("Failed to read slot '%s'."), SlotName.GetData());
 		}
 	}
 }
@@ -76,6 +121,24 @@ bool FSaveFile::IsEmpty() const
 	return FileTypeTag == 0;
 }
 
+bool FSaveFile::IsOutdated() const
+{
+	if (SaveGameFileVersion < FSaveGameFileVersion::LatestVersion || PackageFileUE4Version < GPackageFileUE4Version)
+	{
+		return true;
+	}
+
+	for (const FCustomVersion& Version : CustomVersions.GetAllVersions())
+	{
+		const TOptional<FCustomVersion> CurrentVersion = FCurrentCustomVersions::Get(Version.Key);
+		if (CurrentVersion.IsSet() && CurrentVersion->Version > Version.Version)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
 void FSaveFile::Read(FScopedFileReader& Reader, bool bSkipData)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(FSaveFile::Read);
@@ -118,14 +181,46 @@ void FSaveFile::Read(FScopedFileReader& Reader, bool bSkipData)
 		return;
 	}
 
-	Ar << bIsDataCompressed;
-	if(bIsDataCompressed)
+	uint32 Compression = uint32(ESaveDataCompression::None);
+	Ar << Compression;
+	const bool bEncrypted = (Compression & SE_ENCRYPTED_DATA_FLAG) != 0;
+	const uint32 Method = Compression & ~SE_ENCRYPTED_DATA_FLAG;
+	bIsDataCompressed = Method != uint32(ESaveDataCompression::None);
+
+	int32 UncompressedSize = 0;
+	if (Method == uint32(ESaveDataCompression::ZlibDictionary))
 	{
-		TArray<uint8> CompressedDataBytes;
-		Ar << CompressedDataBytes;
+		Ar << UncompressedSize;
+	}
 
+	FEncryptedBlocks Blocks;
+	if (bEncrypted)
+	{
+		Ar << Blocks;
+	}
+
+	TArray<uint8> StoredDataBytes;
+	Ar << StoredDataBytes;
+
+	// Decrypted in place before decompressing
+	if (bEncrypted && !FSaveEncryption::Decrypt(StoredDataBytes, Compression, Blocks))
+	{
+		UE_LOG(LogSaveExtension, Warning, TEXT("Failed to decrypt data. The encryption key may be missing or wrong"));
+		return;
+	}
+
+	if(Method == uint32(ESaveDataCompression::ZlibDictionary))
+	{
 		TRACE_CPUPROFILER_EVENT_SCOPE(Decompression);
-		FArchiveLoadCompressedProxy Decompressor(CompressedDataBytes, NAME_Zlib);
+		if (!FDictionaryCompression::Decompress(StoredDataBytes, UncompressedSize, DataBytes))
+		{
+			UE_LOG(LogSaveExtension, Warning, TEXT("Failed to decompress data. Its compression dictionary may be missing"));
+		}
+	}
+	else if(bIsDataCompressed)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(Decompression);
+		FArchiveLoadCompressedProxy Decompressor(StoredDataBytes, NAME_Zlib);
 		if (!Decompressor.GetError())
 		{
 			Decompressor << DataBytes;
@@ -138,15 +233,15 @@ void FSaveFile::Read(FScopedFileReader& Reader, bool bSkipData)
 	}
 	else
 	{
-		Ar << DataBytes;
+		DataBytes = MoveTemp(StoredDataBytes);
 	}
 }
 
-void FSaveFile::Write(FScopedFileWriter& Writer, bool bCompressData)
+void FSaveFile::Write(FScopedFileWriter& Writer, const FSaveFileSettings& Settings)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(FSaveFile::Write);
 
-	bIsDataCompressed = bCompressData;
+	bIsDataCompressed = Settings.bUseCompression;
 	FArchive& Ar = Writer.GetArchive();
 
 	{ // Header information
@@ -164,10 +259,18 @@ void FSaveFile::Write(FScopedFileWriter& Writer, bool bCompressData)
 	Ar << DataClassName;
 	if(!DataClassName.IsEmpty())
 	{
-		Ar << bIsDataCompressed;
-		if(bIsDataCompressed)
+		// Small files compress much better with a dictionary
+		uint32 Compression = uint32(ESaveDataCompression::None);
+		int32 UncompressedSize = DataBytes.Num();
+		TArray<uint8> CompressedDataBytes;
+		const FSharedDictionary Dictionary = bIsDataCompressed? FDictionaryCompression::Find(Settings.DictionaryId) : FSharedDictionary{};
+		if (Dictionary.IsValid() && FDictionaryCompression::Compress(*Dictionary, DataBytes, CompressedDataBytes))
+		{
+			Compression = uint32(ESaveDataCompression::ZlibDictionary);
+		}
+		else if(bIsDataCompressed)
 		{
-			TArray<uint8> CompressedDataBytes;
+			Compression = uint32(ESaveDataCompression::Zlib);
 			{ // Compression
 				TRACE_CPUPROFILER_EVENT_SCOPE(Compression);
 				// Compress Object data
@@ -175,12 +278,41 @@ void FSaveFile::Write(FScopedFileWriter& Writer, bool bCompressData)
 				Compressor << DataBytes;
 				Compressor.Close();
 			}
-			Ar << CompressedDataBytes;
 		}
-		else
+
+		TArray<uint8>* StoredDataBytes = Compression == uint32(ESaveDataCompression::None)? &DataBytes : &CompressedDataBytes;
+		const uint32 Method = Compression;
+
+		FEncryptedBlocks Blocks;
+		const bool bEncrypt = Settings.bEncrypt;
+		if (bEncrypt)
 		{
-			Ar << DataBytes;
+			// Encrypted in place. Uncompressed data is copied since this file can still be cached
+			if (Method == uint32(ESaveDataCompression::None))
+			{
+				CompressedDataBytes = DataBytes;
+				StoredDataBytes = &CompressedDataBytes;
+			}
+
+			Compression |= SE_ENCRYPTED_DATA_FLAG;
+			if (!FSaveEncryption::Encrypt(*StoredDataBytes, Compression, Blocks))
+			{
+				UE_LOG(LogSaveExtension, Error, TEXT("Failed to encrypt data. The encryption key may be missing"));
+				Ar.SetError();
+				return;
+			}
 		}
+
+		Ar << Compression;
+		if (Method == uint32(ESaveDataCompression::ZlibDictionary))
+		{
+			Ar << UncompressedSize;
+		}
+		if (bEncrypt)
+		{
+			Ar << Blocks;
+		}
+		Ar << *StoredDataBytes;
 	}
 	Ar.Close();
 }
@@ -208,23 +340,23 @@ void FSaveFile::SerializeData(USlotData* SlotData)
 	SlotData->Serialize(Ar);
 }
 
-USlotInfo* FSaveFile::CreateAndDeserializeInfo(const UObject* Outer) const
+USlotInfo* FSaveFile::CreateAndDeserializeInfo(const UObject* Outer, FSlotObjectPool* Pool) const
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(FSaveFile::CreateAndDeserializeInfo);
 	UObject* Object = nullptr;
-	FFileAdapter::DeserializeObject(Object, InfoClassName, Outer, InfoBytes);
+	FFileAdapter::DeserializeObject(Object, InfoClassName, Outer, InfoBytes, Pool);
 	return Cast<USlotInfo>(Object);
 }
 
-USlotData* FSaveFile::CreateAndDeserializeData(const UObject* Outer) const
+USlotData* FSaveFile::CreateAndDeserializeData(const UObject* Outer, FSlotObjectPool* Pool) const
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(FSaveFile::CreateAndDeserializeData);
 	UObject* Object = nullptr;
-	FFileAdapter::DeserializeObject(Object, DataClassName, Outer, DataBytes);
+	FFileAdapter::DeserializeObject(Object, DataClassName, Outer, DataBytes, Pool);
 	return Cast<USlotData>(Object);
 }
 
-bool FFileAdapter::SaveFile(FStringView SlotName, USlotInfo* Info, USlotData* Data, const bool bUseCompression)
+bool FFileAdapter::SaveFile(ISaveStorageBackend& Storage, FStringView SlotName, USlotInfo* Info, USlotData* Data, const FSaveFileSettings& Settings)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(FFileAdapter::SaveFile);
 
@@ -239,27 +371,80 @@ bool FFileAdapter::SaveFile(FStringView SlotName, USlotInfo* Info, USlotData* Da
 		return false;
 	}
 
-	FScopedFileWriter FileWriter(GetSlotPath(SlotName));
-	if(FileWriter.IsValid())
+	FSaveFile File{};
+	File.SerializeInfo(Info);
+	File.SerializeData(Data);
+	return SaveFile(Storage, SlotName, File, Settings);
+}
+
+bool FFileAdapter::SaveFile(ISaveStorageBackend& Storage, FStringView SlotName, FSaveFile& File, const FSaveFileSettings& Settings, FSlotCache* Cache)
+{
+	if (SlotName.IsEmpty())
 	{
-		FSaveFile File{};
-		File.SerializeInfo(Info);
-		File.SerializeData(Data);
-		File.Write(FileWriter, bUseCompression);
-		return !FileWriter.IsError();
+		return false;
+	}
+
+	SlotLocks::FSlotLock& SlotLock = SlotLocks::Find(SlotName);
+	FScopeLock ScopeLock(&SlotLock.Lock);
+	++SlotLock.Revision;
+	if (!WriteFile(Storage, SlotName, File, Settings))
+	{
+		return false;
+	}
+
+	if (Cache)
+	{
+		// Stored before unlocking, so a newer write can't be replaced by this one
+		Cache->Store(SlotName, SlotLock.Revision, MoveTemp(File));
+	}
+	return true;
+}
+
+bool FFileAdapter::SaveFileIfUnchanged(ISaveStorageBackend& Storage, FStringView SlotName, FSaveFile& File, const FSaveFileSettings& Settings, uint32 Revision)
+{
+	if (SlotName.IsEmpty())
+	{
+		return false;
+	}
+
+	SlotLocks::FSlotLock& SlotLock = SlotLocks::Find(SlotName);
+	FScopeLock ScopeLock(&SlotLock.Lock);
+	if (SlotLock.Revision != Revision)
+	{
+		return false;
+	}
+	++SlotLock.Revision;
+	return WriteFile(Storage, SlotName, File, Settings);
+}
+
+uint32 FFileAdapter::GetSlotRevision(FStringView SlotName)
+{
+	SlotLocks::FSlotLock& SlotLock = SlotLocks::Find(SlotName);
+	// Waits for a write in progress, so that the slot read afterwards is complete
+	FScopeLock ScopeLock(&SlotLock.Lock);
+	return SlotLock.Revision;
+}
+
+bool FFileAdapter::ReadFile(ISaveStorageBackend& Storage, FStringView SlotName, FSaveFile& OutFile, bool bSkipData)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FFileAdapter::ReadFile);
+
+	FScopedFileReader Reader(Storage, SlotName);
+	if(Reader.IsValid())
+	{
+		OutFile.Read(Reader, bSkipData);
+		return true;
 	}
 	return false;
 }
 
-bool FFileAdapter::LoadFile(FStringView SlotName, USlotInfo*& Info, USlotData*& Data, bool bLoadData, const UObject* Outer)
+bool FFileAdapter::LoadFile(ISaveStorageBackend& Storage, FStringView SlotName, USlotInfo*& Info, USlotData*& Data, bool bLoadData, const UObject* Outer)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(FFileAdapter::LoadFile);
 
-	FScopedFileReader Reader(GetSlotPath(SlotName));
-	if(Reader.IsValid())
+	FSaveFile File{};
+	if(ReadFile(Storage, SlotName, File, !bLoadData))
 	{
-		FSaveFile File{};
-		File.Read(Reader, !bLoadData);
 		Info = File.CreateAndDeserializeInfo(Outer);
 		Data = File.CreateAndDeserializeData(Outer);
 		return true;
@@ -267,14 +452,36 @@ bool FFileAdapter::LoadFile(FStringView SlotName, USlotInfo*& Info, USlotData*&
 	return false;
 }
 
-bool FFileAdapter::DeleteFile(FStringView SlotName)
+bool FFileAdapter::DeleteFile(ISaveStorageBackend& Storage, FStringView SlotName)
+{
+	SlotLocks::FSlotLock& SlotLock = SlotLocks::Find(SlotName);
+	FScopeLock ScopeLock(&SlotLock.Lock);
+	++SlotLock.Revision;
+	return Storage.Delete(SlotName);
+}
+
+bool FFileAdapter::DoesFileExist(ISaveStorageBackend& Storage, FStringView SlotName)
+{
+	return Storage.Exists(SlotName);
+}
+
+FSaveStorageRef FFileAdapter::GetDefaultStorage()
 {
-	return IFileManager::Get().Delete(*GetSlotPath(SlotName), true, false, true);
+	static const FSaveStorageRef Files = MakeShared<FFileStorageBackend, ESPMode::ThreadSafe>();
+	return Files;
 }
 
-bool FFileAdapter::DoesFileExist(FStringView SlotName)
+FSaveStorageRef FFileAdapter::MakeStorage(ESaveStorage Type)
 {
-	return IFileManager::Get().FileSize(*GetSlotPath(SlotName)) >= 0;
+	// A single packed backend keeps the pack open. Two of them would overwrite each other's index
+	static const FSaveStorageRef Packed = MakeShared<FPackedStorageBackend, ESPMode::ThreadSafe>();
+
+	switch (Type)
+	{
+	case ESaveStorage::PackedFile: return Packed;
+	case ESaveStorage::Memory:     return MakeShared<FMemoryStorageBackend, ESPMode::ThreadSafe>();
+	default:                       return GetDefaultStorage();
+	}
 }
 
 const FString& FFileAdapter::GetSaveFolder()
@@ -293,7 +500,12 @@ FString FFileAdapter::GetThumbnailPath(FStringView SlotName)
 	return GetSaveFolder() / FString::Printf(TEXT("%s.png"), SlotName.GetData());
 }
 
-void FFileAdapter::DeserializeObject(UObject*& Object, FStringView ClassName, const UObject* Outer, const TArray<uint8>& Bytes)
+FString FFileAdapter::GetSubSlotName(FName SubSlotName)
+{
+	return FString::Printf(TEXT("SubSlots/%s"), *SubSlotName.ToString());
+}
+
+void FFileAdapter::DeserializeObject(UObject*& Object, FStringView ClassName, const UObject* Outer, const TArray<uint8>& Bytes, FSlotObjectPool* Pool)
 {
 	if (ClassName.IsEmpty() || Bytes.Num() <= 0)
 	{
@@ -317,7 +529,14 @@ void FFileAdapter::DeserializeObject(UObject*& Object, FStringView ClassName, co
 			Outer = GetTransientPackage();
 		}
 
-		Object = NewObject<UObject>(const_cast<UObject*>(Outer), ObjectClass);
+		if(Pool)
+		{
+			Object = Pool->Acquire(ObjectClass, const_cast<UObject*>(Outer));
+		}
+		else
+		{
+			Object = NewObject<UObject>(const_cast<UObject*>(Outer), ObjectClass);
+		}
 	}
 	// Can only reuse object if class matches
 	else if(Object->GetClass() != ObjectClass)
@@ -332,3 +551,21 @@ void FFileAdapter::DeserializeObject(UObject*& Object, FStringView ClassName, co
 		Object->Serialize(Ar);
 	}
 }
+
+bool FFileAdapter::WriteFile(ISaveStorageBackend& Storage, FStringView SlotName, FSaveFile& File, const FSaveFileSettings& Settings)
+{
+	// Checked before the writer replaces the previous file
+	if (!File.DataClassName.IsEmpty() && Settings.bEncrypt && !FSaveEncryption::HasKey())
+	{
+		UE_LOG(LogSaveExtension, Error, TEXT("Can't save slot '%s'. Data must be encrypted but there is no encryption key."), SlotName.GetData());
+		return false;
+	}
+
+	FScopedFileWriter FileWriter(Storage, SlotName);
+	if(FileWriter.IsValid())
+	{
+		File.Write(FileWriter, Settings);
+		return !FileWriter.IsError();
+	}
+	return false;
+}
@@ -48,16 +48,11 @@ void ULifetimeComponent::EndPlay(EEndPlayReason::Type Reason)
 
 void ULifetimeComponent::OnSaveBegan(const FSELevelFilter& Filter)
 {
-	if (Filter.ShouldSave(GetOwner()))
-	{
-		Saved.Broadcast();
-	}
+	// Events are already dispatched only to the levels being saved
+	Saved.Broadcast();
 }
 
 void ULifetimeComponent::OnLoadFinished(const FSELevelFilter& Filter, bool bError)
 {
-	if (Filter.ShouldSave(GetOwner()))
-	{
-		Resume.Broadcast();
-	}
+	Resume.Broadcast();
 }
@@ -0,0 +1,186 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Misc/DictionaryCompression.h"
+
+#include <Misc/ScopeLock.h>
+
+THIRD_PARTY_INCLUDES_START
+#include "zlib.h"
+THIRD_PARTY_INCLUDES_END
+
+
+/////////////////////////////////////////////////////
+// FDictionaryCompression
+
+FCriticalSection FDictionaryCompression::Lock;
+TMap<uint32, FSharedDictionary> FDictionaryCompression::Dictionaries;
+
+
+uint32 FDictionaryCompression::Register(const TArray<uint8>& Dictionary)
+{
+	if (Dictionary.Num() <= 0)
+	{
+		return 0;
+	}
+
+	// Same id zlib stores in compressed streams
+	const uint32 Id = adler32(adler32(0L, Z_NULL, 0), Dictionary.GetData(), Dictionary.Num());
+
+	FScopeLock ScopeLock(&Lock);
+	if (!Dictionaries.Contains(Id))
+	{
+		Dictionaries.Add(Id, MakeShared<const TArray<uint8>, ESPMode::ThreadSafe>(Dictionary));
+	}
+	return Id;
+}
+
+FSharedDictionary FDictionaryCompression::Find(uint32 Id)
+{
+	FScopeLock ScopeLock(&Lock);
+	return Id != 0? Dictionaries.FindRef(Id) : FSharedDictionary{};
+}
+
+bool FDictionaryCompression::Compress(const TArray<uint8>& Dictionary, const TArray<uint8>& Uncompressed, TArray<uint8>& OutCompressed)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FDictionaryCompression::Compress);
+
+	z_stream Stream;
+	FMemory::Memzero(Stream);
+	if (deflateInit(&Stream, Z_DEFAULT_COMPRESSION) != Z_OK)
+	{
+		return false;
+	}
+
+	bool bSuccess = deflateSetDictionary(&Stream, Dictionary.GetData(), Dictionary.Num()) == Z_OK;
+	if (bSuccess)
+	{
+		OutCompressed.SetNumUninitialized(deflateBound(&Stream, Uncompressed.Num()));
+		Stream.next_in = const_cast<Bytef*>(Uncompressed.GetData());
+		Stream.avail_in = Uncompressed.Num();
+		Stream.next_out = OutCompressed.GetData();
+		Stream.avail_out = OutCompressed.Num();
+
+		bSuccess = deflate(&Stream, Z_FINISH) == Z_STREAM_END;
+		OutCompressed.SetNum(bSuccess? int32(Stream.total_out) : 0, false);
+	}
+	deflateEnd(&Stream);
+	return bSuccess;
+}
+
+bool FDictionaryCompression::Decompress(const TArray<uint8>& Compressed, int32 UncompressedSize, TArray<uint8>& OutUncompressed)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FDictionaryCompression::Decompress);
+
+	z_stream Stream;
+	FMemory::Memzero(Stream);
+	if (UncompressedSize < 0 || inflateInit(&Stream) != Z_OK)
+	{
+		return false;
+	}
+
+	OutUncompressed.SetNumUninitialized(UncompressedSize);
+	Stream.next_in = const_cast<Bytef*>(Compressed.GetData());
+	Stream.avail_in = Compressed.Num();
+	Stream.next_out = OutUncompressed.GetData();
+	Stream.avail_out = OutUncompressed.Num();
+
+	int Result = inflate(&Stream, Z_FINISH);
+	if (Result == Z_NEED_DICT)
+	{
+		// The stream tells which dictionary it was compressed with
+		FSharedDictionary Dictionary;
+		{
+			FScopeLock ScopeLock(&Lock);
+			Dictionary = Dictionaries.FindRef(uint32(Stream.adler));
+		}
+
+		if (Dictionary.IsValid() && inflateSetDictionary(&Stream, Dictionary->GetData(), Dictionary->Num()) == Z_OK)
+		{
+			Result = inflate(&Stream, Z_FINISH);
+		}
+	}
+	inflateEnd(&Stream);
+
+	const bool bSuccess = Result == Z_STREAM_END && Stream.total_out == uLong(UncompressedSize);
+	if (!bSuccess)
+	{
+		OutUncompressed.Reset();
+	}
+	return bSuccess;
+}
+
+void FDictionaryCompression::Train(const TArray<TArray<uint8>>& Samples, int32 MaxSize, TArray<uint8>& OutDictionary)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FDictionaryCompression::Train);
+
+	static constexpr int32 GramSize = 8;
+	static constexpr int32 SegmentSize = 64;
+	MaxSize = FMath::Clamp(MaxSize, 0, MaxDictionarySize);
+	OutDictionary.Reset();
+
+	auto HashGram = [](const uint8* Data)
+	{
+		return FCrc::MemCrc32(Data, GramSize);
+	};
+
+	// Number of samples containing each byte sequence
+	TMap<uint32, int32> GramFrequency;
+	for (const TArray<uint8>& Sample : Samples)
+	{
+		TSet<uint32> SampleGrams;
+		for (int32 I = 0; I + GramSize <= Sample.Num(); ++I)
+		{
+			SampleGrams.Add(HashGram(Sample.GetData() + I));
+		}
+		for (const uint32 Gram : SampleGrams)
+		{
+			++GramFrequency.FindOrAdd(Gram);
+		}
+	}
+
+	struct FSegment
+	{
+		const uint8* Data = nullptr;
+		int64 Score = 0;
+	};
+	TArray<FSegment> Segments;
+	for (const TArray<uint8>& Sample : Samples)
+	{
+		for (int32 Start = 0; Start + SegmentSize <= Sample.Num(); Start += SegmentSize)
+		{
+			FSegment& Segment = Segments.AddDefaulted_GetRef();
+			Segment.Data = Sample.GetData() + Start;
+			for (int32 I = 0; I + GramSize <= SegmentSize; ++I)
+			{
+				// Sequences only present in one sample are not worth sharing
+				const int32 Frequency = GramFrequency.FindRef(HashGram(Segment.Data + I));
+				Segment.Score += Frequency > 1? Frequency : 0;
+			}
+		}
+	}
+	Segments.Sort([](const FSegment& A, const FSegment& B) { return A.Score > B.Score; });
+
+	// Skip duplicated segments, then write them from least to most common
+	TSet<uint32> UsedSegments;
+	TArray<const FSegment*> Picked;
+	for (const FSegment& Segment : Segments)
+	{
+		if ((Picked.Num() + 1) * SegmentSize > MaxSize || Segment.Score <= 0)
+		{
+			break;
+		}
+
+		bool bAlreadyUsed = false;
+		UsedSegments.Add(FCrc::MemCrc32(Segment.Data, SegmentSize), &bAlreadyUsed);
+		if (!bAlreadyUsed)
+		{
+			Picked.Add(&Segment);
+		}
+	}
+
+	OutDictionary.Reserve(Picked.Num() * SegmentSize);
+	for (int32 I = Picked.Num() - 1; I >= 0; --I)
+	{
+		OutDictionary.Append(Picked[I]->Data, SegmentSize);
+	}
+}
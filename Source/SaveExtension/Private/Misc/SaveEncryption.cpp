@@ -0,0 +1,180 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Misc/SaveEncryption.h"
+
+#include <Async/ParallelFor.h>
+#include <HAL/ThreadSafeBool.h>
+#include <Misc/ScopeLock.h>
+
+#if WITH_SE_ENCRYPTION
+THIRD_PARTY_INCLUDES_START
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+THIRD_PARTY_INCLUDES_END
+#endif
+
+
+/////////////////////////////////////////////////////
+// Helpers
+
+#if WITH_SE_ENCRYPTION
+namespace SaveEncryption
+{
+	static constexpr int32 IVSize = 12;
+
+	static void GetIV(const FGuid& Nonce, int32 BlockIndex, uint8 (&OutIV)[IVSize])
+	{
+		const uint32 Words[3] = { Nonce.A, Nonce.B, Nonce.C ^ uint32(BlockIndex) };
+		FMemory::Memcpy(OutIV, Words, IVSize);
+	}
+
+	static int32 GetNumBlocks(const TArray<uint8>& Bytes)
+	{
+		// Empty data is still authenticated
+		return FMath::Max(1, FMath::DivideAndRoundUp(Bytes.Num(), FSaveEncryption::BlockSize));
+	}
+
+	/** Encrypts or decrypts one block in place */
+	static bool CryptBlock(bool bEncrypt, const TArray<uint8>& Key, TArray<uint8>& Bytes, uint32 Context,
+		const FGuid& Nonce, int32 Index, uint8* Tag)
+	{
+		EVP_CIPHER_CTX* Ctx = EVP_CIPHER_CTX_new();
+		if (!Ctx)
+		{
+			return false;
+		}
+
+		uint8 IV[IVSize];
+		GetIV(Nonce, Index, IV);
+
+		// Blocks can't be removed or moved to another file with a different size without failing authentication
+		const int32 TotalSize = Bytes.Num();
+		uint8 AAD[sizeof(Context) + sizeof(TotalSize)];
+		FMemory::Memcpy(AAD, &Context, sizeof(Context));
+		FMemory::Memcpy(AAD + sizeof(Context), &TotalSize, sizeof(TotalSize));
+
+		const int32 Offset = Index * FSaveEncryption::BlockSize;
+		const int32 Size = FMath::Min(FSaveEncryption::BlockSize, TotalSize - Offset);
+		uint8* Data = Bytes.GetData() + Offset;
+
+		int32 Len = 0;
+		bool bSuccess = false;
+		if (bEncrypt)
+		{
+			bSuccess = EVP_EncryptInit_ex(Ctx, EVP_aes_256_gcm(), nullptr, nullptr, nullptr) == 1 &&
+				EVP_CIPHER_CTX_ctrl(Ctx, EVP_CTRL_GCM_SET_IVLEN, IVSize, nullptr) == 1 &&
+				EVP_EncryptInit_ex(Ctx, nullptr, nullptr, Key.GetData(), IV) == 1 &&
+				EVP_EncryptUpdate(Ctx, nullptr, &Len, AAD, sizeof(AAD)) == 1 &&
+				(Size <= 0 || EVP_EncryptUpdate(Ctx, Data, &Len, Data, Size) == 1) &&
+				EVP_EncryptFinal_ex(Ctx, Data + Size, &Len) == 1 &&
+				EVP_CIPHER_CTX_ctrl(Ctx, EVP_CTRL_GCM_GET_TAG, FSaveEncryption::TagSize, Tag) == 1;
+		}
+		else
+		{
+			bSuccess = EVP_DecryptInit_ex(Ctx, EVP_aes_256_gcm(), nullptr, nullptr, nullptr) == 1 &&
+				EVP_CIPHER_CTX_ctrl(Ctx, EVP_CTRL_GCM_SET_IVLEN, IVSize, nullptr) == 1 &&
+				EVP_DecryptInit_ex(Ctx, nullptr, nullptr, Key.GetData(), IV) == 1 &&
+				EVP_DecryptUpdate(Ctx, nullptr, &Len, AAD, sizeof(AAD)) == 1 &&
+				(Size <= 0 || EVP_DecryptUpdate(Ctx, Data, &Len, Data, Size) == 1) &&
+				EVP_CIPHER_CTX_ctrl(Ctx, EVP_CTRL_GCM_SET_TAG, FSaveEncryption::TagSize, Tag) == 1 &&
+				// Fails if the block or its tag were modified
+				EVP_DecryptFinal_ex(Ctx, Data + Size, &Len) == 1;
+		}
+		EVP_CIPHER_CTX_free(Ctx);
+		return bSuccess;
+	}
+
+	static bool CryptBlocks(bool bEncrypt, const TArray<uint8>& Key, TArray<uint8>& Bytes, uint32 Context,
+		const FGuid& Nonce, TArray<uint8>& Tags)
+	{
+		FThreadSafeBool bFailed = false;
+		ParallelFor(GetNumBlocks(Bytes), [&](int32 Index)
+		{
+			if (!CryptBlock(bEncrypt, Key, Bytes, Context, Nonce, Index, Tags.GetData() + Index * FSaveEncryption::TagSize))
+			{
+				bFailed = true;
+			}
+		});
+		return !bFailed;
+	}
+}
+#endif
+
+
+/////////////////////////////////////////////////////
+// FSaveEncryption
+
+FCriticalSection FSaveEncryption::Lock;
+FSaveEncryption::FSharedKey FSaveEncryption::Key;
+
+
+bool FSaveEncryption::IsSupported()
+{
+	return WITH_SE_ENCRYPTION != 0;
+}
+
+bool FSaveEncryption::SetKey(TArrayView<const uint8> NewKey)
+{
+	FScopeLock ScopeLock(&Lock);
+	if (NewKey.Num() <= 0)
+	{
+		Key.Reset();
+		return true;
+	}
+
+	if (!IsSupported() || NewKey.Num() != KeySize)
+	{
+		return false;
+	}
+	Key = MakeShared<const TArray<uint8>, ESPMode::ThreadSafe>(NewKey.GetData(), NewKey.Num());
+	return true;
+}
+
+bool FSaveEncryption::HasKey()
+{
+	FScopeLock ScopeLock(&Lock);
+	return Key.IsValid();
+}
+
+bool FSaveEncryption::Encrypt(TArray<uint8>& Bytes, uint32 Context, FEncryptedBlocks& OutBlocks)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FSaveEncryption::Encrypt);
+
+#if WITH_SE_ENCRYPTION
+	const FSharedKey CurrentKey = GetKey();
+	if (!CurrentKey.IsValid() || RAND_bytes(reinterpret_cast<uint8*>(&OutBlocks.Nonce), sizeof(FGuid)) != 1)
+	{
+		return false;
+	}
+
+	OutBlocks.Tags.SetNumUninitialized(SaveEncryption::GetNumBlocks(Bytes) * TagSize);
+	return SaveEncryption::CryptBlocks(true, *CurrentKey, Bytes, Context, OutBlocks.Nonce, OutBlocks.Tags);
+#else
+	return false;
+#endif
+}
+
+bool FSaveEncryption::Decrypt(TArray<uint8>& Bytes, uint32 Context, const FEncryptedBlocks& Blocks)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FSaveEncryption::Decrypt);
+
+#if WITH_SE_ENCRYPTION
+	const FSharedKey CurrentKey = GetKey();
+	if (!CurrentKey.IsValid() || Blocks.Tags.Num() != SaveEncryption::GetNumBlocks(Bytes) * TagSize)
+	{
+		return false;
+	}
+
+	// Tags are only read while decrypting
+	TArray<uint8>& Tags = const_cast<TArray<uint8>&>(Blocks.Tags);
+	return SaveEncryption::CryptBlocks(false, *CurrentKey, Bytes, Context, Blocks.Nonce, Tags);
+#else
+	return false;
+#endif
+}
+
+FSaveEncryption::FSharedKey FSaveEncryption::GetKey()
+{
+	FScopeLock ScopeLock(&Lock);
+	return Key;
+}
@@ -0,0 +1,190 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Misc/SaveEventSubscribers.h"
+
+#include <Components/ActorComponent.h>
+#include <Engine/Level.h>
+#include <GameFramework/Actor.h>
+
+#include "SaveExtensionInterface.h"
+
+
+/////////////////////////////////////////////////////
+// FSaveEventSubscribers
+
+void FSaveEventSubscribers::Add(UObject* Object)
+{
+	if (!Object)
+	{
+		return;
+	}
+
+	if (DispatchDepth > 0)
+	{
+		PendingAdds.Add(Object);
+		return;
+	}
+
+	const FObjectKey Key{ Object };
+	if (Locations.Contains(Key))
+	{
+		return;
+	}
+
+	const FObjectKey LevelKey = GetLevelKey(Object);
+	FBucket& Bucket = Buckets.FindOrAdd(LevelKey);
+
+	FLocation& Location = Locations.Add(Key);
+	Location.Level = LevelKey;
+	Location.Index = Bucket.Subscribers.Num();
+
+	FSubscriber& Subscriber = Bucket.Subscribers.AddDefaulted_GetRef();
+	Subscriber.Key = Key;
+	Subscriber.Object = Object;
+	Subscriber.Native = Cast<ISaveExtensionInterface>(Object);
+	Subscriber.ScriptEvents = GetScriptEvents(Object->GetClass());
+}
+
+void FSaveEventSubscribers::Remove(UObject* Object)
+{
+	if (!Object)
+	{
+		return;
+	}
+
+	const FObjectKey Key{ Object };
+	FLocation Location;
+	if (!Locations.RemoveAndCopyValue(Key, Location))
+	{
+		PendingAdds.RemoveSingleSwap(Object, false);
+		return;
+	}
+
+	FBucket* Bucket = Buckets.Find(Location.Level);
+	check(Bucket);
+	if (DispatchDepth > 0)
+	{
+		RemoveDuringDispatch(*Bucket, Location.Index);
+	}
+	else
+	{
+		RemoveAtSwap(*Bucket, Location.Level, Location.Index);
+	}
+}
+
+void FSaveEventSubscribers::AddReferencedObjects(FReferenceCollector& Collector, const UObject* Referencer)
+{
+	for (auto& Pair : Buckets)
+	{
+		for (FSubscriber& Subscriber : Pair.Value.Subscribers)
+		{
+			Collector.AddReferencedObject(Subscriber.Object, Referencer);
+		}
+	}
+	Collector.AddReferencedObjects(PendingAdds, Referencer);
+}
+
+void FSaveEventSubscribers::EndDispatch()
+{
+	if (--DispatchDepth > 0)
+	{
+		return;
+	}
+
+	if (bHasRemoved)
+	{
+		bHasRemoved = false;
+		for (auto It = Buckets.CreateIterator(); It; ++It)
+		{
+			FBucket& Bucket = It.Value();
+			if (!Bucket.bHasRemoved)
+			{
+				continue;
+			}
+			Bucket.bHasRemoved = false;
+
+			Bucket.Subscribers.RemoveAllSwap([](const FSubscriber& Subscriber) {
+				return Subscriber.Key == FObjectKey{};
+			}, false);
+
+			if (Bucket.Subscribers.Num() <= 0)
+			{
+				It.RemoveCurrent();
+				continue;
+			}
+
+			// Swapped subscribers changed their index
+			for (int32 I = 0; I < Bucket.Subscribers.Num(); ++I)
+			{
+				Locations.FindChecked(Bucket.Subscribers[I].Key).Index = I;
+			}
+		}
+	}
+
+	if (PendingAdds.Num() > 0)
+	{
+		TArray<UObject*> Added = MoveTemp(PendingAdds);
+		for (UObject* Object : Added)
+		{
+			Add(Object);
+		}
+	}
+}
+
+void FSaveEventSubscribers::RemoveAtSwap(FBucket& Bucket, FObjectKey LevelKey, int32 Index)
+{
+	Bucket.Subscribers.RemoveAtSwap(Index, 1, false);
+	if (Bucket.Subscribers.IsValidIndex(Index))
+	{
+		Locations.FindChecked(Bucket.Subscribers[Index].Key).Index = Index;
+	}
+	else if (Bucket.Subscribers.Num() <= 0)
+	{
+		Buckets.Remove(LevelKey);
+	}
+}
+
+void FSaveEventSubscribers::RemoveDuringDispatch(FBucket& Bucket, int32 Index)
+{
+	// Indices must stay stable while iterating. Compacted once dispatch ends
+	Bucket.Subscribers[Index] = {};
+	Bucket.bHasRemoved = true;
+	bHasRemoved = true;
+}
+
+ESaveEvent FSaveEventSubscribers::GetScriptEvents(const UClass* Class)
+{
+	if (const ESaveEvent* Events = ScriptEventsByClass.Find(FObjectKey{ Class }))
+	{
+		return *Events;
+	}
+
+	ESaveEvent Events = ESaveEvent::None;
+	auto CheckEvent = [Class, &Events](FName Function, ESaveEvent Event)
+	{
+		if (Class->IsFunctionImplementedInScript(Function))
+		{
+			Events |= Event;
+		}
+	};
+	CheckEvent(GET_FUNCTION_NAME_CHECKED(ISaveExtensionInterface, ReceiveOnSaveBegan),    ESaveEvent::SaveBegan);
+	CheckEvent(GET_FUNCTION_NAME_CHECKED(ISaveExtensionInterface, ReceiveOnSaveFinished), ESaveEvent::SaveFinished);
+	CheckEvent(GET_FUNCTION_NAME_CHECKED(ISaveExtensionInterface, ReceiveOnLoadBegan),    ESaveEvent::LoadBegan);
+	CheckEvent(GET_FUNCTION_NAME_CHECKED(ISaveExtensionInterface, ReceiveOnLoadFinished), ESaveEvent::LoadFinished);
+
+	ScriptEventsByClass.Add(FObjectKey{ Class }, Events);
+	return Events;
+}
+
+FObjectKey FSaveEventSubscribers::GetLevelKey(const UObject* Object)
+{
+	const AActor* Actor = Cast<AActor>(Object);
+	if (!Actor)
+	{
+		if (const auto* Component = Cast<UActorComponent>(Object))
+		{
+			Actor = Component->GetOwner();
+		}
+	}
+	return Actor? FObjectKey{ Actor->GetLevel() } : FObjectKey{};
+}
@@ -0,0 +1,120 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Misc/SaveShards.h"
+
+#include <EngineUtils.h>
+#include <GameFramework/Pawn.h>
+#include <GameFramework/PlayerController.h>
+#include <GameFramework/PlayerState.h>
+#include <Misc/Paths.h>
+
+#include "LevelFilter.h"
+
+
+/////////////////////////////////////////////////////
+// FSaveShards
+
+const FString FSaveShards::OwnerTagPrefix{ TEXT("SaveOwner.") };
+const FName FSaveShards::WorldShardName{ TEXT("World") };
+
+
+FName FSaveShards::MakeOwnerTag(const FString& OwnerId)
+{
+	return FName{ OwnerTagPrefix + OwnerId };
+}
+
+FString FSaveShards::GetPlayerId(const APlayerState* Player)
+{
+	if (!Player)
+	{
+		return {};
+	}
+
+	// Players without an online id (e.g local players) can be given one with an owner tag
+	FString Id = FindOwnerTag(Player);
+	if (Id.IsEmpty())
+	{
+		// Session player ids are not stable, they can't identify a player between sessions
+		const FUniqueNetIdRepl& UniqueId = Player->GetUniqueId();
+		if (!UniqueId.IsValid())
+		{
+			return {};
+		}
+		Id = UniqueId.ToString();
+	}
+	return FPaths::MakeValidFileName(Id, TEXT('_'));
+}
+
+FString FSaveShards::FindOwnerTag(const AActor* Actor)
+{
+	for (const FName& Tag : Actor->Tags)
+	{
+		FString TagStr = Tag.ToString();
+		if (TagStr.RemoveFromStart(OwnerTagPrefix, ESearchCase::CaseSensitive))
+		{
+			return TagStr;
+		}
+	}
+	return {};
+}
+
+FString FSaveShards::GetOwnerId(const AActor* Actor)
+{
+	if (!Actor)
+	{
+		return {};
+	}
+
+	// Explicit owners take priority
+	const FString TagOwner = FindOwnerTag(Actor);
+	if (!TagOwner.IsEmpty())
+	{
+		return TagOwner;
+	}
+
+	// Depth is limited in case owners form a loop
+	const AActor* Current = Actor;
+	for (int32 Depth = 0; Current && Depth < 16; ++Depth, Current = Current->GetOwner())
+	{
+		if (const auto* Player = Cast<APlayerState>(Current))
+		{
+			return GetPlayerId(Player);
+		}
+		else if (const auto* Controller = Cast<APlayerController>(Current))
+		{
+			return GetPlayerId(Controller->PlayerState);
+		}
+		else if (const auto* Pawn = Cast<APawn>(Current))
+		{
+			const APlayerState* Player = Pawn->GetPlayerState();
+			if (Player && !Player->IsABot())
+			{
+				return GetPlayerId(Player);
+			}
+		}
+	}
+	return {};
+}
+
+FName FSaveShards::GetShardName(const FString& OwnerId)
+{
+	return OwnerId.IsEmpty()? WorldShardName : FName{ TEXT("Player_") + OwnerId };
+}
+
+void FSaveShards::GatherActors(const UWorld* World, const FSELevelFilter& Filter, TMap<FString, TArray<AActor*>>& OutActors)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FSaveShards::GatherActors);
+	if (!World)
+	{
+		return;
+	}
+
+	Filter.BakeAllowedClasses();
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		if (Filter.ShouldSave(*It))
+		{
+			OutActors.FindOrAdd(GetOwnerId(*It)).Add(*It);
+		}
+	}
+}
@@ -0,0 +1,168 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Misc/SerializationWatchdog.h"
+
+#include <Components/ActorComponent.h>
+#include <Engine/Level.h>
+#include <GameFramework/Actor.h>
+#include <HAL/IConsoleManager.h>
+#include <Misc/ScopeLock.h>
+#include <UObject/ObjectKey.h>
+
+#include "ISaveExtension.h"
+
+
+/////////////////////////////////////////////////////
+// Helpers
+
+namespace Watchdog
+{
+	static TAutoConsoleVariable<bool> CVarEnabled(
+		TEXT("SaveExtension.Watchdog"), false,
+		TEXT("If true, actors and components are timed while saving and loading to find the slow ones."));
+
+	static TAutoConsoleVariable<int32> CVarSampleRate(
+		TEXT("SaveExtension.Watchdog.SampleRate"), 1,
+		TEXT("One of every N records is timed."));
+
+	static TAutoConsoleVariable<float> CVarThresholdMs(
+		TEXT("SaveExtension.Watchdog.ThresholdMs"), 2.f,
+		TEXT("Records that take longer than this many milliseconds are logged. 0 disables it."));
+
+	static TAutoConsoleVariable<int32> CVarThresholdKB(
+		TEXT("SaveExtension.Watchdog.ThresholdKB"), 256,
+		TEXT("Records bigger than this many kilobytes are logged. 0 disables it."));
+
+	static FAutoConsoleCommandWithWorldArgsAndOutputDevice TopCommand(
+		TEXT("SaveExtension.Watchdog.Top"),
+		TEXT("Prints the classes that took most time to save or load. Optional argument: amount of classes (10 by default)."),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld*, FOutputDevice& Ar)
+		{
+			FSerializationWatchdog::PrintTop(Args.Num() > 0? FCString::Atoi(*Args[0]) : 10, Ar);
+		}));
+
+	static FAutoConsoleCommand ResetCommand(
+		TEXT("SaveExtension.Watchdog.Reset"),
+		TEXT("Clears the stats printed by SaveExtension.Watchdog.Top."),
+		FConsoleCommandDelegate::CreateStatic(&FSerializationWatchdog::Reset));
+
+
+	struct FClassStats
+	{
+		FString ClassName;
+		int32 Count = 0;
+		double Seconds = 0.0;
+		double MaxSeconds = 0.0;
+		int64 Bytes = 0;
+		int32 MaxBytes = 0;
+		FString SlowestName;
+	};
+
+	static FCriticalSection Lock;
+	static TMap<FObjectKey, FClassStats> Stats[2];
+
+
+	static const TCHAR* ToString(FSerializationWatchdog::EOperation Operation)
+	{
+		return Operation == FSerializationWatchdog::EOperation::Save? TEXT("Save") : TEXT("Load");
+	}
+
+	static FString GetLevelName(const UObject* Object)
+	{
+		const ULevel* Level = Object->GetTypedOuter<ULevel>();
+		return Level? Level->GetOutermost()->GetName() : FString{ TEXT("None") };
+	}
+
+	static FString GetDisplayName(const UObject* Object)
+	{
+		if (const auto* Component = Cast<UActorComponent>(Object))
+		{
+			if (const AActor* Owner = Component->GetOwner())
+			{
+				return Owner->GetName() + TEXT(".") + Component->GetName();
+			}
+		}
+		return Object->GetName();
+	}
+}
+
+
+/////////////////////////////////////////////////////
+// FSerializationWatchdog
+
+bool FSerializationWatchdog::ShouldSample()
+{
+	if (!Watchdog::CVarEnabled.GetValueOnAnyThread())
+	{
+		return false;
+	}
+
+	const uint32 SampleRate = FMath::Max(1, Watchdog::CVarSampleRate.GetValueOnAnyThread());
+	static thread_local uint32 Counter = 0;
+	return (++Counter % SampleRate) == 0;
+}
+
+void FSerializationWatchdog::Report(EOperation Operation, const UObject* Object, double Seconds, int32 Bytes)
+{
+	const UClass* Class = Object->GetClass();
+	const float ThresholdMs = Watchdog::CVarThresholdMs.GetValueOnAnyThread();
+	const int32 ThresholdKB = Watchdog::CVarThresholdKB.GetValueOnAnyThread();
+
+	const bool bSlow = ThresholdMs > 0.f && Seconds * 1000.0 >= ThresholdMs;
+	const bool bBig = ThresholdKB > 0 && Bytes >= ThresholdKB * 1024;
+	if (bSlow || bBig)
+	{
+		UE_LOG(LogSaveExtension, Warning, TEXT("%s of '%s' (%s) in level '%s' took %.2fms and %.1fKB"),
+			Watchdog::ToString(Operation), *Watchdog::GetDisplayName(Object), *Class->GetName(),
+			*Watchdog::GetLevelName(Object), Seconds * 1000.0, Bytes / 1024.f);
+	}
+
+	FScopeLock ScopeLock(&Watchdog::Lock);
+	Watchdog::FClassStats& Stats = Watchdog::Stats[uint8(Operation)].FindOrAdd(FObjectKey{ Class });
+	if (Stats.Count <= 0)
+	{
+		Stats.ClassName = Class->GetName();
+	}
+	++Stats.Count;
+	Stats.Seconds += Seconds;
+	Stats.Bytes += Bytes;
+	Stats.MaxBytes = FMath::Max(Stats.MaxBytes, Bytes);
+	if (Seconds > Stats.MaxSeconds)
+	{
+		Stats.MaxSeconds = Seconds;
+		Stats.SlowestName = Watchdog::GetDisplayName(Object);
+	}
+}
+
+void FSerializationWatchdog::PrintTop(int32 Num, FOutputDevice& Ar)
+{
+	Num = FMath::Max(1, Num);
+
+	FScopeLock ScopeLock(&Watchdog::Lock);
+	for (const EOperation Operation : { EOperation::Save, EOperation::Load })
+	{
+		TArray<Watchdog::FClassStats> Sorted;
+		Watchdog::Stats[uint8(Operation)].GenerateValueArray(Sorted);
+		Sorted.Sort([](const Watchdog::FClassStats& A, const Watchdog::FClassStats& B) {
+			return A.Seconds > B.Seconds;
+		});
+
+		Ar.Logf(TEXT("%s: %i classes sampled"), Watchdog::ToString(Operation), Sorted.Num());
+		for (int32 I = 0; I < FMath::Min(Num, Sorted.Num()); ++I)
+		{
+			const Watchdog::FClassStats& Stats = Sorted[I];
+			Ar.Logf(TEXT("  %-40s %6i records  %8.2fms total  %6.2fms avg  %6.2fms max ('%s')  %8.1fKB total  %6.1fKB max"),
+				*Stats.ClassName, Stats.Count,
+				Stats.Seconds * 1000.0, Stats.Seconds * 1000.0 / Stats.Count,
+				Stats.MaxSeconds * 1000.0, *Stats.SlowestName,
+				Stats.Bytes / 1024.f, Stats.MaxBytes / 1024.f);
+		}
+	}
+}
+
+void FSerializationWatchdog::Reset()
+{
+	FScopeLock ScopeLock(&Watchdog::Lock);
+	Watchdog::Stats[0].Empty();
+	Watchdog::Stats[1].Empty();
+}
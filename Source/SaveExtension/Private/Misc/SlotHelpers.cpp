@@ -2,13 +2,13 @@
 
 #include <Misc/SlotHelpers.h>
 #include <Misc/Paths.h>
-#include <HAL/PlatformFilemanager.h>
 
+#include "Storage/SaveStorageBackend.h"
 
-void FSlotHelpers::FindSlotFileNames(TArray<FString>& FoundSlots)
+
+void FSlotHelpers::FindSlotFileNames(ISaveStorageBackend& Storage, TArray<FString>& FoundSlots)
 {
-	FFindSlotVisitor Visitor{ FoundSlots };
-	FPlatformFileManager::Get().GetPlatformFile().IterateDirectory(*FFileAdapter::GetSaveFolder(), Visitor);
+	Storage.FindSlotNames(FoundSlots);
 }
 
 bool FSlotHelpers::FFindSlotVisitor::Visit(const TCHAR* FilenameOrDirectory, bool bIsDirectory)
@@ -2,17 +2,21 @@
 
 #include "Multithreading/DeleteSlotsTask.h"
 
+#include <Async/ParallelFor.h>
 #include <HAL/PlatformFilemanager.h>
 
 #include "FileAdapter.h"
 #include "SavePreset.h"
 #include "SaveManager.h"
 #include "Misc/SlotHelpers.h"
+#include "SlotCache.h"
 #include "HAL/FileManager.h"
+#include "Storage/SaveStorageBackend.h"
 
 
 FDeleteSlotsTask::FDeleteSlotsTask(const USaveManager* InManager, FName SlotName)
 	: Manager(InManager)
+	, Storage(InManager->GetStorage())
 {
 	check(Manager);
 	if(!SlotName.IsNone())
@@ -23,23 +27,46 @@ FDeleteSlotsTask::FDeleteSlotsTask(const USaveManager* InManager, FName SlotName
 
 void FDeleteSlotsTask::DoWork()
 {
+	auto Cache = Manager->GetSlotCache();
 	if (!SpecificSlotName.IsEmpty())
 	{
 		// Delete a single slot by id
-		const FString ScreenshotPath = FFileAdapter::GetThumbnailPath(SpecificSlotName);
-		bool bIsDeleteSlotSuccess = FFileAdapter::DeleteFile(SpecificSlotName);
-		bool bIsDeleteScreenshotSuccess = IFileManager::Get().Delete(*ScreenshotPath, true);
-		bSuccess = bIsDeleteSlotSuccess || bIsDeleteScreenshotSuccess;
+		bSuccess = DeleteSlots(*Storage, MakeArrayView(&SpecificSlotName, 1), Cache.Get());
 	}
 	else
 	{
 		TArray<FString> FoundSlots;
-		FSlotHelpers::FindSlotFileNames(FoundSlots);
+		FSlotHelpers::FindSlotFileNames(*Storage, FoundSlots);
 
-		for (const FString& File : FoundSlots)
+		DeleteSlots(*Storage, FoundSlots, Cache.Get());
+		bSuccess = true;
+
+		if (Cache)
 		{
-			FFileAdapter::DeleteFile(File);
+			Cache->Empty();
 		}
-		bSuccess = true;
 	}
 }
+
+bool FDeleteSlotsTask::DeleteSlots(ISaveStorageBackend& Storage, TArrayView<const FString> SlotNames, FSlotCache* Cache)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FDeleteSlotsTask::DeleteSlots);
+
+	TAtomic<bool> bAnyDeleted{ false };
+	ParallelFor(SlotNames.Num(), [&Storage, SlotNames, Cache, &bAnyDeleted](int32 Index)
+	{
+		const FString& SlotName = SlotNames[Index];
+		const bool bDeletedSlot = FFileAdapter::DeleteFile(Storage, SlotName);
+		const bool bDeletedThumbnail = IFileManager::Get().Delete(*FFileAdapter::GetThumbnailPath(SlotName), false, true, true);
+		if (bDeletedSlot || bDeletedThumbnail)
+		{
+			bAnyDeleted = true;
+		}
+
+		if (Cache)
+		{
+			Cache->Remove(SlotName);
+		}
+	});
+	return bAnyDeleted;
+}
@@ -2,8 +2,64 @@
 
 #include "Multithreading/LoadFileTask.h"
 
+#include "SaveManager.h"
 #include "SavePreset.h"
+#include "Storage/SaveStorageBackend.h"
 
 
 /////////////////////////////////////////////////////
-// FSaveFileTask
+// FLoadFileTask
+
+FLoadFileTask::FLoadFileTask(USaveManager* Manager, FStringView SlotName, FSECancelTokenPtr InCancelToken)
+	: Manager(Manager)
+	, SlotName(SlotName)
+	, Storage(Manager? Manager->GetStorage() : FFileAdapter::GetDefaultStorage())
+	, Cache(Manager? Manager->GetSlotCache() : nullptr)
+	, Pool(Manager? Manager->GetObjectPool() : nullptr)
+	, CancelToken(MoveTemp(InCancelToken))
+{}
+
+void FLoadFileTask::DoWork()
+{
+	if (IsCancelled())
+	{
+		return;
+	}
+
+	if (Cache.IsValid())
+	{
+		File = Cache->FindOrRead(*Storage, SlotName);
+	}
+	else
+	{
+		FSaveFile ReadFile;
+		if (FFileAdapter::ReadFile(*Storage, SlotName, ReadFile))
+		{
+			File = MakeShared<const FSaveFile, ESPMode::ThreadSafe>(MoveTemp(ReadFile));
+		}
+	}
+
+	// If cancelled, decompressed bytes are still cached so that a newer request for this slot can reuse them
+	if (IsCancelled())
+	{
+		File.Reset();
+	}
+}
+
+void FLoadFileTask::CreateObjects()
+{
+	if (bCreatedObjects)
+	{
+		return;
+	}
+	check(IsInGameThread());
+	TRACE_CPUPROFILER_EVENT_SCOPE(FLoadFileTask::CreateObjects);
+	bCreatedObjects = true;
+
+	if (File && !IsCancelled())
+	{
+		SlotInfo = File->CreateAndDeserializeInfo(Manager.Get(), Pool.Get());
+		SlotData = File->CreateAndDeserializeData(Manager.Get(), Pool.Get());
+	}
+	File.Reset();
+}
@@ -2,22 +2,43 @@
 
 #include "Multithreading/LoadSlotInfosTask.h"
 
+#include <Async/ParallelFor.h>
 #include <HAL/PlatformFilemanager.h>
 
 #include "FileAdapter.h"
 #include "SavePreset.h"
 #include "SaveManager.h"
 #include "Misc/SlotHelpers.h"
+#include "SlotCache.h"
+#include "SlotObjectPool.h"
+#include "Storage/SaveStorageBackend.h"
 
 
+FLoadSlotInfosTask::FLoadSlotInfosTask(const USaveManager* Manager, bool bInSortByRecent, const FOnSlotInfosLoaded& Delegate)
+	: Manager(Manager)
+	, Storage(Manager? Manager->GetStorage() : FFileAdapter::GetDefaultStorage())
+	, bSortByRecent(bInSortByRecent)
+	, Delegate(Delegate)
+{}
+
+FLoadSlotInfosTask::FLoadSlotInfosTask(USaveManager* Manager, FName SlotName)
+	: Manager(Manager)
+	, Storage(Manager? Manager->GetStorage() : FFileAdapter::GetDefaultStorage())
+	, SlotName(SlotName)
+{}
+
 void FLoadSlotInfosTask::DoWork()
+{
+	ReadSlots();
+}
+
+void FLoadSlotInfosTask::ReadSlots()
 {
 	if (!Manager)
 	{
 		return;
 	}
 
-	TArray<FString> FileNames;
 	const bool bLoadingSingleInfo = !SlotName.IsNone();
 	if(bLoadingSingleInfo)
 	{
@@ -25,30 +46,59 @@ void FLoadSlotInfosTask::DoWork()
 	}
 	else
 	{
-		FSlotHelpers::FindSlotFileNames(FileNames);
+		FSlotHelpers::FindSlotFileNames(*Storage, FileNames);
 	}
 
-	TArray<FSaveFile> LoadedFiles;
-	LoadedFiles.Reserve(FileNames.Num());
-	for (const FString& FileName : FileNames)
+	TSharedPtr<FSlotCache, ESPMode::ThreadSafe> Cache = Manager->GetSlotCache();
+	TSharedPtr<FSlotObjectPool, ESPMode::ThreadSafe> Pool = Manager->GetObjectPool();
+	if (!bLoadingSingleInfo)
 	{
-		// Load all files
-		FScopedFileReader Reader(FFileAdapter::GetSlotPath(FileName));
-		if(Reader.IsValid())
+		Pool->RetainListedInfos(FileNames);
+	}
+
+	// Infos of files that didn't change since they were listed are reused. Other files are read in parallel.
+	// Recently saved or loaded slots don't need to touch disk
+	ListedInfos.SetNumZeroed(FileNames.Num());
+	Generations.SetNum(FileNames.Num());
+	LoadedFiles.SetNum(FileNames.Num());
+	ParallelFor(FileNames.Num(), [&](int32 Index) {
+		Generations[Index] = Storage->GetGeneration(FileNames[Index]);
+		ListedInfos[Index] = Pool->FindListedInfo(FileNames[Index], Generations[Index]);
+		if (!ListedInfos[Index])
 		{
-			auto& File = LoadedFiles.AddDefaulted_GetRef();
-			File.Read(Reader, true);
+			LoadedFiles[Index] = Cache->FindOrRead(*Storage, FileNames[Index], true);
 		}
+	});
+}
+
+void FLoadSlotInfosTask::CreateInfos()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FLoadSlotInfosTask::CreateInfos);
+	if (!Manager)
+	{
+		return;
 	}
 
 	// For cache friendlyness, we deserialize infos after loading all the files
-	LoadedSlots.Reserve(LoadedFiles.Num());
-	for (const auto& File : LoadedFiles)
+	TSharedPtr<FSlotObjectPool, ESPMode::ThreadSafe> Pool = Manager->GetObjectPool();
+	LoadedSlots.Reserve(FileNames.Num());
+	for (int32 Index = 0; Index < FileNames.Num(); ++Index)
 	{
-		LoadedSlots.Add(File.CreateAndDeserializeInfo(Manager));
+		USlotInfo* Info = ListedInfos[Index];
+		if (!Info && LoadedFiles[Index].IsValid())
+		{
+			Info = LoadedFiles[Index]->CreateAndDeserializeInfo(Manager);
+			Pool->AddListedInfo(FileNames[Index], Generations[Index], Info);
+		}
+
+		if (Info)
+		{
+			LoadedSlots.Add(Info);
+		}
 	}
+	LoadedFiles.Empty();
 
-	if (!bLoadingSingleInfo && bSortByRecent)
+	if (SlotName.IsNone() && bSortByRecent)
 	{
 		LoadedSlots.Sort([](const USlotInfo& A, const USlotInfo& B) {
 			return A.SaveDate > B.SaveDate;
@@ -58,9 +108,12 @@ void FLoadSlotInfosTask::DoWork()
 
 void FLoadSlotInfosTask::AfterFinish()
 {
-	for(auto& Slot : LoadedSlots)
+	check(IsInGameThread());
+	CreateInfos();
+
+	Delegate.ExecuteIfBound(LoadedSlots);
+	if (Promise)
 	{
-		Slot->ClearInternalFlags(EInternalObjectFlags::Async);
+		Promise->SetValue(LoadedSlots);
 	}
-	Delegate.ExecuteIfBound(LoadedSlots);
 }
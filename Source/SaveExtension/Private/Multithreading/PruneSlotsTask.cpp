@@ -0,0 +1,87 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Multithreading/PruneSlotsTask.h"
+
+#include "FileAdapter.h"
+#include "Misc/SlotHelpers.h"
+#include "Multithreading/DeleteSlotsTask.h"
+#include "SlotCache.h"
+#include "Storage/SaveStorageBackend.h"
+
+
+void FPruneSlotsTask::DoWork()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FPruneSlotsTask::DoWork);
+	if (!Retention.IsEnabled())
+	{
+		return;
+	}
+
+	struct FStoredSlot
+	{
+		FString Name;
+		FSlotFileGeneration Generation;
+	};
+
+	TArray<FString> SlotNames;
+	FSlotHelpers::FindSlotFileNames(*Storage, SlotNames);
+
+	TArray<FStoredSlot> Slots;
+	Slots.Reserve(SlotNames.Num());
+	for (FString& SlotName : SlotNames)
+	{
+		FSlotFileGeneration Generation = Storage->GetGeneration(SlotName);
+		if (Generation.IsValid())
+		{
+			Slots.Add({ MoveTemp(SlotName), Generation });
+		}
+	}
+
+	// Most recent first, so the oldest slots are the ones out of the limits. Names break ties
+	Slots.Sort([](const FStoredSlot& A, const FStoredSlot& B) {
+		return A.Generation.Timestamp != B.Generation.Timestamp
+			? A.Generation.Timestamp > B.Generation.Timestamp
+			: A.Name < B.Name;
+	});
+
+	const FDateTime MinTimestamp = Retention.MaxAge > FTimespan::Zero()
+		? FDateTime::UtcNow() - Retention.MaxAge
+		: FDateTime::MinValue();
+
+	// The kept slot takes its share of the limits before any other slot
+	int32 KeptSlots = 0;
+	int64 KeptBytes = 0;
+	if (const FStoredSlot* KeptSlot = Slots.FindByPredicate([this](const FStoredSlot& Slot) { return Slot.Name == KeptSlotName; }))
+	{
+		KeptSlots = 1;
+		KeptBytes = KeptSlot->Generation.Size;
+	}
+
+	for (const FStoredSlot& Slot : Slots)
+	{
+		if (Slot.Name == KeptSlotName)
+		{
+			continue;
+		}
+
+		const bool bKeep =
+			(Retention.MaxSlots <= 0 || KeptSlots < Retention.MaxSlots) &&
+			(Retention.MaxBytes <= 0 || KeptBytes + Slot.Generation.Size <= Retention.MaxBytes) &&
+			Slot.Generation.Timestamp >= MinTimestamp;
+
+		if (bKeep)
+		{
+			++KeptSlots;
+			KeptBytes += Slot.Generation.Size;
+		}
+		else
+		{
+			DeletedSlots.Add(Slot.Name);
+		}
+	}
+
+	if (DeletedSlots.Num() > 0)
+	{
+		FDeleteSlotsTask::DeleteSlots(*Storage, DeletedSlots, Cache.Get());
+	}
+}
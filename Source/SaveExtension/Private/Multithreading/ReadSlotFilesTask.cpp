@@ -0,0 +1,42 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Multithreading/ReadSlotFilesTask.h"
+
+#include <Async/ParallelFor.h>
+
+#include "Storage/SaveStorageBackend.h"
+
+
+FReadSlotFilesTask::FReadSlotFilesTask(FSaveStorageRef InStorage, const TArray<FName>& InSlotNames, bool bInSkipData,
+	TSharedPtr<FSlotCache, ESPMode::ThreadSafe> InCache, const FOnSlotFilesRead& Delegate)
+	: Storage(MoveTemp(InStorage))
+	, bSkipData(bInSkipData)
+	, Cache(MoveTemp(InCache))
+	, Delegate(Delegate)
+{
+	SlotNames.Reserve(InSlotNames.Num());
+	for (FName SlotName : InSlotNames)
+	{
+		SlotNames.Add(SlotName.ToString());
+	}
+}
+
+void FReadSlotFilesTask::DoWork()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FReadSlotFilesTask::DoWork);
+
+	Files.SetNum(SlotNames.Num());
+	ParallelFor(SlotNames.Num(), [this](int32 Index) {
+		if (Cache.IsValid())
+		{
+			Files[Index] = Cache->FindOrRead(*Storage, SlotNames[Index], bSkipData);
+			return;
+		}
+
+		FSaveFile File;
+		if (FFileAdapter::ReadFile(*Storage, SlotNames[Index], File, bSkipData))
+		{
+			Files[Index] = MakeShared<const FSaveFile, ESPMode::ThreadSafe>(MoveTemp(File));
+		}
+	});
+}
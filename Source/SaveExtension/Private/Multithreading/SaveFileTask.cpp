@@ -3,7 +3,37 @@
 #include "Multithreading/SaveFileTask.h"
 
 #include "SavePreset.h"
+#include "Storage/SaveStorageBackend.h"
 
 
 /////////////////////////////////////////////////////
 // FSaveFileTask
+
+void FSaveFileTask::DoWork()
+{
+	bSucceeded = Write();
+	if (OnWritten)
+	{
+		OnWritten(bSucceeded);
+	}
+}
+
+bool FSaveFileTask::Write()
+{
+	if (!Cache.IsValid() || !Cache->IsEnabled())
+	{
+		return FFileAdapter::SaveFile(*Storage, SlotName, Info, Data, Settings);
+	}
+
+	if (!ensureMsgf(Info, TEXT("Info object must be valid")) ||
+		!ensureMsgf(Data, TEXT("Data object must be valid")))
+	{
+		return false;
+	}
+
+	FSaveFile File{};
+	File.SerializeInfo(Info);
+	File.SerializeData(Data);
+	// Keep uncompressed bytes around so that reloading this slot doesn't touch disk
+	return FFileAdapter::SaveFile(*Storage, SlotName, File, Settings, Cache.Get());
+}
@@ -0,0 +1,180 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Multithreading/UpgradeSlotsTask.h"
+
+#include <Async/ParallelFor.h>
+#include <Misc/ScopeLock.h>
+
+#include "FileAdapter.h"
+#include "Misc/SlotHelpers.h"
+#include "SaveManager.h"
+#include "SlotCache.h"
+#include "SlotData.h"
+#include "SlotInfo.h"
+#include "Storage/SaveStorageBackend.h"
+
+
+/////////////////////////////////////////////////////
+// Helpers
+
+namespace UpgradeSlots
+{
+	/** Generations of the slots found up to date or that can't be upgraded */
+	static FCriticalSection CheckedLock;
+	static TMap<FString, FSlotFileGeneration> CheckedSlots;
+
+
+	static bool IsChecked(const FString& SlotName, const FSlotFileGeneration& Generation)
+	{
+		FScopeLock ScopeLock(&CheckedLock);
+		const FSlotFileGeneration* Checked = CheckedSlots.Find(SlotName);
+		return Checked && *Checked == Generation;
+	}
+
+	static void MarkChecked(const FString& SlotName, const FSlotFileGeneration& Generation)
+	{
+		FScopeLock ScopeLock(&CheckedLock);
+		CheckedSlots.Add(SlotName, Generation);
+	}
+}
+
+
+/////////////////////////////////////////////////////
+// FUpgradeSlotsTask
+
+FUpgradeSlotsTask::FUpgradeSlotsTask(const USaveManager* InManager, FSECancelTokenPtr InCancelToken)
+	: Manager(InManager)
+	, Storage(InManager? InManager->GetStorage() : FFileAdapter::GetDefaultStorage())
+	, CancelToken(MoveTemp(InCancelToken))
+{}
+
+void FUpgradeSlotsTask::DoWork()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUpgradeSlotsTask::DoWork);
+	if (!Manager || (CancelToken.IsValid() && CancelToken->IsCancelled()))
+	{
+		return;
+	}
+
+	TArray<FString> SlotNames;
+	FSlotHelpers::FindSlotFileNames(*Storage, SlotNames);
+
+	TArray<bool> Outdated;
+	Outdated.SetNumZeroed(SlotNames.Num());
+	ParallelFor(SlotNames.Num(), [&](int32 Index) {
+		const FString& SlotName = SlotNames[Index];
+		const FSlotFileGeneration Generation = Storage->GetGeneration(SlotName);
+		if (!Generation.IsValid() || UpgradeSlots::IsChecked(SlotName, Generation))
+		{
+			return;
+		}
+
+		FSaveFile File;
+		if (FFileAdapter::ReadFile(*Storage, SlotName, File, true) && File.IsOutdated())
+		{
+			Outdated[Index] = true;
+		}
+		else
+		{
+			UpgradeSlots::MarkChecked(SlotName, Generation);
+		}
+	});
+
+	for (int32 Index = 0; Index < SlotNames.Num(); ++Index)
+	{
+		if (Outdated[Index])
+		{
+			OutdatedSlots.Add(SlotNames[Index]);
+		}
+	}
+}
+
+bool FUpgradeSlotsTask::Reserialize(const UObject* Outer, FOutdatedSlot& Slot, FSlotObjectPool* Pool)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUpgradeSlotsTask::Reserialize);
+	check(IsInGameThread());
+
+	// Old versions and class redirects are resolved one last time
+	USlotInfo* Info = Slot.File.CreateAndDeserializeInfo(Outer, Pool);
+	USlotData* Data = Slot.File.CreateAndDeserializeData(Outer, Pool);
+	const bool bCreated = Info && Data;
+	if (bCreated)
+	{
+		// Written with current versions and resolved class names
+		FSaveFile NewFile;
+		NewFile.SerializeInfo(Info);
+		NewFile.SerializeData(Data);
+		Slot.File = MoveTemp(NewFile);
+	}
+	else if (Slot.File.DataBytes.Num() > 0)
+	{
+		// Data can be missing if it couldn't be decrypted, which may work later
+		UpgradeSlots::MarkChecked(Slot.SlotName, Slot.Generation);
+	}
+
+	// The objects are not needed afterwards
+	if (Pool)
+	{
+		Pool->Release(Info);
+		Pool->Release(Data);
+	}
+	return bCreated;
+}
+
+
+/////////////////////////////////////////////////////
+// FUpgradeSlotFileTask
+
+FUpgradeSlotFileTask::FUpgradeSlotFileTask(FSaveStorageRef InStorage, TSharedPtr<FOutdatedSlot, ESPMode::ThreadSafe> InSlot, EMode InMode,
+	const FSaveFileSettings& InSettings, TSharedPtr<FSlotCache, ESPMode::ThreadSafe> InCache, FSECancelTokenPtr InCancelToken)
+	: Storage(MoveTemp(InStorage))
+	, Slot(MoveTemp(InSlot))
+	, Mode(InMode)
+	, Settings(InSettings)
+	, Cache(MoveTemp(InCache))
+	, CancelToken(MoveTemp(InCancelToken))
+{}
+
+void FUpgradeSlotFileTask::DoWork()
+{
+	if (!Slot.IsValid() || IsCancelled())
+	{
+		return;
+	}
+	bSucceeded = Mode == EMode::Read? Read() : Write();
+}
+
+bool FUpgradeSlotFileTask::Read()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUpgradeSlotFileTask::Read);
+
+	// Taken before reading, so that the upgrade is dropped if the slot is saved meanwhile
+	Slot->Revision = FFileAdapter::GetSlotRevision(Slot->SlotName);
+	Slot->Generation = Storage->GetGeneration(Slot->SlotName);
+
+	if (!FFileAdapter::ReadFile(*Storage, Slot->SlotName, Slot->File) || Slot->File.InfoClassName.IsEmpty())
+	{
+		// Files without header can't be read. They are not tried again until they change
+		UpgradeSlots::MarkChecked(Slot->SlotName, Slot->Generation);
+		return false;
+	}
+	return true;
+}
+
+bool FUpgradeSlotFileTask::Write()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUpgradeSlotFileTask::Write);
+
+	// Fails if the slot was saved or deleted while upgrading
+	if (!FFileAdapter::SaveFileIfUnchanged(*Storage, Slot->SlotName, Slot->File, Settings, Slot->Revision))
+	{
+		return false;
+	}
+
+	UpgradeSlots::MarkChecked(Slot->SlotName, Storage->GetGeneration(Slot->SlotName));
+	if (Cache.IsValid())
+	{
+		Cache->Remove(Slot->SlotName);
+	}
+	return true;
+}
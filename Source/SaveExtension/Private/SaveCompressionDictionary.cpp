@@ -0,0 +1,50 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "SaveCompressionDictionary.h"
+
+#include "FileAdapter.h"
+#include "Misc/DictionaryCompression.h"
+#include "Misc/SlotHelpers.h"
+
+
+/////////////////////////////////////////////////////
+// USaveCompressionDictionary
+
+void USaveCompressionDictionary::TrainFromSavedSlots()
+{
+	const FSaveStorageRef Storage = FFileAdapter::GetDefaultStorage();
+	TArray<FString> SlotNames;
+	FSlotHelpers::FindSlotFileNames(*Storage, SlotNames);
+
+	TArray<TArray<uint8>> Samples;
+	Samples.Reserve(SlotNames.Num());
+	for (const FString& SlotName : SlotNames)
+	{
+		FSaveFile File;
+		if (FFileAdapter::ReadFile(*Storage, SlotName, File) && File.DataBytes.Num() > 0)
+		{
+			Samples.Add(MoveTemp(File.DataBytes));
+		}
+	}
+
+	Train(Samples);
+}
+
+void USaveCompressionDictionary::Train(const TArray<TArray<uint8>>& Samples)
+{
+	Modify();
+	FDictionaryCompression::Train(Samples, MaxSize, Bytes);
+	NumSamples = Samples.Num();
+	Id = Register();
+}
+
+uint32 USaveCompressionDictionary::Register() const
+{
+	return FDictionaryCompression::Register(Bytes);
+}
+
+void USaveCompressionDictionary::PostLoad()
+{
+	Super::PostLoad();
+	Register();
+}
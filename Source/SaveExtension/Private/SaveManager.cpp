@@ -4,26 +4,46 @@
 
 #include "FileAdapter.h"
 #include "LatentActions/LoadInfosAction.h"
+#include "Misc/SaveShards.h"
 #include "Multithreading/DeleteSlotsTask.h"
 #include "Multithreading/LoadSlotInfosTask.h"
+#include "Multithreading/PruneSlotsTask.h"
+#include "Multithreading/ReadSlotFilesTask.h"
+#include "Multithreading/SaveFileTask.h"
+#include "Multithreading/UpgradeSlotsTask.h"
+#include "SaveCompressionDictionary.h"
 #include "SaveSettings.h"
+#include "Serialization/InstancesRecord.h"
 #include "Serialization/SlotDataTask_LevelLoader.h"
 #include "Serialization/SlotDataTask_LevelSaver.h"
 #include "Serialization/SlotDataTask_Loader.h"
 #include "Serialization/SlotDataTask_Saver.h"
+#include "Serialization/SlotDataTask_SnapshotLoader.h"
+#include "Serialization/SlotDataTask_SnapshotSaver.h"
+#include "Serialization/SlotDataTask_SubsetLoader.h"
+#include "Serialization/SlotDataTask_SubsetSaver.h"
 
 #include <Engine/GameViewportClient.h>
 #include <Engine/LevelStreaming.h>
 #include <EngineUtils.h>
 #include <GameDelegates.h>
+#include <GameFramework/Controller.h>
 #include <GameFramework/GameModeBase.h>
+#include <GameFramework/PlayerState.h>
 #include <HighResScreenshot.h>
 #include <Kismet/GameplayStatics.h>
 #include <Misc/CoreDelegates.h>
 #include <Misc/Paths.h>
 
 
-USaveManager::USaveManager() : Super(), MTTasks{} {}
+USaveManager::USaveManager()
+	: Super()
+	, MTTasks{}
+	, SlotCache{ MakeShared<FSlotCache, ESPMode::ThreadSafe>() }
+	, ObjectPool{ MakeShared<FSlotObjectPool, ESPMode::ThreadSafe>() }
+	, LargeActorSizes{ MakeShared<FLargeActorSizes, ESPMode::ThreadSafe>() }
+	, Storage{ FFileAdapter::GetDefaultStorage() }
+{}
 
 void USaveManager::Initialize(FSubsystemCollectionBase& Collection)
 {
@@ -33,8 +53,11 @@ void USaveManager::Initialize(FSubsystemCollectionBase& Collection)
 
 	FCoreUObjectDelegates::PreLoadMap.AddUObject(this, &USaveManager::OnMapLoadStarted);
 	FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &USaveManager::OnMapLoadFinished);
+	FWorldDelegates::OnWorldInitializedActors.AddUObject(this, &USaveManager::OnWorldActorsInitialized);
+	FGameModeEvents::GameModeLogoutEvent.AddUObject(this, &USaveManager::OnLogout);
 
 	ActivePreset = GetDefault<USaveSettings>()->CreatePreset(this);
+	UpdateStorage();
 
 	// AutoLoad
 	if (GetPreset() && GetPreset()->bAutoLoad)
@@ -44,24 +67,72 @@ void USaveManager::Initialize(FSubsystemCollectionBase& Collection)
 
 	TryInstantiateInfo();
 	UpdateLevelStreamings();
+
+	if (GetPreset() && GetPreset()->bUpgradeSlots)
+	{
+		UpgradeSlots();
+	}
+}
+
+void USaveManager::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	USaveManager* This = CastChecked<USaveManager>(InThis);
+	This->Subscribers.AddReferencedObjects(Collector, This);
+	This->ObjectPool->AddReferencedObjects(Collector, This);
+
+	Super::AddReferencedObjects(InThis, Collector);
 }
 
 void USaveManager::Deinitialize()
 {
 	Super::Deinitialize();
 
+	if (UpgradeCancelToken)
+	{
+		UpgradeCancelToken->Cancel();
+	}
 	MTTasks.CancelAll();
+	FinishUpgradingSlots();
+
+	// Queued sub-slot files are still written
+	while (QueuedSubSlotWrites.Num() > 0)
+	{
+		StartQueuedSubSlotWrites();
+		MTTasks.CancelAll();
+	}
 
 	if (GetPreset()->bSaveOnExit)
 		SaveCurrentSlot();
 
+	ObjectPool->Empty();
+
 	FCoreUObjectDelegates::PreLoadMap.RemoveAll(this);
 	FCoreUObjectDelegates::PostLoadMapWithWorld.RemoveAll(this);
+	FWorldDelegates::OnWorldInitializedActors.RemoveAll(this);
+	FGameModeEvents::GameModeLogoutEvent.RemoveAll(this);
 	FGameDelegates::Get().GetEndPlayMapDelegate().RemoveAll(this);
 }
 
 bool USaveManager::SaveSlot(
 	FName SlotName, bool bOverrideIfNeeded, bool bScreenshot, const FScreenshotSize Size, FOnGameSaved OnSaved)
+{
+	return StartSaving(SlotName, bOverrideIfNeeded, bScreenshot, Size, MoveTemp(OnSaved), {});
+}
+
+TFuture<USlotInfo*> USaveManager::SaveSlotAsync(
+	FName SlotName, bool bOverrideIfNeeded, bool bScreenshot, const FScreenshotSize Size)
+{
+	auto Promise = MakeShared<TSlotPromise<USlotInfo*>, ESPMode::ThreadSafe>();
+	TFuture<USlotInfo*> Future = Promise->GetFuture();
+	if (!StartSaving(SlotName, bOverrideIfNeeded, bScreenshot, Size, {}, Promise))
+	{
+		Promise->SetValue(nullptr);
+	}
+	return Future;
+}
+
+bool USaveManager::StartSaving(FName SlotName, bool bOverrideIfNeeded, bool bScreenshot, const FScreenshotSize Size,
+	FOnGameSaved OnSaved, TSlotPromisePtr<USlotInfo*> Promise)
 {
 	if (!CanLoadOrSave())
 		return false;
@@ -83,12 +154,30 @@ bool USaveManager::SaveSlot(
 	auto* Task = CreateTask<USlotDataTask_Saver>()
 		->Setup(SlotName, bOverrideIfNeeded, bScreenshot, Size.Width, Size.Height)
 		->Bind(OnSaved)
-		->Start();
+		->BindPromise(MoveTemp(Promise));
+	SupersedeTasks(Task);
+	Task->Start();
 
 	return Task->IsSucceeded() || Task->IsScheduled();
 }
 
 bool USaveManager::LoadSlot(FName SlotName, FOnGameLoaded OnLoaded)
+{
+	return StartLoading(SlotName, MoveTemp(OnLoaded), {});
+}
+
+TFuture<USlotInfo*> USaveManager::LoadSlotAsync(FName SlotName)
+{
+	auto Promise = MakeShared<TSlotPromise<USlotInfo*>, ESPMode::ThreadSafe>();
+	TFuture<USlotInfo*> Future = Promise->GetFuture();
+	if (!StartLoading(SlotName, {}, Promise))
+	{
+		Promise->SetValue(nullptr);
+	}
+	return Future;
+}
+
+bool USaveManager::StartLoading(FName SlotName, FOnGameLoaded OnLoaded, TSlotPromisePtr<USlotInfo*> Promise)
 {
 	if (!CanLoadOrSave() || !IsSlotSaved(SlotName))
 	{
@@ -100,11 +189,238 @@ bool USaveManager::LoadSlot(FName SlotName, FOnGameLoaded OnLoaded)
 	auto* Task = CreateTask<USlotDataTask_Loader>()
 		->Setup(SlotName)
 		->Bind(OnLoaded)
+		->BindPromise(MoveTemp(Promise));
+	SupersedeTasks(Task);
+	Task->Start();
+
+	return Task->IsSucceeded() || Task->IsScheduled();
+}
+
+bool USaveManager::TakeSnapshot()
+{
+	if (!CanLoadOrSave())
+	{
+		return false;
+	}
+
+	Snapshots.SetCapacity(GetPreset()->MaxSnapshots);
+	if (Snapshots.GetCapacity() <= 0)
+	{
+		return false;
+	}
+
+	auto* Task = CreateTask<USlotDataTask_SnapshotSaver>()->Start();
+	return Task->IsSucceeded() || Task->IsScheduled();
+}
+
+bool USaveManager::RestoreSnapshot(int32 Index, bool bDiscardNewer, FOnGameLoaded OnLoaded)
+{
+	if (!CanLoadOrSave() || Index < 0 || Index >= Snapshots.Num())
+	{
+		return false;
+	}
+
+	USlotData* Data = Snapshots.CreateData(Index, this, ObjectPool.Get());
+	if (!Data)
+	{
+		return false;
+	}
+
+	if (bDiscardNewer)
+	{
+		Snapshots.DiscardNewerThan(Index);
+	}
+
+	auto* Task = CreateTask<USlotDataTask_SnapshotLoader>()
+		->Setup(Data)
+		->Bind(OnLoaded)
+		->Start();
+
+	return Task->IsSucceeded() || Task->IsScheduled();
+}
+
+bool USaveManager::SaveActors(FName SubSlotName, const TArray<AActor*>& Actors, FOnGameSaved OnSaved)
+{
+	if (!CanLoadOrSave() || SubSlotName.IsNone())
+	{
+		return false;
+	}
+
+	auto* Task = CreateTask<USlotDataTask_SubsetSaver>()
+		->Setup(SubSlotName, Actors)
+		->Bind(OnSaved)
+		->Start();
+
+	return Task->IsSucceeded() || Task->IsScheduled();
+}
+
+bool USaveManager::SaveActorsWithTag(FName SubSlotName, FName Tag, FOnGameSaved OnSaved)
+{
+	TArray<AActor*> Actors;
+	UGameplayStatics::GetAllActorsWithTag(this, Tag, Actors);
+	return SaveActors(SubSlotName, Actors, MoveTemp(OnSaved));
+}
+
+bool USaveManager::SaveActorsOfClass(FName SubSlotName, const FSEActorClassFilter& Filter, FOnGameSaved OnSaved)
+{
+	const UWorld* World = GetWorld();
+	if (!World)
+	{
+		return false;
+	}
+
+	Filter.BakeAllowedClasses();
+
+	TArray<AActor*> Actors;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		if (Filter.IsClassAllowed(It->GetClass()))
+		{
+			Actors.Add(*It);
+		}
+	}
+	return SaveActors(SubSlotName, Actors, MoveTemp(OnSaved));
+}
+
+bool USaveManager::LoadActors(FName SubSlotName, FOnGameLoaded OnLoaded)
+{
+	if (!CanLoadOrSave() || SubSlotName.IsNone())
+	{
+		return false;
+	}
+
+	auto* Task = CreateTask<USlotDataTask_SubsetLoader>()
+		->Setup(SubSlotName)
+		->Bind(OnLoaded)
+		->Start();
+
+	return Task->IsSucceeded() || Task->IsScheduled();
+}
+
+bool USaveManager::SavePlayerShard(const APlayerState* Player, FOnGameSaved OnSaved)
+{
+	const FString PlayerId = FSaveShards::GetPlayerId(Player);
+	if (PlayerId.IsEmpty())
+	{
+		return false;
+	}
+
+	TMap<FString, TArray<AActor*>> ActorsByOwner;
+	FSaveShards::GatherActors(GetWorld(), GetPreset()->ToFilter(), ActorsByOwner);
+	return SaveActors(FSaveShards::GetShardName(PlayerId), ActorsByOwner.FindRef(PlayerId), MoveTemp(OnSaved));
+}
+
+bool USaveManager::LoadPlayerShard(const APlayerState* Player, FOnGameLoaded OnLoaded)
+{
+	const FString PlayerId = FSaveShards::GetPlayerId(Player);
+	if (PlayerId.IsEmpty() || !CanLoadOrSave())
+	{
+		return false;
+	}
+
+	// Names of player actors change between sessions, they are matched by their owner instead
+	auto* Task = CreateTask<USlotDataTask_SubsetLoader>()
+		->Setup(FSaveShards::GetShardName(PlayerId))
+		->SetupOwner(PlayerId)
+		->Bind(OnLoaded)
 		->Start();
 
 	return Task->IsSucceeded() || Task->IsScheduled();
 }
 
+bool USaveManager::SaveWorldShard(FOnGameSaved OnSaved)
+{
+	TMap<FString, TArray<AActor*>> ActorsByOwner;
+	FSaveShards::GatherActors(GetWorld(), GetPreset()->ToFilter(), ActorsByOwner);
+	return SaveActors(FSaveShards::WorldShardName, ActorsByOwner.FindRef(FString{}), MoveTemp(OnSaved));
+}
+
+bool USaveManager::LoadWorldShard(FOnGameLoaded OnLoaded)
+{
+	return LoadActors(FSaveShards::WorldShardName, MoveTemp(OnLoaded));
+}
+
+bool USaveManager::SaveAllShards()
+{
+	TMap<FString, TArray<AActor*>> ActorsByOwner;
+	FSaveShards::GatherActors(GetWorld(), GetPreset()->ToFilter(), ActorsByOwner);
+
+	bool bSuccess = true;
+	for (const auto& OwnerActors : ActorsByOwner)
+	{
+		bSuccess &= SaveActors(FSaveShards::GetShardName(OwnerActors.Key), OwnerActors.Value);
+	}
+	return bSuccess;
+}
+
+void USaveManager::WriteSubSlotFile(USlotInfo* Info, USlotData* Data, FName SubSlotName, FOnGameSaved OnSaved)
+{
+	check(Info && Data);
+
+	// The task that created them may be destroyed before the file is written
+	Info->AddToRoot();
+	Data->AddToRoot();
+
+	FSubSlotWrite Write{ Info, Data, SubSlotName, GetFileSettings(), MoveTemp(OnSaved) };
+	if (SubSlotWrites.Contains(SubSlotName))
+	{
+		// Started once the previous write of the same sub-slot finishes
+		QueuedSubSlotWrites.Add(MoveTemp(Write));
+		return;
+	}
+	StartSubSlotWrite(MoveTemp(Write));
+}
+
+void USaveManager::StartSubSlotWrite(FSubSlotWrite&& Write)
+{
+	SubSlotWrites.Add(Write.SubSlotName);
+
+	MTTasks.CreateTask<FSaveFileTask>(Storage, Write.Info, Write.Data, FFileAdapter::GetSubSlotName(Write.SubSlotName), Write.Settings, SlotCache)
+		.OnFinished([this, Write](auto& Task)
+		{
+			Write.Info->RemoveFromRoot();
+			Write.Data->RemoveFromRoot();
+			SubSlotWrites.Remove(Write.SubSlotName);
+			Write.OnSaved.ExecuteIfBound(Task->IsSucceeded()? Write.Info : nullptr);
+			ObjectPool->Release(Write.Data);
+		})
+		.StartBackgroundTask();
+}
+
+void USaveManager::StartQueuedSubSlotWrites()
+{
+	// Tasks can't be created while MTTasks is ticking, so queued writes are started here
+	for (int32 I = 0; I < QueuedSubSlotWrites.Num(); ++I)
+	{
+		if (!SubSlotWrites.Contains(QueuedSubSlotWrites[I].SubSlotName))
+		{
+			FSubSlotWrite Write = MoveTemp(QueuedSubSlotWrites[I]);
+			QueuedSubSlotWrites.RemoveAt(I--);
+			StartSubSlotWrite(MoveTemp(Write));
+		}
+	}
+}
+
+bool USaveManager::CancelTask(USlotDataTask* Task)
+{
+	return Task && Tasks.Contains(Task) && Task->Cancel();
+}
+
+int32 USaveManager::CancelAllTasks()
+{
+	int32 Cancelled = 0;
+	// Newest first, so that cancelling the running task doesn't start the ones after it
+	const TArray<USlotDataTask*> CurrentTasks = Tasks;
+	for (int32 I = CurrentTasks.Num() - 1; I >= 0; --I)
+	{
+		if (CancelTask(CurrentTasks[I]))
+		{
+			++Cancelled;
+		}
+	}
+	return Cancelled;
+}
+
 bool USaveManager::DeleteSlot(FName SlotName)
 {
 	if (SlotName.IsNone())
@@ -112,6 +428,8 @@ bool USaveManager::DeleteSlot(FName SlotName)
 		return false;
 	}
 
+	UpdateStorage();
+
 	bool bSuccess = false;
 	MTTasks.CreateTask<FDeleteSlotsTask>(this, SlotName)
 		.OnFinished([&bSuccess](auto& Task) mutable {
@@ -122,17 +440,159 @@ bool USaveManager::DeleteSlot(FName SlotName)
 	return bSuccess;
 }
 
+void USaveManager::PruneSlots(FName KeptSlotName)
+{
+	const USavePreset* Preset = GetPreset();
+
+	FSlotRetention Retention;
+	Retention.MaxSlots = Preset->MaxSlots;
+	Retention.MaxAge = FTimespan::FromDays(Preset->MaxSlotAgeDays);
+	Retention.MaxBytes = int64(Preset->MaxSlotsSizeMB) * 1024 * 1024;
+	if (bPruningSlots || !Retention.IsEnabled())
+	{
+		return;
+	}
+
+	UpdateStorage();
+
+	bPruningSlots = true;
+	MTTasks.CreateTask<FPruneSlotsTask>(Storage, Retention, KeptSlotName, SlotCache)
+		.OnFinished([this](auto& Task) {
+			bPruningSlots = false;
+			if (Task->DeletedSlots.Num() > 0)
+			{
+				SELog(GetPreset(), FString::Printf(TEXT("Pruned %i old slots"), Task->DeletedSlots.Num()));
+			}
+		})
+		.StartBackgroundTask();
+}
+
+void USaveManager::UpgradeSlots()
+{
+	if (UpgradeCancelToken)
+	{
+		return;
+	}
+
+	UpdateStorage();
+
+	UpgradeCancelToken = MakeShared<FSECancelToken, ESPMode::ThreadSafe>();
+	UpgradedSlotsCount = 0;
+	bUpgradeTaskRunning = true;
+	MTTasks.CreateTask<FUpgradeSlotsTask>(this, UpgradeCancelToken)
+		.OnFinished([this](auto& Task) {
+			bUpgradeTaskRunning = false;
+			OutdatedSlots = MoveTemp(Task->OutdatedSlots);
+		})
+		.StartBackgroundTask();
+}
+
+void USaveManager::UpgradeNextSlot()
+{
+	if (!UpgradeCancelToken || bUpgradeTaskRunning)
+	{
+		return;
+	}
+
+	if (UpgradeCancelToken->IsCancelled())
+	{
+		FinishUpgradingSlots();
+		return;
+	}
+
+	if (UpgradedSlot)
+	{
+		// Read and serialized again, only writing is left
+		bUpgradeTaskRunning = true;
+		MTTasks.CreateTask<FUpgradeSlotFileTask>(Storage, UpgradedSlot, FUpgradeSlotFileTask::EMode::Write,
+			GetFileSettings(), SlotCache, UpgradeCancelToken)
+			.OnFinished([this](auto& Task) {
+				bUpgradeTaskRunning = false;
+				UpgradedSlot.Reset();
+				if (Task->IsSucceeded())
+				{
+					++UpgradedSlotsCount;
+				}
+			})
+			.StartBackgroundTask();
+		return;
+	}
+
+	// Saves and loads come first
+	if (Tasks.Num() > 0)
+	{
+		return;
+	}
+
+	if (OutdatedSlots.Num() <= 0)
+	{
+		FinishUpgradingSlots();
+		return;
+	}
+
+	TSharedPtr<FOutdatedSlot, ESPMode::ThreadSafe> Slot = MakeShared<FOutdatedSlot, ESPMode::ThreadSafe>();
+	Slot->SlotName = OutdatedSlots.Pop(false);
+
+	bUpgradeTaskRunning = true;
+	MTTasks.CreateTask<FUpgradeSlotFileTask>(Storage, Slot, FUpgradeSlotFileTask::EMode::Read,
+		GetFileSettings(), SlotCache, UpgradeCancelToken)
+		.OnFinished([this, Slot](auto& Task) {
+			bUpgradeTaskRunning = false;
+			// Objects of old slots are created and serialized again on the game thread
+			if (Task->IsSucceeded() && FUpgradeSlotsTask::Reserialize(this, *Slot, ObjectPool.Get()))
+			{
+				UpgradedSlot = Slot;
+			}
+		})
+		.StartBackgroundTask();
+}
+
+void USaveManager::FinishUpgradingSlots()
+{
+	UpgradeCancelToken.Reset();
+	OutdatedSlots.Empty();
+	UpgradedSlot.Reset();
+	if (UpgradedSlotsCount > 0)
+	{
+		SELog(GetPreset(), FString::Printf(TEXT("Upgraded %i outdated slots"), UpgradedSlotsCount));
+	}
+	UpgradedSlotsCount = 0;
+}
+
 void USaveManager::LoadAllSlotInfos(bool bSortByRecent, FOnSlotInfosLoaded Delegate)
 {
+	UpdateStorage();
 	MTTasks.CreateTask<FLoadSlotInfosTask>(this, bSortByRecent, MoveTemp(Delegate))
 		.OnFinished([](auto& Task) {
 			Task->AfterFinish();
 		})
 		.StartBackgroundTask();
+
+	if (GetPreset()->bUpgradeSlots)
+	{
+		UpgradeSlots();
+	}
+}
+
+TFuture<TArray<USlotInfo*>> USaveManager::LoadAllSlotInfosAsync(bool bSortByRecent)
+{
+	UpdateStorage();
+
+	auto Promise = MakeShared<TSlotPromise<TArray<USlotInfo*>>, ESPMode::ThreadSafe>();
+	TFuture<TArray<USlotInfo*>> Future = Promise->GetFuture();
+
+	auto& InfosTask = MTTasks.CreateTask<FLoadSlotInfosTask>(this, bSortByRecent, FOnSlotInfosLoaded{});
+	InfosTask->BindPromise(MoveTemp(Promise));
+	InfosTask.OnFinished([](auto& Task) {
+			Task->AfterFinish();
+		})
+		.StartBackgroundTask();
+	return Future;
 }
 
 void USaveManager::LoadAllSlotInfosSync(bool bSortByRecent, FOnSlotInfosLoaded Delegate)
 {
+	UpdateStorage();
 	MTTasks.CreateTask<FLoadSlotInfosTask>(this, bSortByRecent, MoveTemp(Delegate))
 		.OnFinished([](auto& Task) {
 			Task->AfterFinish();
@@ -141,8 +601,19 @@ void USaveManager::LoadAllSlotInfosSync(bool bSortByRecent, FOnSlotInfosLoaded D
 	MTTasks.Tick();
 }
 
+void USaveManager::ReadSlotFiles(const TArray<FName>& SlotNames, bool bSkipData, FOnSlotFilesRead Delegate)
+{
+	UpdateStorage();
+	MTTasks.CreateTask<FReadSlotFilesTask>(Storage, SlotNames, bSkipData, SlotCache, MoveTemp(Delegate))
+		.OnFinished([](auto& Task) {
+			Task->AfterFinish();
+		})
+		.StartBackgroundTask();
+}
+
 void USaveManager::DeleteAllSlots(FOnSlotsDeleted Delegate)
 {
+	UpdateStorage();
 	MTTasks.CreateTask<FDeleteSlotsTask>(this)
 		.OnFinished([Delegate](auto& Task) {
 			Delegate.ExecuteIfBound();
@@ -219,7 +690,7 @@ void USaveManager::BPDeleteAllSlots(EDeleteSlotsResult& Result, struct FLatentAc
 
 bool USaveManager::IsSlotSaved(FName SlotName) const
 {
-	return FFileAdapter::DoesFileExist(SlotName.ToString());
+	return FFileAdapter::DoesFileExist(*Storage, SlotName.ToString());
 }
 
 USavePreset* USaveManager::SetActivePreset(TSubclassOf<USavePreset> PresetClass)
@@ -237,6 +708,7 @@ USavePreset* USaveManager::SetActivePreset(TSubclassOf<USavePreset> PresetClass)
 	}
 
 	ActivePreset = NewObject<USavePreset>(this, PresetClass);
+	UpdateStorage();
 	return ActivePreset;
 }
 
@@ -276,8 +748,9 @@ void USaveManager::TryInstantiateInfo(bool bForced)
 	if (!DataClass)
 		DataClass = USlotData::StaticClass();
 
+	// Infos may still be used by whoever received them. Data is only used internally
 	CurrentInfo = NewObject<USlotInfo>(GetTransientPackage(), InfoClass);
-	CurrentData = NewObject<USlotData>(GetTransientPackage(), DataClass);
+	__SetCurrentData(ObjectPool->Acquire<USlotData>(DataClass, GetTransientPackage()));
 }
 
 void USaveManager::UpdateLevelStreamings()
@@ -296,6 +769,8 @@ void USaveManager::UpdateLevelStreamings()
 	{
 		ULevelStreamingNotifier* Notifier = NewObject<ULevelStreamingNotifier>(this);
 		Notifier->SetLevelStreaming(Level);
+		Notifier->OnLevelLoaded().BindUFunction(
+			this, GET_FUNCTION_NAME_CHECKED(USaveManager, CaptureStreamingLevelBaselines));
 		Notifier->OnLevelShown().BindUFunction(
 			this, GET_FUNCTION_NAME_CHECKED(USaveManager, DeserializeStreamingLevel));
 		Notifier->OnLevelHidden().BindUFunction(
@@ -317,6 +792,12 @@ void USaveManager::DeserializeStreamingLevel(ULevelStreaming* LevelStreaming)
 	CreateTask<USlotDataTask_LevelLoader>()->Setup(LevelStreaming)->Start();
 }
 
+void USaveManager::CaptureStreamingLevelBaselines(ULevelStreaming* LevelStreaming)
+{
+	// Loaded levels are not in the world yet, so none of their actors began play
+	CaptureInstanceBaselines(LevelStreaming->GetLoadedLevel());
+}
+
 USlotInfo* USaveManager::LoadInfo(FName SlotName)
 {
 	if (SlotName.IsNone())
@@ -325,14 +806,12 @@ USlotInfo* USaveManager::LoadInfo(FName SlotName)
 		return nullptr;
 	}
 
-	auto& Task = MTTasks.CreateTask<FLoadSlotInfosTask>(this, SlotName)
-		.OnFinished([](auto& Task)
-		{
-			Task->AfterFinish();
-		});
+	auto& Task = MTTasks.CreateTask<FLoadSlotInfosTask>(this, SlotName);
 	Task.StartSynchronousTask();
 
 	check(Task.IsDone());
+	// Infos are created once finished. The task is removed on the next tick
+	Task->AfterFinish();
 
 	const auto& Infos = Task->GetLoadedSlots();
 	return Infos.Num() > 0? Infos[0] : nullptr;
@@ -340,8 +819,12 @@ USlotInfo* USaveManager::LoadInfo(FName SlotName)
 
 USlotDataTask* USaveManager::CreateTask(TSubclassOf<USlotDataTask> TaskType)
 {
+	const USavePreset* Preset = GetPreset();
+	SlotCache->SetLimits(Preset->CachedSlots, int64(Preset->MaxSlotCacheMB) * 1024 * 1024);
+	UpdateStorage();
+
 	USlotDataTask* Task = NewObject<USlotDataTask>(this, TaskType.Get());
-	Task->Prepare(CurrentData, *GetPreset());
+	Task->Prepare(CurrentData, *Preset);
 	Tasks.Add(Task);
 	return Task;
 }
@@ -357,6 +840,56 @@ void USaveManager::FinishTask(USlotDataTask* Task)
 	}
 }
 
+void USaveManager::SupersedeTasks(const USlotDataTask* NewTask)
+{
+	if (!NewTask || !GetPreset()->bSupersedeTasks)
+	{
+		return;
+	}
+
+	// Newest first, so that cancelling the running task doesn't start the ones after it
+	const TArray<USlotDataTask*> CurrentTasks = Tasks;
+	for (int32 I = CurrentTasks.Num() - 1; I >= 0; --I)
+	{
+		USlotDataTask* Task = CurrentTasks[I];
+		if (Task != NewTask && Task->IsSupersededBy(*NewTask))
+		{
+			Task->Cancel();
+		}
+	}
+}
+
+void USaveManager::UpdateStorage()
+{
+	// Only applied on changes so that backends set from code are kept
+	const ESaveStorage StorageType = GetPreset()->Storage;
+	if (!AppliedStorage.IsSet() || AppliedStorage.GetValue() != StorageType)
+	{
+		SetStorage(FFileAdapter::MakeStorage(StorageType));
+		AppliedStorage = StorageType;
+	}
+}
+
+FSaveFileSettings USaveManager::GetFileSettings() const
+{
+	const USavePreset* Preset = GetPreset();
+	const USaveCompressionDictionary* Dictionary = Preset->CompressionDictionary;
+
+	FSaveFileSettings Settings;
+	Settings.bUseCompression = Preset->bUseCompression;
+	Settings.DictionaryId = Dictionary? Dictionary->Register() : 0;
+	Settings.bEncrypt = Preset->bEncryptData;
+	return Settings;
+}
+
+void USaveManager::SetStorage(FSaveStorageRef InStorage)
+{
+	Storage = MoveTemp(InStorage);
+
+	// Cached files belong to the previous backend
+	SlotCache->Empty();
+}
+
 FName USaveManager::GetSlotNameFromId(const int32 SlotId) const
 {
 	if (const auto* Preset = GetPreset())
@@ -386,100 +919,137 @@ void USaveManager::Tick(float DeltaTime)
 		}
 	}
 
+	const float WorldShardInterval = GetPreset()->WorldShardInterval;
+	if (WorldShardInterval > 0.f)
+	{
+		WorldShardTime += DeltaTime;
+		const UWorld* World = GetWorld();
+		if (WorldShardTime >= WorldShardInterval && World && World->GetAuthGameMode())
+		{
+			WorldShardTime = 0.f;
+			SaveWorldShard();
+		}
+	}
+
 	MTTasks.Tick();
+	StartQueuedSubSlotWrites();
+	UpgradeNextSlot();
 }
 
 void USaveManager::SubscribeForEvents(const TScriptInterface<ISaveExtensionInterface>& Interface)
 {
-	SubscribedInterfaces.AddUnique(Interface);
+	Subscribers.Add(Interface.GetObject());
 }
 
 void USaveManager::UnsubscribeFromEvents(const TScriptInterface<ISaveExtensionInterface>& Interface)
 {
-	SubscribedInterfaces.Remove(Interface);
+	Subscribers.Remove(Interface.GetObject());
 }
 
-void USaveManager::OnSaveBegan(const FSELevelFilter& Filter)
+void USaveManager::OnSaveBegan(const FSELevelFilter& Filter, const ULevel* Level)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(USaveManager::OnSaveBegan);
 
-	IterateSubscribedInterfaces([&Filter](auto* Object)
+	Subscribers.ForEach(Level, [&Filter](const FSaveEventSubscribers::FSubscriber& Subscriber)
 	{
-		check(Object->template Implements<USaveExtensionInterface>());
-
 		// C++ event
-		if (ISaveExtensionInterface* Interface = Cast<ISaveExtensionInterface>(Object))
+		if (Subscriber.Native)
+		{
+			Subscriber.Native->OnSaveBegan(Filter);
+		}
+		if (EnumHasAnyFlags(Subscriber.ScriptEvents, ESaveEvent::SaveBegan))
 		{
-			Interface->OnSaveBegan(Filter);
+			ISaveExtensionInterface::Execute_ReceiveOnSaveBegan(Subscriber.Object, Filter);
 		}
-		ISaveExtensionInterface::Execute_ReceiveOnSaveBegan(Object, Filter);
 	});
 }
 
-void USaveManager::OnSaveFinished(const FSELevelFilter& Filter, const bool bError)
+void USaveManager::OnSaveFinished(const FSELevelFilter& Filter, const bool bError, const ULevel* Level)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(USaveManager::OnSaveFinished);
 
-	IterateSubscribedInterfaces([&Filter, bError](auto* Object)
+	Subscribers.ForEach(Level, [&Filter, bError](const FSaveEventSubscribers::FSubscriber& Subscriber)
 	{
-		check(Object->template Implements<USaveExtensionInterface>());
-
 		// C++ event
-		if (ISaveExtensionInterface* Interface = Cast<ISaveExtensionInterface>(Object))
+		if (Subscriber.Native)
 		{
-			Interface->OnSaveFinished(Filter, bError);
+			Subscriber.Native->OnSaveFinished(Filter, bError);
+		}
+		if (EnumHasAnyFlags(Subscriber.ScriptEvents, ESaveEvent::SaveFinished))
+		{
+			ISaveExtensionInterface::Execute_ReceiveOnSaveFinished(Subscriber.Object, Filter, bError);
 		}
-		ISaveExtensionInterface::Execute_ReceiveOnSaveFinished(Object, Filter, bError);
 	});
 
-	if (!bError)
+	if (!bError && !Level)
 	{
 		OnGameSaved.Broadcast(CurrentInfo);
+
+		if (GetPreset()->bPruneSlots)
+		{
+			PruneSlots(CurrentInfo? CurrentInfo->FileName : FName{});
+		}
 	}
 }
 
-void USaveManager::OnLoadBegan(const FSELevelFilter& Filter)
+void USaveManager::OnLoadBegan(const FSELevelFilter& Filter, const ULevel* Level)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(USaveManager::OnLoadBegan);
 
-	IterateSubscribedInterfaces([&Filter](auto* Object)
+	Subscribers.ForEach(Level, [&Filter](const FSaveEventSubscribers::FSubscriber& Subscriber)
 	{
-		check(Object->template Implements<USaveExtensionInterface>());
-
 		// C++ event
-		if (ISaveExtensionInterface* Interface = Cast<ISaveExtensionInterface>(Object))
+		if (Subscriber.Native)
+		{
+			Subscriber.Native->OnLoadBegan(Filter);
+		}
+		if (EnumHasAnyFlags(Subscriber.ScriptEvents, ESaveEvent::LoadBegan))
 		{
-			Interface->OnLoadBegan(Filter);
+			ISaveExtensionInterface::Execute_ReceiveOnLoadBegan(Subscriber.Object, Filter);
 		}
-		ISaveExtensionInterface::Execute_ReceiveOnLoadBegan(Object, Filter);
 	});
 }
 
-void USaveManager::OnLoadFinished(const FSELevelFilter& Filter, const bool bError)
+void USaveManager::OnLoadFinished(const FSELevelFilter& Filter, const bool bError, const ULevel* Level)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(USaveManager::OnLoadFinished);
 
-	IterateSubscribedInterfaces([&Filter, bError](auto* Object)
+	Subscribers.ForEach(Level, [&Filter, bError](const FSaveEventSubscribers::FSubscriber& Subscriber)
 	{
-		check(Object->template Implements<USaveExtensionInterface>());
-
 		// C++ event
-		if (ISaveExtensionInterface* Interface = Cast<ISaveExtensionInterface>(Object))
+		if (Subscriber.Native)
+		{
+			Subscriber.Native->OnLoadFinished(Filter, bError);
+		}
+		if (EnumHasAnyFlags(Subscriber.ScriptEvents, ESaveEvent::LoadFinished))
 		{
-			Interface->OnLoadFinished(Filter, bError);
+			ISaveExtensionInterface::Execute_ReceiveOnLoadFinished(Subscriber.Object, Filter, bError);
 		}
-		ISaveExtensionInterface::Execute_ReceiveOnLoadFinished(Object, Filter, bError);
 	});
 
-	if (!bError)
+	if (!bError && !Level)
 	{
 		OnGameLoaded.Broadcast(CurrentInfo);
 	}
 }
 
+void USaveManager::OnLogout(AGameModeBase* GameMode, AController* Exiting)
+{
+	if (!Exiting || !GameMode || GameMode->GetWorld() != GetWorld() || !GetPreset()->bSavePlayerShardOnLogout)
+	{
+		return;
+	}
+
+	// Owned actors are still alive while logging out
+	SavePlayerShard(Exiting->PlayerState);
+}
+
 void USaveManager::OnMapLoadStarted(const FString& MapName)
 {
 	SELog(GetPreset(), "Loading Map '" + MapName + "'", FColor::Purple);
+
+	// Actors of the previous map will never be saved again
+	LargeActorSizes->Empty();
 }
 
 void USaveManager::OnMapLoadFinished(UWorld* LoadedWorld)
@@ -492,6 +1062,27 @@ void USaveManager::OnMapLoadFinished(UWorld* LoadedWorld)
 	UpdateLevelStreamings();
 }
 
+void USaveManager::OnWorldActorsInitialized(const UWorld::FActorsInitializedParams& Params)
+{
+	if (!Params.World || Params.World != GetWorld())
+	{
+		return;
+	}
+
+	// Instances are captured before any actor begins play and can modify them
+	for (const ULevel* Level : Params.World->GetLevels())
+	{
+		CaptureInstanceBaselines(Level);
+	}
+}
+
+void USaveManager::CaptureInstanceBaselines(const ULevel* Level) const
+{
+	FSELevelFilter Filter = GetPreset()->ToFilter();
+	Filter.BakeAllowedClasses();
+	FInstanceBaselines::CaptureLevel(Level, Filter);
+}
+
 UWorld* USaveManager::GetWorld() const
 {
 	check(GetGameInstance());
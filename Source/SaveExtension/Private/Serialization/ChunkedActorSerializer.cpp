@@ -0,0 +1,381 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Serialization/ChunkedActorSerializer.h"
+
+#include <Async/ParallelFor.h>
+#include <GameFramework/Actor.h>
+#include <Misc/ScopeLock.h>
+#include <Serialization/MemoryReader.h>
+#include <Serialization/MemoryWriter.h>
+#include <Serialization/StructuredArchive.h>
+#include <UObject/UnrealType.h>
+
+#include "Serialization/NativeSerializers.h"
+#include "Serialization/RecordMagic.h"
+#include "Serialization/SEArchive.h"
+
+
+/////////////////////////////////////////////////////
+// Helpers
+
+namespace ChunkedActor
+{
+	/** A container holds at least the length of its name and its number of chunks */
+	static constexpr int64 MinContainerBytes = 2 * sizeof(int32);
+
+	static int32 GetNum(const FProperty* Property, const void* Value)
+	{
+		if (const auto* ArrayProperty = CastField<FArrayProperty>(Property))
+		{
+			return FScriptArrayHelper(ArrayProperty, Value).Num();
+		}
+		else if (const auto* MapProperty = CastField<FMapProperty>(Property))
+		{
+			return FScriptMapHelper(MapProperty, Value).Num();
+		}
+		return 0;
+	}
+
+	/** Container elements by chunk. Maps can have gaps between valid indices */
+	static void GetChunkIndices(const FProperty* Property, const void* Value, int32 ChunkSize, TArray<TArray<int32>>& OutChunks)
+	{
+		TArray<int32>* Chunk = nullptr;
+		auto AddIndex = [&OutChunks, &Chunk, ChunkSize](int32 Index)
+		{
+			if (!Chunk || Chunk->Num() >= ChunkSize)
+			{
+				Chunk = &OutChunks.AddDefaulted_GetRef();
+				Chunk->Reserve(ChunkSize);
+			}
+			Chunk->Add(Index);
+		};
+
+		if (const auto* ArrayProperty = CastField<FArrayProperty>(Property))
+		{
+			const int32 Num = FScriptArrayHelper(ArrayProperty, Value).Num();
+			for (int32 I = 0; I < Num; ++I)
+			{
+				AddIndex(I);
+			}
+		}
+		else if (const auto* MapProperty = CastField<FMapProperty>(Property))
+		{
+			FScriptMapHelper Helper(MapProperty, Value);
+			for (int32 I = 0; I < Helper.GetMaxIndex(); ++I)
+			{
+				if (Helper.IsValidIndex(I))
+				{
+					AddIndex(I);
+				}
+			}
+		}
+	}
+
+	static void SerializeElements(const FProperty* Property, void* Value, TArrayView<const int32> Indices, FArchive& Ar)
+	{
+		FStructuredArchiveFromArchive Structured(Ar);
+		FStructuredArchive::FStream Stream = Structured.GetSlot().EnterStream();
+
+		if (const auto* ArrayProperty = CastField<FArrayProperty>(Property))
+		{
+			FScriptArrayHelper Helper(ArrayProperty, Value);
+			for (const int32 Index : Indices)
+			{
+				ArrayProperty->Inner->SerializeItem(Stream.EnterElement(), Helper.GetRawPtr(Index));
+			}
+		}
+		else if (const auto* MapProperty = CastField<FMapProperty>(Property))
+		{
+			FScriptMapHelper Helper(MapProperty, Value);
+			for (const int32 Index : Indices)
+			{
+				MapProperty->KeyProp->SerializeItem(Stream.EnterElement(), Helper.GetKeyPtr(Index));
+				MapProperty->ValueProp->SerializeItem(Stream.EnterElement(), Helper.GetValuePtr(Index));
+			}
+		}
+	}
+
+	/** Resets a container to Num default elements that can be deserialized in parallel */
+	static void PrepareElements(const FProperty* Property, void* Value, int32 Num)
+	{
+		if (const auto* ArrayProperty = CastField<FArrayProperty>(Property))
+		{
+			FScriptArrayHelper Helper(ArrayProperty, Value);
+			Helper.EmptyAndAddValues(Num);
+		}
+		else if (const auto* MapProperty = CastField<FMapProperty>(Property))
+		{
+			FScriptMapHelper Helper(MapProperty, Value);
+			Helper.EmptyValues(Num);
+			for (int32 I = 0; I < Num; ++I)
+			{
+				Helper.AddDefaultValue_Invalid_NeedsRehash();
+			}
+		}
+	}
+
+	/** Loading object references finds or loads objects, which can only be done on the game thread */
+	static bool HasObjectReferences(const FProperty* Property)
+	{
+		TArray<const FStructProperty*> EncounteredStructs;
+		return Property->ContainsObjectReference(EncounteredStructs,
+			EPropertyObjectReferenceType::Strong | EPropertyObjectReferenceType::Weak);
+	}
+
+	static void FinishElements(const FProperty* Property, void* Value)
+	{
+		if (const auto* MapProperty = CastField<FMapProperty>(Property))
+		{
+			FScriptMapHelper(MapProperty, Value).Rehash();
+		}
+	}
+}
+
+
+/////////////////////////////////////////////////////
+// FChunkedActorSerializer
+
+bool FChunkedActorSerializer::Save(AActor* Actor, TArray<uint8>& OutData)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkedActorSerializer::Save);
+
+	// Native serializers take care of the whole actor
+	if (FNativeSerializers::Find(Actor->GetClass()))
+	{
+		return false;
+	}
+
+	TArray<const FProperty*> BigProperties;
+	for (TFieldIterator<FProperty> It(Actor->GetClass()); It; ++It)
+	{
+		const FProperty* Property = *It;
+		if (Property->ArrayDim == 1 && Property->HasAnyPropertyFlags(CPF_SaveGame) &&
+			!Property->HasAnyPropertyFlags(CPF_Transient) &&
+			// Arrays of plain data are already copied in bulk
+			!FSEArchive::CanBulkSerialize(CastField<FArrayProperty>(Property)) &&
+			ChunkedActor::GetNum(Property, Property->ContainerPtrToValuePtr<void>(Actor)) >= MinChunkElements)
+		{
+			BigProperties.Add(Property);
+		}
+	}
+
+	if (BigProperties.Num() <= 0)
+	{
+		return false;
+	}
+
+	const int32 NumWorkers = FMath::Max(1, FPlatformMisc::NumberOfWorkerThreadsToSpawn());
+
+	FMemoryWriter Writer(OutData, true);
+	int32 Magic = RecordMagic::Chunked;
+	Writer << Magic;
+
+	int32 NumProperties = BigProperties.Num();
+	Writer << NumProperties;
+	for (const FProperty* Property : BigProperties)
+	{
+		void* Value = Property->ContainerPtrToValuePtr<void>(Actor);
+		const int32 Num = ChunkedActor::GetNum(Property, Value);
+		const int32 ChunkSize = FMath::Max(MinChunkElements, FMath::DivideAndRoundUp(Num, NumWorkers));
+
+		TArray<TArray<int32>> ChunkIndices;
+		ChunkedActor::GetChunkIndices(Property, Value, ChunkSize, ChunkIndices);
+
+		TArray<TArray<uint8>> Chunks;
+		Chunks.SetNum(ChunkIndices.Num());
+		ParallelFor(Chunks.Num(), [Property, Value, &Chunks, &ChunkIndices](int32 ChunkIndex)
+		{
+			FMemoryWriter ChunkWriter(Chunks[ChunkIndex], true);
+			FSEArchive Archive(ChunkWriter, false);
+
+			int32 ChunkNum = ChunkIndices[ChunkIndex].Num();
+			Archive << ChunkNum;
+			ChunkedActor::SerializeElements(Property, Value, ChunkIndices[ChunkIndex], Archive);
+		});
+
+		FString Name = Property->GetName();
+		Writer << Name;
+		Writer << Chunks;
+	}
+
+	// Everything else is serialized as usual
+	TArray<uint8> ActorData;
+	{
+		FMemoryWriter ActorWriter(ActorData, true);
+		FSEArchive Archive(ActorWriter, false);
+		Archive.SkippedProperties = MoveTemp(BigProperties);
+		Archive.SerializeObject(Actor);
+	}
+	Writer << ActorData;
+	return true;
+}
+
+bool FChunkedActorSerializer::Load(AActor* Actor, const TArray<uint8>& Data)
+{
+	if (!IsChunked(Data))
+	{
+		return false;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(FChunkedActorSerializer::Load);
+	check(IsInGameThread());
+
+	FMemoryReader Reader(Data, true);
+	int32 Magic = 0;
+	Reader << Magic;
+
+	struct FContainer
+	{
+		FString Name;
+		TArray<TArray<uint8>> Chunks;
+	};
+	// Counts and sizes are checked against the remaining bytes before allocating anything
+	int32 NumProperties = 0;
+	Reader << NumProperties;
+	if (!FSEArchive::CanLoad(Reader, int64(NumProperties) * ChunkedActor::MinContainerBytes))
+	{
+		return false;
+	}
+
+	TArray<FContainer> Containers;
+	Containers.SetNum(NumProperties);
+	for (FContainer& Container : Containers)
+	{
+		int32 NumChunks = 0;
+		if (!FSEArchive::LoadChecked(Reader, Container.Name))
+		{
+			return false;
+		}
+		Reader << NumChunks;
+		if (!FSEArchive::CanLoad(Reader, int64(NumChunks) * sizeof(int32)))
+		{
+			return false;
+		}
+
+		Container.Chunks.SetNum(NumChunks);
+		for (TArray<uint8>& Chunk : Container.Chunks)
+		{
+			if (!FSEArchive::LoadChecked(Reader, Chunk))
+			{
+				return false;
+			}
+		}
+	}
+
+	TArray<uint8> ActorData;
+	if (!FSEArchive::LoadChecked(Reader, ActorData))
+	{
+		return false;
+	}
+
+	// Big containers were not included here, so they are not overwritten
+	{
+		FMemoryReader ActorReader(ActorData, true);
+		FSEArchive Archive(ActorReader, false);
+		if (!Archive.SerializeObject(Actor))
+		{
+			return false;
+		}
+	}
+
+	for (const FContainer& Container : Containers)
+	{
+		const FProperty* Property = FindFProperty<FProperty>(Actor->GetClass(), *Container.Name);
+		if (!Property || !(Property->IsA<FArrayProperty>() || Property->IsA<FMapProperty>()))
+		{
+			// The class changed since it was saved
+			continue;
+		}
+		void* Value = Property->ContainerPtrToValuePtr<void>(Actor);
+
+		// Each chunk starts with its number of elements. Every element takes at least one byte
+		TArray<int32> ChunkStarts;
+		ChunkStarts.Reserve(Container.Chunks.Num());
+		int64 Num = 0;
+		for (const TArray<uint8>& Chunk : Container.Chunks)
+		{
+			ChunkStarts.Add(int32(Num));
+
+			int32 ChunkNum = 0;
+			FMemoryReader ChunkReader(Chunk, true);
+			ChunkReader << ChunkNum;
+			if (!FSEArchive::CanLoad(ChunkReader, ChunkNum))
+			{
+				return false;
+			}
+			Num += ChunkNum;
+		}
+		if (Num > MAX_int32)
+		{
+			return false;
+		}
+
+		ChunkedActor::PrepareElements(Property, Value, int32(Num));
+
+		const bool bSingleThread = ChunkedActor::HasObjectReferences(Property);
+		FThreadSafeBool bFailed = false;
+		ParallelFor(Container.Chunks.Num(), [Property, Value, &Container, &ChunkStarts, &bFailed](int32 ChunkIndex)
+		{
+			FMemoryReader ChunkReader(Container.Chunks[ChunkIndex], true);
+			FSEArchive Archive(ChunkReader, false);
+
+			int32 ChunkNum = 0;
+			Archive << ChunkNum;
+
+			TArray<int32> Indices;
+			Indices.Reserve(ChunkNum);
+			for (int32 I = 0; I < ChunkNum; ++I)
+			{
+				Indices.Add(ChunkStarts[ChunkIndex] + I);
+			}
+			ChunkedActor::SerializeElements(Property, Value, Indices, Archive);
+			if (Archive.IsError())
+			{
+				bFailed = true;
+			}
+		}, bSingleThread);
+
+		ChunkedActor::FinishElements(Property, Value);
+		if (bFailed)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool FChunkedActorSerializer::IsChunked(const TArray<uint8>& Data)
+{
+	return Data.Num() >= sizeof(int32) && *reinterpret_cast<const int32*>(Data.GetData()) == RecordMagic::Chunked;
+}
+
+
+/////////////////////////////////////////////////////
+// FLargeActorSizes
+
+bool FLargeActorSizes::IsLarge(const AActor* Actor, int32 MinBytes) const
+{
+	FScopeLock ScopeLock(&Lock);
+	const int32* Size = Sizes.Find(FObjectKey{ Actor });
+	return Size && *Size >= MinBytes;
+}
+
+void FLargeActorSizes::RecordSize(const AActor* Actor, int32 Bytes, int32 MinBytes)
+{
+	FScopeLock ScopeLock(&Lock);
+	// Only large actors are remembered
+	if (Bytes >= MinBytes)
+	{
+		Sizes.Add(FObjectKey{ Actor }, Bytes);
+	}
+	else
+	{
+		Sizes.Remove(FObjectKey{ Actor });
+	}
+}
+
+void FLargeActorSizes::Empty()
+{
+	FScopeLock ScopeLock(&Lock);
+	Sizes.Empty();
+}
@@ -0,0 +1,311 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Serialization/InstancesRecord.h"
+
+#include <Components/InstancedStaticMeshComponent.h>
+#include <Engine/Level.h>
+#include <GameFramework/Actor.h>
+#include <Misc/ScopeLock.h>
+
+#include "LevelFilter.h"
+
+
+/////////////////////////////////////////////////////
+// Helpers
+
+namespace Instances
+{
+	/** Transforms rebuilt from a matrix never match it bit by bit */
+	static constexpr float Tolerance = KINDA_SMALL_NUMBER;
+
+	static FORCEINLINE bool Equals(const FMatrix& A, const FMatrix& B)
+	{
+		return A.Equals(B, Tolerance);
+	}
+
+	/**
+	 * Only hashes the location, rounded to whole units. Equal transforms can still land in
+	 * different cells, which only makes their instance be saved as modified
+	 */
+	static FORCEINLINE uint32 Hash(const FMatrix& Transform)
+	{
+		const FVector Origin = Transform.GetOrigin();
+		return HashCombine(HashCombine(
+			::GetTypeHash(FMath::RoundToInt(Origin.X)),
+			::GetTypeHash(FMath::RoundToInt(Origin.Y))),
+			::GetTypeHash(FMath::RoundToInt(Origin.Z)));
+	}
+
+	/** Moves, removes or adds the instances that differ from the baseline */
+	static void RestoreBaseline(UInstancedStaticMeshComponent* Component, const TArray<FMatrix>& Base)
+	{
+		const int32 NumCurrent = Component->PerInstanceSMData.Num();
+		const int32 NumShared = FMath::Min(NumCurrent, Base.Num());
+
+		bool bMoved = false;
+		for (int32 I = 0; I < NumShared; ++I)
+		{
+			if (!Equals(Component->PerInstanceSMData[I].Transform, Base[I]))
+			{
+				Component->UpdateInstanceTransform(I, FTransform{ Base[I] }, false, false, true);
+				bMoved = true;
+			}
+		}
+
+		// Removing from the end never shifts other instances
+		for (int32 I = NumCurrent - 1; I >= Base.Num(); --I)
+		{
+			Component->RemoveInstance(I);
+		}
+
+		if (NumCurrent < Base.Num())
+		{
+			TArray<FTransform> MissingTransforms;
+			MissingTransforms.Reserve(Base.Num() - NumCurrent);
+			for (int32 I = NumCurrent; I < Base.Num(); ++I)
+			{
+				MissingTransforms.Add(FTransform{ Base[I] });
+			}
+			Component->AddInstances(MissingTransforms, false);
+		}
+
+		if (bMoved)
+		{
+			Component->MarkRenderStateDirty();
+		}
+	}
+}
+
+
+/////////////////////////////////////////////////////
+// FInstanceBaselines
+
+FCriticalSection FInstanceBaselines::Lock;
+TMap<FObjectKey, FInstancesBaseline> FInstanceBaselines::Baselines;
+
+void FInstanceBaselines::CaptureLevel(const ULevel* Level, const FSELevelFilter& Filter)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FInstanceBaselines::CaptureLevel);
+	if (!IsValid(Level) || !Filter.bStoreComponents)
+	{
+		return;
+	}
+
+	for (const AActor* Actor : Level->Actors)
+	{
+		if (!IsValid(Actor) || !Filter.ShouldSave(Actor))
+		{
+			continue;
+		}
+
+		for (const UActorComponent* Component : Actor->GetComponents())
+		{
+			const auto* InstancedComponent = Cast<UInstancedStaticMeshComponent>(Component);
+			if (InstancedComponent && Filter.ShouldSave(Component))
+			{
+				// A level shown again keeps its components and their original baseline
+				FindOrCapture(InstancedComponent);
+			}
+		}
+	}
+
+	// Forget components that don't exist anymore
+	FScopeLock ScopeLock(&Lock);
+	for (auto It = Baselines.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+FInstancesBaseline FInstanceBaselines::FindOrCapture(const UInstancedStaticMeshComponent* Component)
+{
+	// Capturing inside the lock keeps workers from racing to capture the same component
+	FScopeLock ScopeLock(&Lock);
+	FInstancesBaseline& Baseline = Baselines.FindOrAdd(FObjectKey{ Component });
+	if (!Baseline.IsValid())
+	{
+		Baseline = Capture(Component);
+	}
+	return Baseline;
+}
+
+FInstancesBaseline FInstanceBaselines::Capture(const UInstancedStaticMeshComponent* Component)
+{
+	TArray<FMatrix> Transforms;
+	Transforms.Reserve(Component->PerInstanceSMData.Num());
+	for (const FInstancedStaticMeshInstanceData& Instance : Component->PerInstanceSMData)
+	{
+		Transforms.Add(Instance.Transform);
+	}
+	return MakeShared<const TArray<FMatrix>, ESPMode::ThreadSafe>(MoveTemp(Transforms));
+}
+
+
+/////////////////////////////////////////////////////
+// FInstancesRecord
+
+void FInstancesRecord::Capture(const UInstancedStaticMeshComponent* Component)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FInstancesRecord::Capture);
+
+	const FInstancesBaseline Baseline = FInstanceBaselines::FindOrCapture(Component);
+	const TArray<FMatrix>& Base = *Baseline;
+	const TArray<FInstancedStaticMeshInstanceData>& Current = Component->PerInstanceSMData;
+
+	NumBaseInstances = Base.Num();
+	Removed.Empty();
+	ModifiedIndices.Reset();
+	ModifiedTransforms.Reset();
+	AddedTransforms.Reset();
+
+	TBitArray<> Matched(false, Base.Num());
+	TArray<int32> UnmatchedInstances;
+
+	// Most instances keep their index
+	const int32 NumShared = FMath::Min(Base.Num(), Current.Num());
+	for (int32 I = 0; I < NumShared; ++I)
+	{
+		if (Instances::Equals(Current[I].Transform, Base[I]))
+		{
+			Matched[I] = true;
+		}
+		else
+		{
+			UnmatchedInstances.Add(I);
+		}
+	}
+	for (int32 I = NumShared; I < Current.Num(); ++I)
+	{
+		UnmatchedInstances.Add(I);
+	}
+
+	if (UnmatchedInstances.Num() <= 0 && NumShared == Base.Num())
+	{
+		return;
+	}
+
+	// Removing instances shifts or swaps indices. Find the rest by their transform
+	TMultiMap<uint32, int32> BaseByHash;
+	for (int32 I = 0; I < Base.Num(); ++I)
+	{
+		if (!Matched[I])
+		{
+			BaseByHash.Add(Instances::Hash(Base[I]), I);
+		}
+	}
+
+	TArray<int32> ChangedInstances;
+	for (const int32 Index : UnmatchedInstances)
+	{
+		const FMatrix& Transform = Current[Index].Transform;
+
+		int32 BaseIndex = INDEX_NONE;
+		for (auto It = BaseByHash.CreateKeyIterator(Instances::Hash(Transform)); It; ++It)
+		{
+			if (Instances::Equals(Base[It.Value()], Transform))
+			{
+				BaseIndex = It.Value();
+				It.RemoveCurrent();
+				break;
+			}
+		}
+
+		if (BaseIndex != INDEX_NONE)
+		{
+			Matched[BaseIndex] = true;
+		}
+		else
+		{
+			ChangedInstances.Add(Index);
+		}
+	}
+
+	// Changed instances take the place of missing ones. Remaining missing instances were removed
+	int32 ChangedIndex = 0;
+	for (int32 I = 0; I < Base.Num(); ++I)
+	{
+		if (Matched[I])
+		{
+			continue;
+		}
+
+		if (ChangedIndex < ChangedInstances.Num())
+		{
+			ModifiedIndices.Add(I);
+			ModifiedTransforms.Add(FTransform{ Current[ChangedInstances[ChangedIndex++]].Transform });
+		}
+		else
+		{
+			if (Removed.Num() <= 0)
+			{
+				Removed.Init(false, Base.Num());
+			}
+			Removed[I] = true;
+		}
+	}
+
+	for (; ChangedIndex < ChangedInstances.Num(); ++ChangedIndex)
+	{
+		AddedTransforms.Add(FTransform{ Current[ChangedInstances[ChangedIndex]].Transform });
+	}
+}
+
+bool FInstancesRecord::Apply(UInstancedStaticMeshComponent* Component) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FInstancesRecord::Apply);
+
+	FInstancesBaseline Baseline = FInstanceBaselines::FindOrCapture(Component);
+	if (Baseline->Num() != NumBaseInstances)
+	{
+		// The level changed since this record was saved
+		return false;
+	}
+
+	// Instances may have changed since the level was loaded. Only the differences are restored
+	Instances::RestoreBaseline(Component, *Baseline);
+
+	if (!HasChanges())
+	{
+		return true;
+	}
+
+	// Indices refer to the baseline, so modify before removing
+	for (int32 I = 0; I < ModifiedIndices.Num(); ++I)
+	{
+		Component->UpdateInstanceTransform(ModifiedIndices[I], ModifiedTransforms[I], false, false, true);
+	}
+
+	if (Removed.Num() > 0)
+	{
+		TArray<int32> RemovedIndices;
+		for (TConstSetBitIterator<> It(Removed); It; ++It)
+		{
+			RemovedIndices.Add(It.GetIndex());
+		}
+		Component->RemoveInstances(RemovedIndices);
+	}
+
+	if (AddedTransforms.Num() > 0)
+	{
+		Component->AddInstances(AddedTransforms, false);
+	}
+
+	if (ModifiedIndices.Num() > 0)
+	{
+		Component->MarkRenderStateDirty();
+	}
+	return true;
+}
+
+FArchive& operator<<(FArchive& Ar, FInstancesRecord& Record)
+{
+	Ar << Record.NumBaseInstances;
+	Ar << Record.Removed;
+	Record.ModifiedIndices.BulkSerialize(Ar);
+	Ar << Record.ModifiedTransforms;
+	Ar << Record.AddedTransforms;
+	return Ar;
+}
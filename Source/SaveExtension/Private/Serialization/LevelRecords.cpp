@@ -3,6 +3,9 @@
 #include "Serialization/LevelRecords.h"
 #include "SlotData.h"
 
+#include <Algo/BinarySearch.h>
+#include <Algo/IsSorted.h>
+
 
 /////////////////////////////////////////////////////
 // LevelRecords
@@ -24,6 +27,10 @@ bool FLevelRecord::Serialize(FArchive& Ar)
 	Ar << LevelScript;
 	Ar << Actors;
 
+	if (Ar.IsLoading())
+	{
+		UpdateSortedActors();
+	}
 	return true;
 }
 
@@ -31,4 +38,42 @@ void FLevelRecord::CleanRecords()
 {
 	LevelScript = {};
 	Actors.Empty();
+	bSortedActors = false;
+}
+
+void FLevelRecord::SortActors()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FLevelRecord::SortActors);
+	Actors.Sort(FRecordOrder{});
+	bSortedActors = true;
+}
+
+void FLevelRecord::UpdateSortedActors()
+{
+	bSortedActors = Algo::IsSorted(Actors, FRecordOrder{});
+}
+
+const FActorRecord* FLevelRecord::FindActorRecord(const AActor* Actor) const
+{
+	if (!Actor)
+	{
+		return nullptr;
+	}
+
+	if (!bSortedActors)
+	{
+		return Actors.FindByKey(Actor);
+	}
+
+	struct FKey
+	{
+		const UClass* Class;
+		FName Name;
+	};
+	const int32 Index = Algo::LowerBound(Actors, FKey{ Actor->GetClass(), Actor->GetFName() },
+		[](const FActorRecord& Record, const FKey& Key)
+		{
+			return FRecordOrder::Compare(Record.Class, Record.Name, Key.Class, Key.Name) < 0;
+		});
+	return (Actors.IsValidIndex(Index) && Actors[Index] == Actor)? &Actors[Index] : nullptr;
 }
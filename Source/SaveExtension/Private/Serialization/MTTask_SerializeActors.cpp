@@ -2,12 +2,16 @@
 
 #include "Serialization/MTTask_SerializeActors.h"
 #include <Serialization/MemoryWriter.h>
+#include <Components/InstancedStaticMeshComponent.h>
 #include <Components/PrimitiveComponent.h>
 
+#include "Misc/SerializationWatchdog.h"
 #include "SaveManager.h"
 #include "SlotInfo.h"
 #include "SlotData.h"
 #include "SavePreset.h"
+#include "Serialization/ChunkedActorSerializer.h"
+#include "Serialization/InstancesRecord.h"
 #include "Serialization/SEArchive.h"
 
 
@@ -42,7 +46,7 @@ void FMTTask_SerializeActors::SerializeGameInstance()
 		//Serialize into Record Data
 		FMemoryWriter MemoryWriter(Record.Data, true);
 		FSEArchive Archive(MemoryWriter, false);
-		GameInstance->Serialize(Archive);
+		Archive.SerializeObject(GameInstance);
 
 		SlotData->GameInstance = MoveTemp(Record);
 	}
@@ -81,7 +85,15 @@ bool FMTTask_SerializeActors::SerializeActor(const AActor* Actor, FActorRecord&
 		if (Filter.StoresPhysics(Actor))
 		{
 			USceneComponent* const Root = Actor->GetRootComponent();
-			if (Root && Root->Mobility == EComponentMobility::Movable)
+			const FActorPhysicsState* PhysicsState = Physics? Physics->Find(Actor) : nullptr;
+			if (PhysicsState)
+			{
+				// Consistent with all other bodies at the time of saving
+				Record.Transform = PhysicsState->Transform;
+				Record.LinearVelocity = PhysicsState->LinearVelocity;
+				Record.AngularVelocity = PhysicsState->AngularVelocity;
+			}
+			else if (Root && Root->Mobility == EComponentMobility::Movable)
 			{
 				if (auto* const Primitive = Cast<UPrimitiveComponent>(Root))
 				{
@@ -102,10 +114,23 @@ bool FMTTask_SerializeActors::SerializeActor(const AActor* Actor, FActorRecord&
 	}
 
 	TRACE_CPUPROFILER_EVENT_SCOPE(Serialize);
-	FMemoryWriter MemoryWriter(Record.Data, true);
-	FSEArchive Archive(MemoryWriter, false);
-	const_cast<AActor*>(Actor)->Serialize(Archive);
+	const FScopedSerializationWatch Watch{ FSerializationWatchdog::EOperation::Save, Actor, Record.Data };
+	AActor* const MutableActor = const_cast<AActor*>(Actor);
+	const bool bChunked = LargeActorBytes > 0 &&
+		LargeActors->IsLarge(Actor, LargeActorBytes) &&
+		FChunkedActorSerializer::Save(MutableActor, Record.Data);
+	if (!bChunked)
+	{
+		Record.Data.Reset();
+		FMemoryWriter MemoryWriter(Record.Data, true);
+		FSEArchive Archive(MemoryWriter, false);
+		Archive.SerializeObject(MutableActor);
+	}
 
+	if (LargeActorBytes > 0)
+	{
+		LargeActors->RecordSize(Actor, Record.Data.Num(), LargeActorBytes);
+	}
 	return true;
 }
 
@@ -120,6 +145,7 @@ void FMTTask_SerializeActors::SerializeActorComponents(const AActor* Actor, FAct
 		if (Filter.ShouldSave(Component))
 		{
 			FComponentRecord ComponentRecord;
+			const FScopedSerializationWatch Watch{ FSerializationWatchdog::EOperation::Save, Component, ComponentRecord.Data };
 			ComponentRecord.Name = Component->GetFName();
 			ComponentRecord.Class = Component->GetClass();
 
@@ -137,13 +163,25 @@ void FMTTask_SerializeActors::SerializeActorComponents(const AActor* Actor, FAct
 				ComponentRecord.Tags = Component->ComponentTags;
 			}
 
-			if (!Component->GetClass()->IsChildOf<UPrimitiveComponent>())
+			if (const auto* InstancedComponent = Cast<UInstancedStaticMeshComponent>(Component))
+			{
+				// Only changes to the instances are stored
+				FInstancesRecord InstancesRecord;
+				InstancesRecord.Capture(InstancedComponent);
+
+				FMemoryWriter MemoryWriter(ComponentRecord.Data, true);
+				MemoryWriter << InstancesRecord;
+			}
+			else if (!Component->GetClass()->IsChildOf<UPrimitiveComponent>())
 			{
 				FMemoryWriter MemoryWriter(ComponentRecord.Data, true);
 				FSEArchive Archive(MemoryWriter, false);
-				Component->Serialize(Archive);
+				Archive.SerializeObject(Component);
 			}
 			ActorRecord.ComponentRecords.Add(ComponentRecord);
 		}
 	}
+
+	// Components are iterated from a set, in no particular order
+	ActorRecord.ComponentRecords.Sort(FRecordOrder{});
 }
@@ -0,0 +1,64 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Serialization/NativeSerializers.h"
+
+#include <Misc/ScopeRWLock.h>
+
+
+/////////////////////////////////////////////////////
+// FNativeSerializers
+
+FRWLock FNativeSerializers::Lock;
+TMap<const UClass*, TSharedPtr<const FNativeSerializers::FSerializer, ESPMode::ThreadSafe>> FNativeSerializers::Serializers;
+TMap<FObjectKey, TSharedPtr<const FNativeSerializers::FSerializer, ESPMode::ThreadSafe>> FNativeSerializers::ClassCache;
+
+
+void FNativeSerializers::Register(const UClass* Class, FSerializer&& Serializer)
+{
+	check(Class);
+	FRWScopeLock ScopeLock(Lock, SLT_Write);
+	Serializers.Add(Class, MakeShared<const FSerializer, ESPMode::ThreadSafe>(MoveTemp(Serializer)));
+	ClassCache.Empty();
+}
+
+void FNativeSerializers::Unregister(const UClass* Class)
+{
+	FRWScopeLock ScopeLock(Lock, SLT_Write);
+	Serializers.Remove(Class);
+	ClassCache.Empty();
+}
+
+TSharedPtr<const FNativeSerializers::FSerializer, ESPMode::ThreadSafe> FNativeSerializers::Find(const UClass* Class)
+{
+	if (!Class)
+	{
+		return {};
+	}
+
+	const FObjectKey Key{ Class };
+	{
+		FRWScopeLock ScopeLock(Lock, SLT_ReadOnly);
+		if (Serializers.Num() <= 0)
+		{
+			return {};
+		}
+
+		if (const auto* Cached = ClassCache.Find(Key))
+		{
+			return *Cached;
+		}
+	}
+
+	FRWScopeLock ScopeLock(Lock, SLT_Write);
+	TSharedPtr<const FSerializer, ESPMode::ThreadSafe> Serializer;
+	for (const UClass* Current = Class; Current; Current = Current->GetSuperClass())
+	{
+		if (const auto* Found = Serializers.Find(Current))
+		{
+			Serializer = *Found;
+			break;
+		}
+	}
+	ClassCache.Add(Key, Serializer);
+	return Serializer;
+}
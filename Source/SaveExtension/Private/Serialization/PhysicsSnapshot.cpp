@@ -0,0 +1,81 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Serialization/PhysicsSnapshot.h"
+
+#include <Components/PrimitiveComponent.h>
+#include <Engine/World.h>
+#include <GameFramework/Actor.h>
+#include <Physics/PhysicsInterfaceCore.h>
+
+#include "LevelFilter.h"
+
+
+/////////////////////////////////////////////////////
+// FPhysicsSnapshot
+
+void FPhysicsSnapshot::Gather(const TArray<AActor*>& Actors, int32 StartIndex, int32 Num, const FSELevelFilter& Filter)
+{
+	const int32 EndIndex = FMath::Min(StartIndex + Num, Actors.Num());
+	for (int32 I = StartIndex; I < EndIndex; ++I)
+	{
+		const AActor* Actor = Actors[I];
+		if (!Actor || !Filter.ShouldSave(Actor) ||
+			!Filter.StoresTransform(Actor) || !Filter.StoresPhysics(Actor))
+		{
+			continue;
+		}
+
+		const auto* Primitive = Cast<UPrimitiveComponent>(Actor->GetRootComponent());
+		if (Primitive && Primitive->Mobility == EComponentMobility::Movable && Primitive->IsSimulatingPhysics())
+		{
+			PendingActors.Add(Actor);
+		}
+	}
+}
+
+void FPhysicsSnapshot::Capture(const UWorld* World)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FPhysicsSnapshot::Capture);
+
+	FPhysScene* Scene = World? World->GetPhysicsScene() : nullptr;
+	if (!Scene || PendingActors.Num() <= 0)
+	{
+		PendingActors.Reset();
+		return;
+	}
+
+	States.Reserve(States.Num() + PendingActors.Num());
+
+	// A single read lock keeps all bodies consistent with each other
+	FPhysicsCommand::ExecuteRead(Scene, [this]()
+	{
+		for (const AActor* Actor : PendingActors)
+		{
+			const auto* Primitive = CastChecked<UPrimitiveComponent>(Actor->GetRootComponent());
+			const FBodyInstance* Body = Primitive->GetBodyInstance();
+			if (!Body || !Body->IsValidBodyInstance())
+			{
+				continue;
+			}
+
+			const FPhysicsActorHandle& Handle = Body->GetPhysicsActorHandle();
+
+			FActorPhysicsState& State = States.Add(Actor);
+			State.bSleeping = FPhysicsInterface::IsSleeping(Handle);
+			State.bKinematic = FPhysicsInterface::IsKinematic_AssumesLocked(Handle);
+
+			// Bodies provide no scale
+			State.Transform = FPhysicsInterface::GetGlobalPose_AssumesLocked(Handle);
+			State.Transform.SetScale3D(Actor->GetActorScale3D());
+
+			// Sleeping and kinematic bodies are restored without velocity
+			if (!State.bSleeping && !State.bKinematic)
+			{
+				State.LinearVelocity = FPhysicsInterface::GetLinearVelocity_AssumesLocked(Handle);
+				State.AngularVelocity = FPhysicsInterface::GetAngularVelocity_AssumesLocked(Handle);
+			}
+		}
+	});
+
+	PendingActors.Reset();
+}
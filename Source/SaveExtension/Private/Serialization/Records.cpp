@@ -23,6 +23,29 @@ FObjectRecord::FObjectRecord(const UObject* Object) : Super()
 	}
 }
 
+int32 FRecordOrder::Compare(const UClass* ClassA, FName NameA, const UClass* ClassB, FName NameB)
+{
+	if (ClassA != ClassB)
+	{
+		if (!ClassA || !ClassB)
+		{
+			return ClassA? 1 : -1;
+		}
+
+		// Names are compared as text. Their indices change between runs
+		int32 Result = ClassA->GetFName().Compare(ClassB->GetFName());
+		if (Result == 0)
+		{
+			Result = ClassA->GetOutermost()->GetFName().Compare(ClassB->GetOutermost()->GetFName());
+		}
+		if (Result != 0)
+		{
+			return Result;
+		}
+	}
+	return NameA.Compare(NameB);
+}
+
 bool FObjectRecord::Serialize(FArchive& Ar)
 {
 	Super::Serialize(Ar);
@@ -2,6 +2,72 @@
 
 #include "Serialization/SEArchive.h"
 #include <UObject/NoExportTypes.h>
+#include <UObject/UnrealType.h>
+
+#include "ISaveExtension.h"
+#include "Serialization/NativeSerializers.h"
+#include "Serialization/RecordMagic.h"
+
+
+/////////////////////////////////////////////////////
+// Helpers
+
+namespace SEArchive
+{
+	/**
+	 * @return size of the values to swap when endianness differs (e.g 4 for FVector).
+	 * 0 if the type is not plain data or its values have different sizes
+	 */
+	static int32 GetSwapSize(const FProperty* Property)
+	{
+		if (Property->IsA<FNumericProperty>())
+		{
+			return Property->ElementSize;
+		}
+
+		const auto* StructProperty = CastField<FStructProperty>(Property);
+		const UScriptStruct* Struct = StructProperty? StructProperty->Struct : nullptr;
+		if (!Struct || !(Struct->StructFlags & STRUCT_IsPlainOldData))
+		{
+			return 0;
+		}
+
+		// Immutable structs (FVector, FColor...) are always saved whole. Others only save their SaveGame fields
+		const bool bImmutable = (Struct->StructFlags & STRUCT_Immutable) != 0;
+
+		int32 SwapSize = 0;
+		int32 TotalSize = 0;
+		for (TFieldIterator<FProperty> It(Struct); It; ++It)
+		{
+			if (!bImmutable && !It->HasAnyPropertyFlags(CPF_SaveGame))
+			{
+				return 0;
+			}
+
+			const int32 FieldSwapSize = GetSwapSize(*It);
+			if (FieldSwapSize <= 0 || (SwapSize > 0 && FieldSwapSize != SwapSize))
+			{
+				return 0;
+			}
+			SwapSize = FieldSwapSize;
+			TotalSize += It->ElementSize * It->ArrayDim;
+		}
+
+		// Padding would be copied as garbage
+		return TotalSize == Struct->GetStructureSize()? SwapSize : 0;
+	}
+
+	static void SwapBytes(uint8* Data, int32 Size, int32 SwapSize)
+	{
+		for (int32 Offset = 0; Offset + SwapSize <= Size; Offset += SwapSize)
+		{
+			for (int32 I = 0, J = SwapSize - 1; I < J; ++I, --J)
+			{
+				Swap(Data[Offset + I], Data[Offset + J]);
+			}
+		}
+	}
+}
 
 
 /////////////////////////////////////////////////////
@@ -66,3 +132,221 @@ FArchive& FSEArchive::operator<<(UObject*& Obj)
 	}
 	return *this;
 }
+
+bool FSEArchive::SerializeObject(UObject* Object)
+{
+	check(Object);
+	const auto NativeSerializer = FNativeSerializers::Find(Object->GetClass());
+
+	if (IsLoading())
+	{
+		// Reflected data without bulk arrays starts directly with tagged properties
+		const int64 Start = Tell();
+		int32 Magic = 0;
+		if (TotalSize() - Start >= int64(sizeof(int32)))
+		{
+			*this << Magic;
+		}
+
+		if (Magic == RecordMagic::Native)
+		{
+			int32 Size = 0;
+			*this << Size;
+			if (NativeSerializer)
+			{
+				(*NativeSerializer)(*Object, *this);
+			}
+			else if (CanLoad(*this, Size))
+			{
+				UE_LOG(LogSaveExtension, Warning, TEXT("'%s' was saved with a native serializer that is not registered"), *Object->GetName());
+				Seek(Tell() + Size);
+			}
+			return !IsError();
+		}
+		else if (Magic == RecordMagic::Bulk)
+		{
+			LoadBulkArrays(Object);
+			if (IsError())
+			{
+				return false;
+			}
+		}
+		else
+		{
+			Seek(Start);
+		}
+		Object->Serialize(*this);
+		return !IsError();
+	}
+
+	if (NativeSerializer)
+	{
+		int32 Magic = RecordMagic::Native;
+		*this << Magic;
+
+		// Size is written after so that data can be skipped if the serializer is not registered when loading
+		const int64 SizePosition = Tell();
+		int32 Size = 0;
+		*this << Size;
+		(*NativeSerializer)(*Object, *this);
+
+		const int64 End = Tell();
+		Size = int32(End - SizePosition - sizeof(int32));
+		Seek(SizePosition);
+		*this << Size;
+		Seek(End);
+		return !IsError();
+	}
+
+	TArray<const FArrayProperty*> BulkProperties;
+	for (TFieldIterator<FArrayProperty> It(Object->GetClass()); It; ++It)
+	{
+		const FArrayProperty* Property = *It;
+		if (Property->ArrayDim == 1 && Property->HasAnyPropertyFlags(CPF_SaveGame) &&
+			!Property->HasAnyPropertyFlags(CPF_Transient) &&
+			!ShouldSkipProperty(Property) && CanBulkSerialize(Property))
+		{
+			BulkProperties.Add(Property);
+		}
+	}
+
+	if (BulkProperties.Num() <= 0)
+	{
+		Object->Serialize(*this);
+		return !IsError();
+	}
+
+	SaveBulkArrays(Object, BulkProperties);
+
+	// Bulk arrays are not saved again as tagged properties
+	const int32 NumSkipped = SkippedProperties.Num();
+	SkippedProperties.Append(BulkProperties);
+	Object->Serialize(*this);
+	SkippedProperties.SetNum(NumSkipped);
+	return !IsError();
+}
+
+bool FSEArchive::CanBulkSerialize(const FArrayProperty* Property)
+{
+	return Property && SEArchive::GetSwapSize(Property->Inner) > 0;
+}
+
+bool FSEArchive::CanLoad(FArchive& Ar, int64 Size)
+{
+	if (Ar.IsError() || Size < 0 || Size > Ar.TotalSize() - Ar.Tell())
+	{
+		Ar.SetError();
+		return false;
+	}
+	return true;
+}
+
+bool FSEArchive::LoadChecked(FArchive& Ar, FString& Value)
+{
+	// Negative lengths are UCS2 strings
+	const int64 Start = Ar.Tell();
+	int32 SaveNum = 0;
+	Ar << SaveNum;
+	const int64 Size = (SaveNum < 0)? -int64(SaveNum) * sizeof(UCS2CHAR) : int64(SaveNum);
+	if (!CanLoad(Ar, Size))
+	{
+		return false;
+	}
+
+	Ar.Seek(Start);
+	Ar << Value;
+	return !Ar.IsError();
+}
+
+bool FSEArchive::LoadChecked(FArchive& Ar, TArray<uint8>& Value)
+{
+	int32 Num = 0;
+	Ar << Num;
+	if (!CanLoad(Ar, Num))
+	{
+		return false;
+	}
+
+	Value.SetNumUninitialized(Num);
+	Ar.Serialize(Value.GetData(), Num);
+	return !Ar.IsError();
+}
+
+void FSEArchive::SaveBulkArrays(UObject* Object, const TArray<const FArrayProperty*>& Properties)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FSEArchive::SaveBulkArrays);
+
+	int32 Magic = RecordMagic::Bulk;
+	*this << Magic;
+
+	uint8 bLittleEndian = PLATFORM_LITTLE_ENDIAN;
+	*this << bLittleEndian;
+
+	int32 NumProperties = Properties.Num();
+	*this << NumProperties;
+	for (const FArrayProperty* Property : Properties)
+	{
+		FScriptArrayHelper Helper(Property, Property->ContainerPtrToValuePtr<void>(Object));
+
+		FString Name = Property->GetName();
+		int32 ElementSize = Property->Inner->ElementSize;
+		int32 Num = Helper.Num();
+		*this << Name;
+		*this << ElementSize;
+		*this << Num;
+		if (Num > 0)
+		{
+			Serialize(Helper.GetRawPtr(), int64(Num) * ElementSize);
+		}
+	}
+}
+
+void FSEArchive::LoadBulkArrays(UObject* Object)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FSEArchive::LoadBulkArrays);
+
+	uint8 bLittleEndian = PLATFORM_LITTLE_ENDIAN;
+	*this << bLittleEndian;
+	const bool bSwap = bool(bLittleEndian) != bool(PLATFORM_LITTLE_ENDIAN);
+
+	int32 NumProperties = 0;
+	*this << NumProperties;
+	for (int32 I = 0; I < NumProperties && !IsError(); ++I)
+	{
+		FString Name;
+		int32 ElementSize = 0;
+		int32 Num = 0;
+		if (!LoadChecked(*this, Name))
+		{
+			return;
+		}
+		*this << ElementSize;
+		*this << Num;
+		const int64 Size = int64(Num) * ElementSize;
+		if (Num < 0 || ElementSize <= 0 || !CanLoad(*this, Size))
+		{
+			// Corrupted record. Nothing read after this can be trusted
+			SetError();
+			return;
+		}
+
+		const auto* Property = FindFProperty<FArrayProperty>(Object->GetClass(), *Name);
+		if (!CanBulkSerialize(Property) || Property->Inner->ElementSize != ElementSize)
+		{
+			// The class changed since it was saved
+			Seek(Tell() + Size);
+			continue;
+		}
+
+		FScriptArrayHelper Helper(Property, Property->ContainerPtrToValuePtr<void>(Object));
+		Helper.EmptyAndAddUninitializedValues(Num);
+		if (Num > 0)
+		{
+			Serialize(Helper.GetRawPtr(), Size);
+			if (bSwap)
+			{
+				SEArchive::SwapBytes(Helper.GetRawPtr(), Size, SEArchive::GetSwapSize(Property->Inner));
+			}
+		}
+	}
+}
@@ -34,6 +34,22 @@ void USlotDataTask::Finish(bool bSuccess)
 	}
 }
 
+bool USlotDataTask::Cancel()
+{
+	if (bFinished || !CanCancel())
+	{
+		return false;
+	}
+
+	CancelToken->Cancel();
+	OnCancel();
+
+	// Pending tasks finish as if they had started so that delegates get notified
+	bRunning = true;
+	Finish(false);
+	return true;
+}
+
 bool USlotDataTask::IsScheduled() const
 {
 	return GetManager()->Tasks.Contains(this);
@@ -83,7 +99,7 @@ FLevelRecord* USlotDataTask::FindLevelRecord(const ULevelStreaming* Level) const
 	if (!Level)
 		return &SlotData->MainLevel;
 	else // Find the Sub-Level
-		return SlotData->SubLevels.FindByKey(Level);
+		return SlotData->FindSubLevel(Level->GetWorldAssetPackageFName());
 }
 
 UWorld* USlotDataTask::GetWorld() const
@@ -2,6 +2,8 @@
 
 #include "Serialization/SlotDataTask_LevelLoader.h"
 
+#include "SaveManager.h"
+
 
 /////////////////////////////////////////////////////
 // USaveDataTask_LevelLoader
@@ -17,7 +19,12 @@ void USlotDataTask_LevelLoader::OnStart()
 			return;
 		}
 
-		GetLevelFilter(*LevelRecord).BakeAllowedClasses();
+		const FSELevelFilter& Filter = GetLevelFilter(*LevelRecord);
+		Filter.BakeAllowedClasses();
+
+		// Only subscribers in this level are notified
+		GetManager()->OnLoadBegan(Filter, StreamingLevel->GetLoadedLevel());
+		bNotifiedBegan = true;
 
 		if (Preset->IsFrameSplitLoad())
 		{
@@ -33,6 +40,16 @@ void USlotDataTask_LevelLoader::OnStart()
 	Finish(false);
 }
 
+void USlotDataTask_LevelLoader::OnFinish(bool bSuccess)
+{
+	const FLevelRecord* LevelRecord = SlotData? FindLevelRecord(StreamingLevel) : nullptr;
+	const ULevel* Level = StreamingLevel? StreamingLevel->GetLoadedLevel() : nullptr;
+	if (bNotifiedBegan && LevelRecord && Level)
+	{
+		GetManager()->OnLoadFinished(GetLevelFilter(*LevelRecord), !bSuccess, Level);
+	}
+}
+
 void USlotDataTask_LevelLoader::DeserializeASyncLoop(float StartMS /*= 0.0f*/)
 {
 	FLevelRecord& LevelRecord = *FindLevelRecord(CurrentSLevel.Get());
@@ -2,6 +2,8 @@
 
 #include "Serialization/SlotDataTask_LevelSaver.h"
 
+#include "SaveManager.h"
+
 
 /////////////////////////////////////////////////////
 // FSaveDataTask_LevelSaver
@@ -17,7 +19,12 @@ void USlotDataTask_LevelSaver::OnStart()
 			return;
 		}
 
-		GetLevelFilter(*LevelRecord).BakeAllowedClasses();
+		const FSELevelFilter& Filter = GetLevelFilter(*LevelRecord);
+		Filter.BakeAllowedClasses();
+
+		// Only subscribers in this level are notified
+		GetManager()->OnSaveBegan(Filter, StreamingLevel->GetLoadedLevel());
+		bNotifiedBegan = true;
 
 		const int32 NumberOfThreads = FMath::Max(1, FPlatformMisc::NumberOfWorkerThreadsToSpawn());
 		SerializeLevelSync(StreamingLevel->GetLoadedLevel(), NumberOfThreads, StreamingLevel);
@@ -29,3 +36,15 @@ void USlotDataTask_LevelSaver::OnStart()
 	}
 	Finish(false);
 }
+
+void USlotDataTask_LevelSaver::OnFinish(bool bSuccess)
+{
+	SELog(Preset, "Finished Serializing level", FColor::Green);
+
+	const FLevelRecord* LevelRecord = SlotData? FindLevelRecord(StreamingLevel) : nullptr;
+	const ULevel* Level = StreamingLevel? StreamingLevel->GetLoadedLevel() : nullptr;
+	if (bNotifiedBegan && LevelRecord && Level)
+	{
+		GetManager()->OnSaveFinished(GetLevelFilter(*LevelRecord), !bSuccess, Level);
+	}
+}
@@ -2,18 +2,83 @@
 
 #include "Serialization/SlotDataTask_Loader.h"
 
+#include <Camera/PlayerCameraManager.h>
 #include <GameFramework/Character.h>
+#include <GameFramework/PlayerController.h>
 #include <Serialization/MemoryReader.h>
 #include <Kismet/GameplayStatics.h>
+#include <Components/InstancedStaticMeshComponent.h>
 #include <Components/PrimitiveComponent.h>
+#include <Components/SceneComponent.h>
+#include <NavigationSystemTypes.h>
 #include <UObject/UObjectGlobals.h>
 
+#include "Misc/SerializationWatchdog.h"
 #include "Misc/SlotHelpers.h"
 #include "SavePreset.h"
 #include "SaveManager.h"
+#include "Serialization/ChunkedActorSerializer.h"
+#include "Serialization/InstancesRecord.h"
 #include "Serialization/SEArchive.h"
 
 
+/////////////////////////////////////////////////////
+// FDeferredMovementBatch
+
+FDeferredMovementBatch::FDeferredMovementBatch(USlotDataTask_Loader& InLoader)
+	: Loader(InLoader)
+	, bActive(InLoader.MovementBatch == nullptr)
+{
+	if (bActive)
+	{
+		Loader.MovementBatch = this;
+	}
+}
+
+FDeferredMovementBatch::~FDeferredMovementBatch()
+{
+	if (!bActive)
+	{
+		return;
+	}
+	TRACE_CPUPROFILER_EVENT_SCOPE(FDeferredMovementBatch::Release);
+
+	Loader.MovementBatch = nullptr;
+	while (Scopes.Num() > 0)
+	{
+		Scopes.Pop(false);
+	}
+
+	// Velocities are restored after bodies have been moved
+	for (const FVelocity& Velocity : Velocities)
+	{
+		USceneComponent* Component = Velocity.Component.Get();
+		if (auto* Primitive = Cast<UPrimitiveComponent>(Component))
+		{
+			Primitive->SetPhysicsLinearVelocity(Velocity.Linear);
+			Primitive->SetPhysicsAngularVelocityInRadians(Velocity.Angular);
+		}
+		else if (Component)
+		{
+			Component->ComponentVelocity = Velocity.Linear;
+		}
+	}
+}
+
+void FDeferredMovementBatch::Defer(USceneComponent* Component)
+{
+	if (Component)
+	{
+		Scopes.Add(MakeUnique<FScopedMovementUpdate>(Component, EScopedUpdate::DeferredUpdates));
+	}
+}
+
+void FDeferredMovementBatch::SetVelocity(USceneComponent* Component, const FVector& Linear, const FVector& Angular)
+{
+	Velocities.Add({ Component, Linear, Angular });
+}
+
+
 /////////////////////////////////////////////////////
 // Helpers
 
@@ -98,11 +163,20 @@ void USlotDataTask_Loader::Tick(float DeltaTime)
 	switch(LoadState)
 	{
 	case ELoadDataTaskState::Deserializing:
-		if (CurrentLevel.IsValid())
+	{
+		// Navigation and movement get updated once for all actors restored this frame
+		FNavigationLockContext NavigationLock(GetWorld(), ENavigationLockReason::Unknown);
+		FDeferredMovementBatch Movement{ *this };
+		if (bProgressive)
+		{
+			DeserializeProgressiveLoop();
+		}
+		else if (CurrentLevel.IsValid())
 		{
 			DeserializeASyncLoop();
 		}
 		break;
+	}
 
 	case ELoadDataTaskState::WaitingForData:
 		if (IsDataLoaded())
@@ -121,12 +195,41 @@ void USlotDataTask_Loader::OnFinish(bool bSuccess)
 	}
 
 	// Execute delegates
+	if (Promise)
+	{
+		Promise->SetValue(bSuccess ? NewSlotInfo : nullptr);
+	}
 	Delegate.ExecuteIfBound((bSuccess) ? NewSlotInfo : nullptr);
 
-	GetManager()->OnLoadFinished(
-		SlotData? GetGeneralFilter() : FSELevelFilter{},
-		!bSuccess
-	);
+	if (bNotifiedBegan)
+	{
+		GetManager()->OnLoadFinished(GetGeneralFilter(), !bSuccess);
+	}
+
+	// Loaded data of failed loads and merged snapshots is only referenced by this task
+	if (bNotifiedBegan && SlotData && SlotData != GetManager()->GetCurrentData())
+	{
+		GetManager()->GetObjectPool()->Release(SlotData);
+		SlotData = nullptr;
+	}
+}
+
+bool USlotDataTask_Loader::CanCancel() const
+{
+	// Once the map is being opened the world can't be restored to its previous state
+	return !IsRunning() || LoadState == ELoadDataTaskState::WaitingForData;
+}
+
+bool USlotDataTask_Loader::IsSupersededBy(const USlotDataTask& Other) const
+{
+	// Snapshot, subset and level loads restore other state and are never superseded
+	const UClass* LoaderClass = USlotDataTask_Loader::StaticClass();
+	return GetClass() == LoaderClass && Other.GetClass() == LoaderClass;
+}
+
+void USlotDataTask_Loader::OnCancel()
+{
+	SELog(Preset, "Loading cancelled", FColor::White, false, 1);
 }
 
 void USlotDataTask_Loader::BeginDestroy()
@@ -137,6 +240,11 @@ void USlotDataTask_Loader::BeginDestroy()
 		delete LoadDataTask;
 	}
 
+	if (Promise)
+	{
+		Promise->SetValue(nullptr);
+	}
+
 	Super::BeginDestroy();
 }
 
@@ -185,6 +293,7 @@ void USlotDataTask_Loader::StartDeserialization()
 	NewSlotInfo->LoadDate = FDateTime::Now();
 
 	GetManager()->OnLoadBegan(GetGeneralFilter());
+	bNotifiedBegan = true;
 	//Apply current Info if succeeded
 	GetManager()->__SetCurrentInfo(NewSlotInfo);
 
@@ -200,7 +309,7 @@ void USlotDataTask_Loader::StartDeserialization()
 
 void USlotDataTask_Loader::StartLoadingData()
 {
-	LoadDataTask = new FAsyncTask<FLoadFileTask>(GetManager(), SlotName.ToString());
+	LoadDataTask = new FAsyncTask<FLoadFileTask>(GetManager(), SlotName.ToString(), CancelToken);
 
 	if (Preset->IsMTFilesLoad())
 		LoadDataTask->StartBackgroundTask();
@@ -244,6 +353,10 @@ void USlotDataTask_Loader::DeserializeSync()
 
 	// Deserialize world
 	{
+		// Navigation and movement get updated once for all actors
+		FNavigationLockContext NavigationLock(GetWorld(), ENavigationLockReason::Unknown);
+		FDeferredMovementBatch Movement{ *this };
+
 		DeserializeLevelSync(World->GetCurrentLevel());
 
 		const TArray<ULevelStreaming*>& Levels = World->GetStreamingLevels();
@@ -288,10 +401,22 @@ void USlotDataTask_Loader::DeserializeASync()
 {
 	// Deserialize world
 	{
+		// The first frame is deserialized here instead of on Tick
+		FNavigationLockContext NavigationLock(GetWorld(), ENavigationLockReason::Unknown);
+		FDeferredMovementBatch Movement{ *this };
+
 		SELog(Preset, "World '" + GetWorld()->GetName() + "'", FColor::Green, false, 1);
 
 		PrepareAllLevels();
-		DeserializeLevelASync(GetWorld()->GetCurrentLevel());
+		NextSLevelIndex = 0;
+		if (Preset->bProgressiveLoading)
+		{
+			DeserializeProgressive();
+		}
+		else
+		{
+			DeserializeLevelASync(GetWorld()->GetCurrentLevel());
+		}
 	}
 }
 
@@ -376,6 +501,154 @@ void USlotDataTask_Loader::DeserializeASyncLoop(float StartMS)
 	FinishedDeserializing();
 }
 
+void USlotDataTask_Loader::DeserializeProgressive()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(USlotDataTask_Loader::DeserializeProgressive);
+	const UWorld* World = GetWorld();
+
+	bProgressive = true;
+	bRadiusComplete = false;
+
+	FVector Focus = FVector::ZeroVector;
+	const bool bHasFocus = FindFocusLocation(Focus);
+
+	ProgressiveActors.Reset();
+	auto AddLevel = [this, bHasFocus, &Focus](const ULevel* Level, const FLevelRecord* LevelRecord)
+	{
+		if (!IsValid(Level) || !LevelRecord)
+		{
+			return;
+		}
+
+		const FSELevelFilter& Filter = GetLevelFilter(*LevelRecord);
+
+		TMap<FName, const FActorRecord*> Records;
+		Records.Reserve(LevelRecord->Actors.Num());
+		for (const FActorRecord& Record : LevelRecord->Actors)
+		{
+			Records.Add(Record.Name, &Record);
+		}
+
+		for (AActor* Actor : Level->Actors)
+		{
+			if (!IsValid(Actor) || !Filter.ShouldSave(Actor))
+			{
+				continue;
+			}
+
+			FProgressiveActor& Item = ProgressiveActors.AddDefaulted_GetRef();
+			Item.Actor = Actor;
+			Item.Filter = &Filter;
+			if (const FActorRecord* const* Record = Records.Find(Actor->GetFName()))
+			{
+				Item.Record = *Record;
+			}
+
+			if (bHasFocus)
+			{
+				// Prefer the saved location, since the actor will be moved there
+				const bool bUseRecord = Item.Record && FSELevelFilter::StoresTransform(Actor);
+				const FVector Location = bUseRecord? Item.Record->Transform.GetLocation() : Actor->GetActorLocation();
+				Item.DistanceSqr = FVector::DistSquared(Focus, Location);
+			}
+		}
+	};
+
+	AddLevel(World->GetCurrentLevel(), &SlotData->MainLevel);
+	for (const ULevelStreaming* Level : World->GetStreamingLevels())
+	{
+		if (Level->IsLevelLoaded())
+		{
+			AddLevel(Level->GetLoadedLevel(), FindLevelRecord(Level));
+		}
+	}
+
+	ProgressiveActors.StableSort([](const FProgressiveActor& A, const FProgressiveActor& B) {
+		return A.DistanceSqr < B.DistanceSqr;
+	});
+
+	CurrentActorIndex = 0;
+	DeserializeProgressiveLoop();
+}
+
+void USlotDataTask_Loader::DeserializeProgressiveLoop(float StartMS)
+{
+	if (StartMS <= 0)
+	{
+		StartMS = GetTimeMilliseconds();
+	}
+
+	const float RadiusSqr = FMath::Square(Preset->ProgressiveLoadRadius);
+	while (CurrentActorIndex < ProgressiveActors.Num())
+	{
+		const FProgressiveActor& Item = ProgressiveActors[CurrentActorIndex++];
+		if (!bRadiusComplete && Item.DistanceSqr > RadiusSqr)
+		{
+			bRadiusComplete = true;
+			GetManager()->OnLoadRadiusComplete.Broadcast(NewSlotInfo);
+		}
+
+		AActor* const Actor = Item.Actor.Get();
+		const FActorRecord* Record = Item.Record;
+		if (IsValid(Actor) && Record && Record->IsValid() && Record->Class == Actor->GetClass())
+		{
+			DeserializeActor(Actor, *Record, *Item.Filter);
+
+			// If x milliseconds passed, stop and continue on next frame
+			if (GetTimeMilliseconds() - StartMS >= MaxFrameMs)
+			{
+				return;
+			}
+		}
+	}
+
+	if (!bRadiusComplete)
+	{
+		bRadiusComplete = true;
+		GetManager()->OnLoadRadiusComplete.Broadcast(NewSlotInfo);
+	}
+
+	ProgressiveActors.Empty();
+	bProgressive = false;
+	FinishedDeserializing();
+}
+
+bool USlotDataTask_Loader::FindFocusLocation(FVector& OutLocation) const
+{
+	const APlayerController* Controller = GetWorld()->GetFirstPlayerController();
+	if (!Controller)
+	{
+		return false;
+	}
+
+	if (const APawn* Pawn = Controller->GetPawn())
+	{
+		OutLocation = Pawn->GetActorLocation();
+
+		// The pawn will be moved to its saved location
+		if (FSELevelFilter::StoresTransform(Pawn))
+		{
+			const FActorRecord* Record = SlotData->MainLevel.FindActorRecord(Pawn);
+			for (int32 I = 0; !Record && I < SlotData->SubLevels.Num(); ++I)
+			{
+				Record = SlotData->SubLevels[I].FindActorRecord(Pawn);
+			}
+			if (Record)
+			{
+				OutLocation = Record->Transform.GetLocation();
+			}
+		}
+		return true;
+	}
+
+	if (Controller->PlayerCameraManager)
+	{
+		OutLocation = Controller->PlayerCameraManager->GetCameraLocation();
+		return true;
+	}
+	return false;
+}
+
 void USlotDataTask_Loader::PrepareLevel(const ULevel* Level, FLevelRecord& LevelRecord)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(USlotDataTask_Loader::PrepareLevel);
@@ -388,15 +661,41 @@ void USlotDataTask_Loader::PrepareLevel(const ULevel* Level, FLevelRecord& Level
 	// The rest									     => Just deserialize
 
 	TArray<FActorRecord*> ActorsToSpawn;
-	ActorsToSpawn.Reserve(LevelRecord.Actors.Num());
-	for(FActorRecord& Record : LevelRecord.Actors)
+	if (LevelRecord.bSortedActors)
 	{
-		ActorsToSpawn.Add(&Record);
-	}
+		// O(M*Log(N))
+		TBitArray<> FoundRecords{ false, LevelRecord.Actors.Num() };
+		for (AActor* const Actor : Level->Actors)
+		{
+			const FActorRecord* Record = LevelRecord.FindActorRecord(Actor);
+			if (Record)
+			{
+				FoundRecords[Record - LevelRecord.Actors.GetData()] = true;
+			}
+			else if (Actor && Filter.ShouldSave(Actor))
+			{
+				// If the actor wasn't found, mark it for destruction
+				Actor->Destroy();
+			}
+		}
 
-	TArray<AActor*> ActorsToDestroy{};
+		for (int32 Index = 0; Index < FoundRecords.Num(); ++Index)
+		{
+			if (!FoundRecords[Index])
+			{
+				ActorsToSpawn.Add(&LevelRecord.Actors[Index]);
+			}
+		}
+	}
+	else
 	{
-		// O(M*Log(N))
+		ActorsToSpawn.Reserve(LevelRecord.Actors.Num());
+		for(FActorRecord& Record : LevelRecord.Actors)
+		{
+			ActorsToSpawn.Add(&Record);
+		}
+
+		// O(M*N)
 		for (AActor* const Actor : Level->Actors)
 		{
 			// Remove records which actors do exist
@@ -416,6 +715,12 @@ void USlotDataTask_Loader::PrepareLevel(const ULevel* Level, FLevelRecord& Level
 
 	// Create Actors that doesn't exist now but were saved
 	RespawnActors(ActorsToSpawn, Level);
+
+	if (ActorsToSpawn.Num() > 0)
+	{
+		// Respawned actors may have been renamed
+		LevelRecord.UpdateSortedActors();
+	}
 }
 
 void USlotDataTask_Loader::FinishedDeserializing()
@@ -478,7 +783,7 @@ void USlotDataTask_Loader::DeserializeLevel_Actor(AActor* const Actor, const FLe
 	TRACE_CPUPROFILER_EVENT_SCOPE(USlotDataTask_Loader::DeserializeLevel_Actor);
 
 	// Find the record
-	const FActorRecord* const Record = LevelRecord.Actors.FindByKey(Actor);
+	const FActorRecord* const Record = LevelRecord.FindActorRecord(Actor);
 	if (Record && Record->IsValid() && Record->Class == Actor->GetClass())
 	{
 		DeserializeActor(Actor, *Record, Filter);
@@ -499,7 +804,7 @@ void USlotDataTask_Loader::DeserializeGameInstance()
 		//Serialize from Record Data
 		FMemoryReader MemoryReader(Record.Data, true);
 		FSEArchive Archive(MemoryReader, false);
-		GameInstance->Serialize(Archive);
+		Archive.SerializeObject(GameInstance);
 	}
 
 	SELog(Preset, "Game Instance '" + Record.Name.ToString() + "'", FColor::Green, !bSuccess, 1);
@@ -512,38 +817,49 @@ bool USlotDataTask_Loader::DeserializeActor(AActor* Actor, const FActorRecord& R
 	// Always load saved tags
 	Actor->Tags = Record.Tags;
 
-	const bool bSavesPhysics = FSELevelFilter::StoresPhysics(Actor);
-	if (FSELevelFilter::StoresTransform(Actor))
+	USceneComponent* const Root = Actor->GetRootComponent();
+	const bool bStoresTransform = FSELevelFilter::StoresTransform(Actor);
 	{
-		Actor->SetActorTransform(Record.Transform);
+		// Overlaps and child transforms are updated with the rest of the pass, or once for this actor if there is no pass
+		FDeferredMovementBatch LocalMovement{ *this };
+		MovementBatch->Defer(Root);
 
-		if (FSELevelFilter::StoresPhysics(Actor))
+		if (bStoresTransform)
 		{
-			USceneComponent* Root = Actor->GetRootComponent();
-			if (auto* Primitive = Cast<UPrimitiveComponent>(Root))
-			{
-				Primitive->SetPhysicsLinearVelocity(Record.LinearVelocity);
-				Primitive->SetPhysicsAngularVelocityInRadians(Record.AngularVelocity);
-			}
-			else
-			{
-				Root->ComponentVelocity = Record.LinearVelocity;
-			}
+			Actor->SetActorTransform(Record.Transform, false, nullptr, ETeleportType::TeleportPhysics);
 		}
-	}
 
-	Actor->SetActorHiddenInGame(Record.bHiddenInGame);
+		Actor->SetActorHiddenInGame(Record.bHiddenInGame);
 
-	DeserializeActorComponents(Actor, Record, Filter, 2);
+		DeserializeActorComponents(Actor, Record, Filter, 2);
 
+		if (bStoresTransform && Root && FSELevelFilter::StoresPhysics(Actor))
+		{
+			MovementBatch->SetVelocity(Root, Record.LinearVelocity, Record.AngularVelocity);
+		}
+	}
+
+	const FScopedSerializationWatch Watch{ FSerializationWatchdog::EOperation::Load, Actor, Record.Data };
+
+	// Large actors may have been saved in chunks
+	bool bLoaded = false;
+	if (FChunkedActorSerializer::IsChunked(Record.Data))
+	{
+		bLoaded = FChunkedActorSerializer::Load(Actor, Record.Data);
+	}
+	else
 	{
 		//Serialize from Record Data
 		FMemoryReader MemoryReader(Record.Data, true);
 		FSEArchive Archive(MemoryReader, false);
-		Actor->Serialize(Archive);
+		bLoaded = Archive.SerializeObject(Actor);
 	}
 
-	return true;
+	if (!bLoaded)
+	{
+		SELog(Preset, "Actor '" + Record.Name.ToString() + "' - Record is corrupted", FColor::Red, true, 1);
+	}
+	return bLoaded;
 }
 
 void USlotDataTask_Loader::DeserializeActorComponents(AActor* Actor, const FActorRecord& ActorRecord, const FSELevelFilter& Filter, int8 Indent)
@@ -568,6 +884,8 @@ void USlotDataTask_Loader::DeserializeActorComponents(AActor* Actor, const FActo
 				continue;
 			}
 
+			const FScopedSerializationWatch Watch{ FSerializationWatchdog::EOperation::Load, Component, Record->Data };
+
 			if (FSELevelFilter::StoresTransform(Component))
 			{
 				USceneComponent* Scene = CastChecked<USceneComponent>(Component);
@@ -582,43 +900,51 @@ void USlotDataTask_Loader::DeserializeActorComponents(AActor* Actor, const FActo
 				Component->ComponentTags = Record->Tags;
 			}
 
-			if (!Component->GetClass()->IsChildOf<UPrimitiveComponent>())
+			if (auto* InstancedComponent = Cast<UInstancedStaticMeshComponent>(Component))
+			{
+				// Older saves didn't store instances
+				if (Record->Data.Num() > 0)
+				{
+					FInstancesRecord InstancesRecord;
+					FMemoryReader MemoryReader(Record->Data, true);
+					MemoryReader << InstancesRecord;
+
+					if (!InstancesRecord.Apply(InstancedComponent))
+					{
+						SELog(Preset, "Component '" + Component->GetFName().ToString() + "' - Instances changed since saved", FColor::Red, false, Indent + 1);
+					}
+				}
+			}
+			else if (!Component->GetClass()->IsChildOf<UPrimitiveComponent>())
 			{
 				FMemoryReader MemoryReader(Record->Data, true);
 				FSEArchive Archive(MemoryReader, false);
-				Component->Serialize(Archive);
+				if (!Archive.SerializeObject(Component))
+				{
+					SELog(Preset, "Component '" + Component->GetFName().ToString() + "' - Record is corrupted", FColor::Red, false, Indent + 1);
+				}
 			}
 		}
 	}
 }
 
-void USlotDataTask_Loader::FindNextAsyncLevel(ULevelStreaming*& OutLevelStreaming) const
+void USlotDataTask_Loader::FindNextAsyncLevel(ULevelStreaming*& OutLevelStreaming)
 {
 	OutLevelStreaming = nullptr;
+	if (!CurrentLevel.IsValid())
+	{
+		return;
+	}
 
-	const UWorld* World = GetWorld();
-	const TArray<ULevelStreaming*>& Levels = World->GetStreamingLevels();
-	if (CurrentLevel.IsValid() && Levels.Num() > 0)
+	// Continue from the last deserialized level, skipping unloaded ones
+	const TArray<ULevelStreaming*>& Levels = GetWorld()->GetStreamingLevels();
+	while (NextSLevelIndex < Levels.Num())
 	{
-		if (!CurrentSLevel.IsValid())
+		ULevelStreaming* Level = Levels[NextSLevelIndex++];
+		if (Level && Level->IsLevelLoaded())
 		{
-			//Current is persistent, get first streaming level
-			OutLevelStreaming = Levels[0];
+			OutLevelStreaming = Level;
 			return;
 		}
-		else
-		{
-			int32 CurrentIndex = Levels.IndexOfByKey(CurrentSLevel);
-			if (CurrentIndex != INDEX_NONE && Levels.Num() > CurrentIndex + 1)
-			{
-				OutLevelStreaming = Levels[CurrentIndex + 1];
-			}
-		}
-	}
-
-	// If this level is unloaded, find next
-	if (OutLevelStreaming && !OutLevelStreaming->IsLevelLoaded())
-	{
-		FindNextAsyncLevel(OutLevelStreaming);
 	}
 }
@@ -2,6 +2,7 @@
 
 #include "Serialization/SlotDataTask_Saver.h"
 
+#include <Async/ParallelFor.h>
 #include <GameFramework/GameModeBase.h>
 #include <Serialization/MemoryWriter.h>
 
@@ -24,23 +25,12 @@ void USlotDataTask_Saver::OnStart()
 
 	bool bSave = true;
 	const FString SlotNameStr = SlotName.ToString();
-	//Overriding
+	// Overriding saves replace the previous file only once the new one is fully written
+	if (!bOverride)
 	{
-		const bool bFileExists = FFileAdapter::DoesFileExist(SlotNameStr);
-		if (bOverride)
-		{
-			// Delete previous save
-			if (bFileExists)
-			{
-				FFileAdapter::DeleteFile(SlotNameStr);
-			}
-		}
-		else
-		{
-			//Only save if previous files don't exist
-			//We don't want to serialize since it won't be saved anyway
-			bSave = !bFileExists;
-		}
+		//Only save if previous files don't exist
+		//We don't want to serialize since it won't be saved anyway
+		bSave = !FFileAdapter::DoesFileExist(*Manager->GetStorage(), SlotNameStr);
 	}
 
 	if (bSave)
@@ -48,6 +38,7 @@ void USlotDataTask_Saver::OnStart()
 		const UWorld* World = GetWorld();
 
 		GetManager()->OnSaveBegan(GetGeneralFilter());
+		bNotifiedBegan = true;
 
 		SlotInfo = Manager->GetCurrentInfo();
 		SlotData = Manager->GetCurrentData();
@@ -113,7 +104,8 @@ void USlotDataTask_Saver::Tick(float DeltaTime)
 
 	if (SaveTask && SaveTask->IsDone())
 	{
-		if (bSaveThumbnail)
+		const bool bWritten = SaveTask->GetTask().IsSucceeded();
+		if (bSaveThumbnail && bWritten)
 		{
 			if (SlotInfo && SlotInfo->GetThumbnail())
 			{
@@ -122,7 +114,7 @@ void USlotDataTask_Saver::Tick(float DeltaTime)
 		}
 		else
 		{
-			Finish(true);
+			Finish(bWritten);
 		}
 	}
 }
@@ -141,11 +133,24 @@ void USlotDataTask_Saver::OnFinish(bool bSuccess)
 	// Execute delegates
 	USaveManager* Manager = GetManager();
 	check(Manager);
-	Delegate.ExecuteIfBound((Manager && bSuccess)? Manager->GetCurrentInfo() : nullptr);
-	Manager->OnSaveFinished(
-		SlotData? GetGeneralFilter() : FSELevelFilter{},
-		!bSuccess
-	);
+	USlotInfo* SavedInfo = (Manager && bSuccess)? Manager->GetCurrentInfo() : nullptr;
+	if (Promise)
+	{
+		// Already resolved if the file was written on a worker
+		Promise->SetValue(SavedInfo);
+	}
+	Delegate.ExecuteIfBound(SavedInfo);
+	if (bNotifiedBegan)
+	{
+		Manager->OnSaveFinished(GetGeneralFilter(), !bSuccess);
+	}
+}
+
+bool USlotDataTask_Saver::IsSupersededBy(const USlotDataTask& Other) const
+{
+	const UClass* SaverClass = USlotDataTask_Saver::StaticClass();
+	return GetClass() == SaverClass && Other.GetClass() == SaverClass &&
+		   static_cast<const USlotDataTask_Saver&>(Other).GetSlotName() == SlotName;
 }
 
 void USlotDataTask_Saver::BeginDestroy()
@@ -156,6 +161,12 @@ void USlotDataTask_Saver::BeginDestroy()
 		delete SaveTask;
 	}
 
+	// Never leave a future waiting on a task that won't finish
+	if (Promise)
+	{
+		Promise->SetValue(nullptr);
+	}
+
 	Super::BeginDestroy();
 }
 
@@ -201,7 +212,7 @@ void USlotDataTask_Saver::PrepareAllLevels(const TArray<ULevelStreaming*>& Level
 	{
 		if (Level->IsLevelLoaded())
 		{
-			SlotData->SubLevels.AddUnique({ *Level });
+			SlotData->FindOrAddSubLevel(*Level);
 		}
 	}
 }
@@ -230,10 +241,13 @@ void USlotDataTask_Saver::SerializeLevelSync(const ULevel* Level, int32 Assigned
 	// Empty level record before serializing it
 	LevelRecord->CleanRecords();
 
-	auto& Filter = GetLevelFilter(*LevelRecord);
+	ScheduleActorTasks(&Level->Actors, LevelRecord, GetLevelFilter(*LevelRecord), AssignedTasks);
+}
 
+void USlotDataTask_Saver::ScheduleActorTasks(const TArray<AActor*>* Actors, FLevelRecord* LevelRecord, const FSELevelFilter& Filter, int32 AssignedTasks)
+{
 	const int32 MinObjectsPerTask = 40;
-	const int32 ActorCount = Level->Actors.Num();
+	const int32 ActorCount = Actors->Num();
 	const int32 NumBalancedPerTask = FMath::CeilToInt((float) ActorCount / AssignedTasks);
 	const int32 NumPerTask = FMath::Max(NumBalancedPerTask, MinObjectsPerTask);
 
@@ -249,8 +263,9 @@ void USlotDataTask_Saver::SerializeLevelSync(const ULevel* Level, int32 Assigned
 		// Add new Task
 		Tasks.Emplace(FMTTask_SerializeActors
 		{
-			GetWorld(), SlotData, &Level->Actors, Index, NumToSerialize,
-			bStoreGameInstance, LevelRecord, Filter
+			GetWorld(), SlotData, Actors, Index, NumToSerialize,
+			bStoreGameInstance, LevelRecord, Filter, &PhysicsSnapshot,
+			Preset->LargeActorKB * 1024, GetManager()->GetLargeActorSizes()
 		});
 
 		Index += NumToSerialize;
@@ -260,6 +275,14 @@ void USlotDataTask_Saver::SerializeLevelSync(const ULevel* Level, int32 Assigned
 void USlotDataTask_Saver::RunScheduledTasks()
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(USlotDataTask_Saver::RunScheduledTasks);
+	// Read physics of all scheduled actors at once, before any task starts
+	PhysicsSnapshot.Reset();
+	for (auto& AsyncTask : Tasks)
+	{
+		AsyncTask.GetTask().GatherPhysics(PhysicsSnapshot);
+	}
+	PhysicsSnapshot.Capture(GetWorld());
+
 	// Start all serialization tasks
 	if (Tasks.Num() > 0)
 	{
@@ -279,11 +302,20 @@ void USlotDataTask_Saver::RunScheduledTasks()
 		AsyncTask.EnsureCompletion();
 	}
 	// All tasks finished, sync data
+	TArray<FLevelRecord*, TInlineAllocator<8>> LevelRecords;
 	for (auto& AsyncTask : Tasks)
 	{
 		AsyncTask.GetTask().DumpData();
+		LevelRecords.AddUnique(AsyncTask.GetTask().GetLevelRecord());
 	}
 	Tasks.Empty();
+
+	// Records are appended in the order tasks were split. Sorting them makes saves of the same world identical
+	ParallelFor(LevelRecords.Num(), [&LevelRecords](int32 Index)
+	{
+		LevelRecords[Index]->SortActors();
+	});
+	PhysicsSnapshot.Reset();
 }
 
 void USlotDataTask_Saver::SaveFile()
@@ -291,9 +323,17 @@ void USlotDataTask_Saver::SaveFile()
 	TRACE_CPUPROFILER_EVENT_SCOPE(USlotDataTask_Saver::SaveFile);
 	USaveManager* Manager = GetManager();
 
-	SaveTask = new FAsyncTask<FSaveFileTask>(
+	SaveTask = new FAsyncTask<FSaveFileTask>(Manager->GetStorage(),
 		Manager->GetCurrentInfo(), Manager->GetCurrentData(),
-		SlotName.ToString(), Preset->bUseCompression);
+		SlotName.ToString(), Manager->GetFileSettings(), Manager->GetSlotCache());
+
+	if (Promise && !bSaveThumbnail)
+	{
+		// Continuations run right after the write instead of waiting for this task to tick
+		SaveTask->GetTask().OnWritten = [Promise = Promise, Info = Manager->GetCurrentInfo()](bool bSuccess) {
+			Promise->SetValue(bSuccess? Info : nullptr);
+		};
+	}
 
 	if (Preset->IsMTFilesSave())
 	{
@@ -303,9 +343,9 @@ void USlotDataTask_Saver::SaveFile()
 	{
 		SaveTask->StartSynchronousTask();
 
-		if (!bSaveThumbnail)
+		if (!bSaveThumbnail || !SaveTask->GetTask().IsSucceeded())
 		{
-			Finish(true);
+			Finish(SaveTask->GetTask().IsSucceeded());
 		}
 	}
 }
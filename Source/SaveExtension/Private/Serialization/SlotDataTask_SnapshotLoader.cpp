@@ -0,0 +1,67 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Serialization/SlotDataTask_SnapshotLoader.h"
+
+#include "Misc/SlotHelpers.h"
+#include "SaveManager.h"
+
+
+/////////////////////////////////////////////////////
+// USlotDataTask_SnapshotLoader
+
+void USlotDataTask_SnapshotLoader::OnStart()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(USlotDataTask_SnapshotLoader::OnStart);
+
+	// Snapshots can only be restored in the map they were taken
+	const FName CurrentMapName{ FSlotHelpers::GetWorldName(GetWorld()) };
+	if (!SnapshotData || SnapshotData->Map != CurrentMapName)
+	{
+		SELog(Preset, "Snapshot was taken in another map. Can't restore it.", FColor::White, true, 1);
+		Finish(false);
+		return;
+	}
+
+	USaveManager* Manager = GetManager();
+	Manager->TryInstantiateInfo();
+	NewSlotInfo = Manager->GetCurrentInfo();
+	SessionLoadDate = NewSlotInfo->LoadDate;
+
+	StartDeserialization();
+}
+
+void USlotDataTask_SnapshotLoader::FinishedDeserializing()
+{
+	USlotData* CurrentData = GetManager()->GetCurrentData();
+	if (!CurrentData || CurrentData == SlotData)
+	{
+		Super::FinishedDeserializing();
+		return;
+	}
+
+	// Snapshots only hold loaded levels. Records of unloaded sub-levels stay in the current data
+	SlotData->CleanRecords(true);
+	for (FStreamingLevelRecord& Record : SlotData->SubLevels)
+	{
+		if (FStreamingLevelRecord* CurrentRecord = CurrentData->FindSubLevel(Record.Name))
+		{
+			*CurrentRecord = MoveTemp(Record);
+		}
+		else
+		{
+			CurrentData->SubLevels.Add(MoveTemp(Record));
+		}
+	}
+	CurrentData->TimeSeconds = SlotData->TimeSeconds;
+
+	Finish(true);
+}
+
+void USlotDataTask_SnapshotLoader::OnFinish(bool bSuccess)
+{
+	if (NewSlotInfo)
+	{
+		NewSlotInfo->LoadDate = SessionLoadDate;
+	}
+	Super::OnFinish(bSuccess);
+}
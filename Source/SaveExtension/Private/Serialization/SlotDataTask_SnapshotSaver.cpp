@@ -0,0 +1,49 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Serialization/SlotDataTask_SnapshotSaver.h"
+
+#include "Misc/SlotHelpers.h"
+#include "SaveManager.h"
+
+
+/////////////////////////////////////////////////////
+// USlotDataTask_SnapshotSaver
+
+void USlotDataTask_SnapshotSaver::OnStart()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(USlotDataTask_SnapshotSaver::OnStart);
+	USaveManager* Manager = GetManager();
+	Manager->TryInstantiateInfo();
+
+	// Must have Authority. An empty snapshot would clear the world when restored
+	const UWorld* World = GetWorld();
+	if (!World->GetAuthGameMode())
+	{
+		Finish(false);
+		return;
+	}
+
+	// The loaded slot is not modified by snapshots
+	const USlotData* CurrentData = Manager->GetCurrentData();
+	check(CurrentData);
+	SlotData = NewObject<USlotData>(this, CurrentData->GetClass());
+
+	SlotData->Map = FName{ FSlotHelpers::GetWorldName(World) };
+	SlotData->TimeSeconds = World->TimeSeconds;
+	SlotData->bStoreGameInstance = Preset->bStoreGameInstance;
+	SlotData->GeneralLevelFilter = Preset->ToFilter();
+
+	SerializeWorld();
+
+	Manager->GetSnapshots().Push(SlotData, SlotData->TimeSeconds, SlotData->Map);
+	Finish(true);
+}
+
+void USlotDataTask_SnapshotSaver::OnFinish(bool bSuccess)
+{
+	// Clean serialization data
+	if (SlotData)
+	{
+		SlotData->CleanRecords(true);
+	}
+}
@@ -0,0 +1,206 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Serialization/SlotDataTask_SubsetLoader.h"
+
+#include <NavigationSystemTypes.h>
+#include <UObject/UObjectHash.h>
+
+#include "FileAdapter.h"
+#include "Misc/SaveShards.h"
+#include "Misc/SlotHelpers.h"
+#include "SaveManager.h"
+
+
+/////////////////////////////////////////////////////
+// USlotDataTask_SubsetLoader
+
+void USlotDataTask_SubsetLoader::OnStart()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(USlotDataTask_SubsetLoader::OnStart);
+
+	SELog(Preset, "Loading actors from Sub-Slot " + SubSlotName.ToString());
+
+	// Don't read a file while it is written
+	if (GetManager()->IsWritingSubSlot(SubSlotName))
+	{
+		bWaitingForWrite = true;
+		return;
+	}
+	LoadFile();
+}
+
+void USlotDataTask_SubsetLoader::LoadFile()
+{
+	const FString SubSlotPath = FFileAdapter::GetSubSlotName(SubSlotName);
+	if (!FFileAdapter::DoesFileExist(*GetManager()->GetStorage(), SubSlotPath))
+	{
+		SELog(Preset, "Sub-Slot not found! Can't load.", FColor::White, true, 1);
+		Finish(false);
+		return;
+	}
+
+	LoadDataTask = new FAsyncTask<FLoadFileTask>(GetManager(), SubSlotPath, CancelToken);
+	if (Preset->IsMTFilesLoad())
+	{
+		LoadDataTask->StartBackgroundTask();
+		LoadState = ELoadDataTaskState::WaitingForData;
+	}
+	else
+	{
+		LoadDataTask->StartSynchronousTask();
+		DeserializeSubset();
+	}
+}
+
+void USlotDataTask_SubsetLoader::Tick(float DeltaTime)
+{
+	if (bWaitingForWrite)
+	{
+		if (!GetManager()->IsWritingSubSlot(SubSlotName))
+		{
+			bWaitingForWrite = false;
+			LoadFile();
+		}
+		return;
+	}
+
+	if (LoadState == ELoadDataTaskState::WaitingForData && IsDataLoaded())
+	{
+		DeserializeSubset();
+	}
+}
+
+void USlotDataTask_SubsetLoader::OnFinish(bool bSuccess)
+{
+	if (bSuccess)
+	{
+		SELog(Preset, "Finished Loading Sub-Slot", FColor::Green);
+	}
+
+	for (const auto& Level : NotifiedLevels)
+	{
+		if (Level.IsValid())
+		{
+			GetManager()->OnLoadFinished(GetGeneralFilter(), !bSuccess, Level.Get());
+		}
+	}
+	NotifiedLevels.Empty();
+
+	USlotInfo* Info = (bSuccess && LoadDataTask)? LoadDataTask->GetTask().GetInfo() : nullptr;
+	OnLoaded.ExecuteIfBound(Info);
+
+	// Sub-slot data is only referenced by this task. The info is given to the caller
+	if (LoadState == ELoadDataTaskState::Deserializing && SlotData && SlotData != GetManager()->GetCurrentData())
+	{
+		GetManager()->GetObjectPool()->Release(SlotData);
+		SlotData = nullptr;
+	}
+}
+
+void USlotDataTask_SubsetLoader::DeserializeSubset()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(USlotDataTask_SubsetLoader::DeserializeSubset);
+	LoadState = ELoadDataTaskState::Deserializing;
+
+	SlotData = GetLoadedData();
+	const UWorld* World = GetWorld();
+	if (!SlotData || SlotData->Map != FName{ FSlotHelpers::GetWorldName(World) })
+	{
+		SELog(Preset, "Sub-Slot was saved in another map. Can't load it.", FColor::White, true, 1);
+		Finish(false);
+		return;
+	}
+
+	BakeAllFilters();
+
+	if (!OwnerId.IsEmpty())
+	{
+		TMap<FString, TArray<AActor*>> ActorsByOwner;
+		FSaveShards::GatherActors(World, GetGeneralFilter(), ActorsByOwner);
+		OwnedActors = ActorsByOwner.FindRef(OwnerId);
+	}
+
+	{
+		// Navigation and movement get updated once for all actors
+		FNavigationLockContext NavigationLock(GetWorld(), ENavigationLockReason::Unknown);
+		FDeferredMovementBatch Movement{ *this };
+
+		DeserializeSubsetLevel(World->PersistentLevel, SlotData->MainLevel);
+		for (const ULevelStreaming* Level : World->GetStreamingLevels())
+		{
+			if (Level && Level->IsLevelLoaded())
+			{
+				if (FLevelRecord* LevelRecord = FindLevelRecord(Level))
+				{
+					DeserializeSubsetLevel(Level->GetLoadedLevel(), *LevelRecord);
+				}
+			}
+		}
+	}
+
+	OwnedActors.Empty();
+	SlotData->CleanRecords(true);
+	Finish(true);
+}
+
+void USlotDataTask_SubsetLoader::DeserializeSubsetLevel(const ULevel* Level, FLevelRecord& LevelRecord)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(USlotDataTask_SubsetLoader::DeserializeSubsetLevel);
+	if (!IsValid(Level) || LevelRecord.Actors.Num() <= 0)
+	{
+		return;
+	}
+
+	const auto& Filter = GetLevelFilter(LevelRecord);
+
+	NotifiedLevels.Add(Level);
+	GetManager()->OnLoadBegan(Filter, Level);
+
+	// Actors are found by name or among the owned ones, the level is never iterated
+	int32 NumUnmatched = 0;
+	for (const FActorRecord& Record : LevelRecord.Actors)
+	{
+		AActor* Actor = OwnerId.IsEmpty()
+			? FindObjectFast<AActor>(const_cast<ULevel*>(Level), Record.Name)
+			: TakeOwnedActor(Level, Record);
+		if (IsValid(Actor) && Record.Class == Actor->GetClass())
+		{
+			DeserializeActor(Actor, Record, Filter);
+		}
+		else
+		{
+			UE_LOG(LogSaveExtension, Verbose, TEXT("Sub-Slot actor '%s' not found in level '%s'"), *Record.Name.ToString(), *Level->GetOuter()->GetName());
+			++NumUnmatched;
+		}
+	}
+
+	if (NumUnmatched > 0)
+	{
+		UE_LOG(LogSaveExtension, Warning, TEXT("Sub-Slot '%s': %d saved actors were not found in level '%s' and were skipped"),
+			*SubSlotName.ToString(), NumUnmatched, *Level->GetOuter()->GetName());
+	}
+}
+
+AActor* USlotDataTask_SubsetLoader::TakeOwnedActor(const ULevel* Level, const FActorRecord& Record)
+{
+	auto IsCandidate = [Level, &Record](const AActor* Actor) {
+		return Actor->GetLevel() == Level && Actor->GetClass() == Record.Class;
+	};
+
+	int32 Index = OwnedActors.IndexOfByPredicate([&IsCandidate, &Record](const AActor* Actor) {
+		return IsCandidate(Actor) && Actor->GetFName() == Record.Name;
+	});
+	if (Index == INDEX_NONE)
+	{
+		Index = OwnedActors.IndexOfByPredicate(IsCandidate);
+	}
+
+	if (Index == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	AActor* Actor = OwnedActors[Index];
+	OwnedActors.RemoveAtSwap(Index);
+	return Actor;
+}
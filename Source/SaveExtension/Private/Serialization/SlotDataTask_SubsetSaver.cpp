@@ -0,0 +1,141 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Serialization/SlotDataTask_SubsetSaver.h"
+
+#include "FileAdapter.h"
+#include "Misc/SlotHelpers.h"
+#include "SaveManager.h"
+
+
+/////////////////////////////////////////////////////
+// USlotDataTask_SubsetSaver
+
+void USlotDataTask_SubsetSaver::OnStart()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(USlotDataTask_SubsetSaver::OnStart);
+	USaveManager* Manager = GetManager();
+	const UWorld* World = GetWorld();
+
+	SELog(Preset, "Saving actors to Sub-Slot " + SubSlotName.ToString());
+
+	// Subsets use their own objects so that the current slot is not modified
+	UClass* InfoClass = Preset->SlotInfoClass.Get();
+	UClass* DataClass = Preset->SlotDataClass.Get();
+	SlotInfo = NewObject<USlotInfo>(this, InfoClass? InfoClass : USlotInfo::StaticClass());
+	SlotData = Manager->GetObjectPool()->Acquire<USlotData>(DataClass, GetTransientPackage());
+
+	SlotInfo->FileName = SubSlotName;
+	SlotInfo->SaveDate = FDateTime::Now();
+	SlotInfo->Map = FName{ FSlotHelpers::GetWorldName(World) };
+	SlotData->Map = SlotInfo->Map;
+	SlotData->TimeSeconds = World->TimeSeconds;
+
+	// Only classes of the provided actors are allowed
+	FSELevelFilter Filter = Preset->ToFilter();
+	Filter.ActorFilter = {};
+
+	TMap<const ULevel*, int32> LevelIndices;
+	for (const auto& ActorPtr : Actors)
+	{
+		AActor* Actor = ActorPtr.Get();
+		if (!IsValid(Actor))
+		{
+			continue;
+		}
+
+		Filter.ActorFilter.ClassFilter.AllowedClasses.Add(Actor->GetClass());
+
+		int32& Index = LevelIndices.FindOrAdd(Actor->GetLevel(), INDEX_NONE);
+		if (Index == INDEX_NONE)
+		{
+			Index = LevelActors.AddDefaulted();
+		}
+		LevelActors[Index].Add(Actor);
+	}
+	Filter.LoadActorFilter = Filter.ActorFilter;
+	SlotData->GeneralLevelFilter = MoveTemp(Filter);
+	BakeAllFilters();
+
+	// Records are created before scheduling since tasks keep pointers to them
+	TArray<FLevelRecord*> LevelRecords;
+	LevelRecords.Init(nullptr, LevelActors.Num());
+	SlotData->SubLevels.Reserve(LevelIndices.Num());
+	for (const auto& LevelIndex : LevelIndices)
+	{
+		if (LevelIndex.Key == World->PersistentLevel)
+		{
+			LevelRecords[LevelIndex.Value] = &SlotData->MainLevel;
+			continue;
+		}
+
+		for (const ULevelStreaming* Level : World->GetStreamingLevels())
+		{
+			if (Level && Level->GetLoadedLevel() == LevelIndex.Key)
+			{
+				LevelRecords[LevelIndex.Value] = &SlotData->FindOrAddSubLevel(*Level);
+				break;
+			}
+		}
+	}
+
+	const int32 NumberOfThreads = FMath::Max(1, FPlatformMisc::NumberOfWorkerThreadsToSpawn() + 1);
+	const int32 TasksPerLevel = Preset->IsMTSerializationSave()
+		? FMath::Max(1, FMath::RoundToInt(float(NumberOfThreads) / LevelActors.Num()))
+		: 1;
+	for (int32 I = 0; I < LevelActors.Num(); ++I)
+	{
+		if (LevelRecords[I])
+		{
+			ScheduleActorTasks(&LevelActors[I], LevelRecords[I], GetGeneralFilter(), TasksPerLevel);
+		}
+	}
+	// Only subscribers in the levels of the subset are notified
+	for (const auto& LevelIndex : LevelIndices)
+	{
+		if (LevelRecords[LevelIndex.Value])
+		{
+			NotifiedLevels.Add(LevelIndex.Key);
+			Manager->OnSaveBegan(GetGeneralFilter(), LevelIndex.Key);
+		}
+	}
+
+	RunScheduledTasks();
+	LevelActors.Empty();
+
+	if (Preset->IsMTFilesSave())
+	{
+		// Other tasks can run while the file is written, even if the sub-slot is still being written
+		bWriteHandedOff = true;
+		Manager->WriteSubSlotFile(SlotInfo, SlotData, SubSlotName, OnSaved);
+		Finish(true);
+		return;
+	}
+
+	SaveTask = new FAsyncTask<FSaveFileTask>(Manager->GetStorage(), SlotInfo, SlotData,
+		FFileAdapter::GetSubSlotName(SubSlotName), Manager->GetFileSettings(), Manager->GetSlotCache());
+	SaveTask->StartSynchronousTask();
+	Finish(SaveTask->GetTask().IsSucceeded());
+}
+
+void USlotDataTask_SubsetSaver::OnFinish(bool bSuccess)
+{
+	if (bSuccess)
+	{
+		SELog(Preset, "Finished Saving Sub-Slot", FColor::Green);
+	}
+
+	for (const auto& Level : NotifiedLevels)
+	{
+		if (Level.IsValid())
+		{
+			GetManager()->OnSaveFinished(GetGeneralFilter(), !bSuccess, Level.Get());
+		}
+	}
+	NotifiedLevels.Empty();
+
+	if (!bWriteHandedOff)
+	{
+		OnSaved.ExecuteIfBound(bSuccess? SlotInfo : nullptr);
+		GetManager()->GetObjectPool()->Release(SlotData);
+	}
+}
@@ -0,0 +1,322 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Serialization/SnapshotBuffer.h"
+
+#include <Serialization/MemoryReader.h>
+#include <Serialization/MemoryWriter.h>
+
+#include "FileAdapter.h"
+#include "ISaveExtension.h"
+#include "SlotData.h"
+
+
+/////////////////////////////////////////////////////
+// FSnapshotBuffer
+
+void FSnapshotBuffer::SetCapacity(int32 Capacity)
+{
+	Capacity = FMath::Max(0, Capacity);
+	if (Capacity == Snapshots.Num())
+	{
+		return;
+	}
+
+	while (Count > Capacity)
+	{
+		PopOldest();
+	}
+
+	// Move snapshots to the start of the new storage
+	TArray<FWorldSnapshot> Ordered;
+	Ordered.Reserve(Capacity);
+	for (int32 I = 0; I < Count; ++I)
+	{
+		Ordered.Add(MoveTemp(GetMutable(I)));
+	}
+	Ordered.SetNum(Capacity);
+	Snapshots = MoveTemp(Ordered);
+	First = 0;
+}
+
+void FSnapshotBuffer::Push(USlotData* Data, float TimeSeconds, FName Map)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FSnapshotBuffer::Push);
+	if (Snapshots.Num() <= 0 || !Data)
+	{
+		return;
+	}
+
+	FSaveFile File{};
+	File.SerializeData(Data);
+	if (DataClassName != File.DataClassName)
+	{
+		// Snapshots of different classes can't be delta-encoded together
+		Empty();
+		DataClassName = File.DataClassName;
+	}
+
+	if (Count == Snapshots.Num())
+	{
+		PopOldest();
+	}
+
+	FWorldSnapshot Snapshot;
+	Snapshot.TimeSeconds = TimeSeconds;
+	Snapshot.Map = Map;
+	Snapshot.RawSize = File.DataBytes.Num();
+
+	if (Count > 0 && SinceKeyframe < KeyframeInterval - 1)
+	{
+		EncodeDelta(LastRawBytes, File.DataBytes, Snapshot.Bytes);
+		// Deltas bigger than half the snapshot are not worth decoding
+		Snapshot.bKeyframe = Snapshot.Bytes.Num() > Snapshot.RawSize / 2;
+	}
+
+	if (Snapshot.bKeyframe)
+	{
+		Snapshot.Bytes = File.DataBytes;
+		SinceKeyframe = 0;
+	}
+	else
+	{
+		++SinceKeyframe;
+	}
+	LastRawBytes = MoveTemp(File.DataBytes);
+
+	GetMutable(Count) = MoveTemp(Snapshot);
+	++Count;
+}
+
+USlotData* FSnapshotBuffer::CreateData(int32 Index, UObject* Outer, FSlotObjectPool* Pool) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FSnapshotBuffer::CreateData);
+	TArray<uint8> Bytes;
+	if (!Decode(Index, Bytes))
+	{
+		return nullptr;
+	}
+
+	UObject* Object = nullptr;
+	FFileAdapter::DeserializeObject(Object, DataClassName, Outer, Bytes, Pool);
+	return Cast<USlotData>(Object);
+}
+
+bool FSnapshotBuffer::Decode(int32 Index, TArray<uint8>& OutBytes) const
+{
+	if (Index < 0 || Index >= Count)
+	{
+		return false;
+	}
+
+	if (Index == Count - 1)
+	{
+		OutBytes = LastRawBytes;
+		return true;
+	}
+
+	// Oldest snapshot is always a keyframe
+	int32 Keyframe = Index;
+	while (!Get(Keyframe).bKeyframe)
+	{
+		--Keyframe;
+	}
+
+	OutBytes = Get(Keyframe).Bytes;
+	for (int32 I = Keyframe + 1; I <= Index; ++I)
+	{
+		TArray<uint8> Next;
+		if (!ApplyDelta(OutBytes, Get(I), Next))
+		{
+			OutBytes.Empty();
+			return false;
+		}
+		OutBytes = MoveTemp(Next);
+	}
+	return true;
+}
+
+void FSnapshotBuffer::DiscardNewerThan(int32 Index)
+{
+	if (Index < 0)
+	{
+		Empty();
+		return;
+	}
+	if (Index >= Count - 1)
+	{
+		return;
+	}
+
+	int32 Keyframe = Index;
+	while (!Get(Keyframe).bKeyframe)
+	{
+		--Keyframe;
+	}
+
+	TArray<uint8> Bytes;
+	if (!Decode(Index, Bytes))
+	{
+		// Deltas of a broken chain can't be restored or encoded against. Drop the whole chain
+		UE_LOG(LogSaveExtension, Warning, TEXT("Snapshot %i could not be decoded. Discarding snapshots from %i."), Index, Keyframe);
+		DiscardNewerThan(Keyframe - 1);
+		return;
+	}
+
+	for (int32 I = Index + 1; I < Count; ++I)
+	{
+		GetMutable(I) = {};
+	}
+	Count = Index + 1;
+	LastRawBytes = MoveTemp(Bytes);
+	SinceKeyframe = Index - Keyframe;
+}
+
+int32 FSnapshotBuffer::FindClosest(float TimeSeconds) const
+{
+	int32 Closest = INDEX_NONE;
+	float ClosestDistance = TNumericLimits<float>::Max();
+	for (int32 I = 0; I < Count; ++I)
+	{
+		const float Distance = FMath::Abs(Get(I).TimeSeconds - TimeSeconds);
+		if (Distance < ClosestDistance)
+		{
+			Closest = I;
+			ClosestDistance = Distance;
+		}
+	}
+	return Closest;
+}
+
+void FSnapshotBuffer::Empty()
+{
+	for (auto& Snapshot : Snapshots)
+	{
+		Snapshot = {};
+	}
+	First = 0;
+	Count = 0;
+	DataClassName.Empty();
+	LastRawBytes.Empty();
+	SinceKeyframe = 0;
+}
+
+void FSnapshotBuffer::PopOldest()
+{
+	check(Count > 0);
+
+	// The next snapshot becomes the oldest, so it must be a keyframe
+	int32 Dropped = 1;
+	if (Count > 1)
+	{
+		FWorldSnapshot& Next = GetMutable(1);
+		TArray<uint8> Bytes;
+		if (!Next.bKeyframe && ApplyDelta(GetMutable(0).Bytes, Next, Bytes))
+		{
+			Next.Bytes = MoveTemp(Bytes);
+			Next.bKeyframe = true;
+		}
+		else if (!Next.bKeyframe)
+		{
+			// Following deltas can't be decoded either. Drop them until the next keyframe
+			while (Dropped < Count && !Get(Dropped).bKeyframe)
+			{
+				++Dropped;
+			}
+			UE_LOG(LogSaveExtension, Warning, TEXT("Snapshot could not be decoded. Discarded %i snapshots."), Dropped);
+		}
+	}
+
+	for (int32 I = 0; I < Dropped; ++I)
+	{
+		GetMutable(I) = {};
+	}
+	First = (First + Dropped) % Snapshots.Num();
+	Count -= Dropped;
+
+	if (Count <= 0)
+	{
+		First = 0;
+		LastRawBytes.Empty();
+		SinceKeyframe = 0;
+	}
+}
+
+void FSnapshotBuffer::EncodeDelta(const TArray<uint8>& Base, const TArray<uint8>& Target, TArray<uint8>& OutDelta)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FSnapshotBuffer::EncodeDelta);
+
+	// Equal runs shorter than this are cheaper to copy than to skip
+	static constexpr int32 MinSkipRun = 8;
+
+	// Delta is a list of (Skip, Copy) pairs. Skipped bytes are taken from Base, copied bytes follow each pair
+	FMemoryWriter Ar(OutDelta);
+	const int32 Num = Target.Num();
+	const int32 Common = FMath::Min(Base.Num(), Num);
+	int32 I = 0;
+	while (I < Num)
+	{
+		const int32 SkipStart = I;
+		while (I < Common && Base[I] == Target[I])
+		{
+			++I;
+		}
+
+		const int32 CopyStart = I;
+		while (I < Num)
+		{
+			if (I < Common && Base[I] == Target[I])
+			{
+				int32 Run = 1;
+				while (Run < MinSkipRun && I + Run < Common && Base[I + Run] == Target[I + Run])
+				{
+					++Run;
+				}
+				if (Run >= MinSkipRun || I + Run >= Num)
+				{
+					break;
+				}
+				I += Run;
+			}
+			else
+			{
+				++I;
+			}
+		}
+
+		uint32 Skip = CopyStart - SkipStart;
+		uint32 Copy = I - CopyStart;
+		Ar.SerializeIntPacked(Skip);
+		Ar.SerializeIntPacked(Copy);
+		if (Copy > 0)
+		{
+			Ar.Serialize(const_cast<uint8*>(Target.GetData() + CopyStart), Copy);
+		}
+	}
+}
+
+bool FSnapshotBuffer::ApplyDelta(const TArray<uint8>& Base, const FWorldSnapshot& Delta, TArray<uint8>& OutBytes)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FSnapshotBuffer::ApplyDelta);
+
+	OutBytes.SetNumUninitialized(Delta.RawSize);
+
+	FMemoryReader Ar(Delta.Bytes);
+	int64 Position = 0;
+	while (Position < Delta.RawSize && !Ar.AtEnd())
+	{
+		uint32 Skip = 0;
+		uint32 Copy = 0;
+		Ar.SerializeIntPacked(Skip);
+		Ar.SerializeIntPacked(Copy);
+		if (Ar.IsError() || Position + Skip > Base.Num() || Position + Skip + Copy > Delta.RawSize)
+		{
+			return false;
+		}
+
+		FMemory::Memcpy(OutBytes.GetData() + Position, Base.GetData() + Position, Skip);
+		Position += Skip;
+		Ar.Serialize(OutBytes.GetData() + Position, Copy);
+		Position += Copy;
+	}
+	return Position == Delta.RawSize && !Ar.IsError();
+}
@@ -0,0 +1,148 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "SlotCache.h"
+
+#include <Misc/ScopeLock.h>
+
+#include "Storage/SaveStorageBackend.h"
+
+
+/////////////////////////////////////////////////////
+// FSlotCache
+
+void FSlotCache::SetLimits(int32 InMaxEntries, int64 InMaxBytes)
+{
+	FScopeLock ScopeLock(&Lock);
+	MaxEntries = FMath::Max(0, InMaxEntries);
+	MaxBytes = FMath::Max<int64>(0, InMaxBytes);
+	Trim();
+}
+
+bool FSlotCache::IsEnabled() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return MaxEntries > 0 && MaxBytes > 0;
+}
+
+FSharedSaveFile FSlotCache::Store(FStringView SlotName, uint32 Revision, FSaveFile&& File)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FSlotCache::Store);
+
+	const int64 Bytes = File.InfoBytes.Num() + File.DataBytes.Num();
+	FSharedSaveFile SharedFile = MakeShared<const FSaveFile, ESPMode::ThreadSafe>(MoveTemp(File));
+
+	FScopeLock ScopeLock(&Lock);
+	const int32 Index = IndexOf(SlotName);
+	if (Index != INDEX_NONE)
+	{
+		if (Entries[Index].Revision > Revision)
+		{
+			// A read finished after a newer write was cached
+			return SharedFile;
+		}
+		RemoveAt(Index);
+	}
+
+	if (SharedFile->IsEmpty() || SharedFile->DataBytes.Num() <= 0 || MaxEntries <= 0 || Bytes > MaxBytes)
+	{
+		return SharedFile;
+	}
+
+	FEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.SlotName = FString{ SlotName };
+	Entry.Revision = Revision;
+	Entry.File = SharedFile;
+	Entry.Bytes = Bytes;
+	UsedBytes += Bytes;
+
+	Trim();
+	return SharedFile;
+}
+
+FSharedSaveFile FSlotCache::FindOrRead(ISaveStorageBackend& Storage, FStringView SlotName, bool bSkipData)
+{
+	const bool bEnabled = IsEnabled();
+	uint32 Revision = 0;
+	if (bEnabled)
+	{
+		// Taken before reading. A write in between stores a newer revision, so these bytes are never served stale
+		Revision = FFileAdapter::GetSlotRevision(SlotName);
+		if (FSharedSaveFile CachedFile = Find(SlotName, Revision))
+		{
+			return CachedFile;
+		}
+	}
+
+	// Lock is not held while reading, so many slots can be read at once
+	FSaveFile File;
+	if (!FFileAdapter::ReadFile(Storage, SlotName, File, bSkipData))
+	{
+		return {};
+	}
+
+	if (!bSkipData && bEnabled)
+	{
+		return Store(SlotName, Revision, MoveTemp(File));
+	}
+	return MakeShared<const FSaveFile, ESPMode::ThreadSafe>(MoveTemp(File));
+}
+
+FSharedSaveFile FSlotCache::Find(FStringView SlotName, uint32 Revision)
+{
+	FScopeLock ScopeLock(&Lock);
+	const int32 Index = IndexOf(SlotName);
+	if (Index == INDEX_NONE)
+	{
+		return {};
+	}
+
+	if (Entries[Index].Revision != Revision)
+	{
+		// The slot was written or deleted since. Cached bytes are stale
+		RemoveAt(Index);
+		return {};
+	}
+
+	// Mark as most recently used
+	FEntry Entry = MoveTemp(Entries[Index]);
+	Entries.RemoveAt(Index, 1, false);
+	return Entries.Add_GetRef(MoveTemp(Entry)).File;
+}
+
+void FSlotCache::Remove(FStringView SlotName)
+{
+	FScopeLock ScopeLock(&Lock);
+	const int32 Index = IndexOf(SlotName);
+	if (Index != INDEX_NONE)
+	{
+		RemoveAt(Index);
+	}
+}
+
+void FSlotCache::Empty()
+{
+	FScopeLock ScopeLock(&Lock);
+	Entries.Empty();
+	UsedBytes = 0;
+}
+
+int32 FSlotCache::IndexOf(FStringView SlotName) const
+{
+	return Entries.IndexOfByPredicate([SlotName](const FEntry& Entry) {
+		return SlotName.Equals(Entry.SlotName, ESearchCase::IgnoreCase);
+	});
+}
+
+void FSlotCache::RemoveAt(int32 Index)
+{
+	UsedBytes -= Entries[Index].Bytes;
+	Entries.RemoveAt(Index, 1, false);
+}
+
+void FSlotCache::Trim()
+{
+	while (Entries.Num() > 0 && (Entries.Num() > MaxEntries || UsedBytes > MaxBytes))
+	{
+		RemoveAt(0);
+	}
+}
@@ -30,6 +30,11 @@ void USlotData::Serialize(FArchive& Ar)
 	LevelFilterType->SerializeItem(Ar, &GeneralLevelFilter, nullptr);
 	MainLevel.Serialize(Ar);
 	Ar << SubLevels;
+
+	if (Ar.IsLoading())
+	{
+		RebuildSubLevelIndices();
+	}
 }
 
 void USlotData::CleanRecords(bool bKeepSublevels)
@@ -41,5 +46,49 @@ void USlotData::CleanRecords(bool bKeepSublevels)
 	if (!bKeepSublevels)
 	{
 		SubLevels.Empty();
+		SubLevelIndices.Empty();
+	}
+}
+
+FStreamingLevelRecord* USlotData::FindSubLevel(FName PackageName)
+{
+	// Records can be added to SubLevels directly. Validate the index before trusting it
+	const int32* Index = SubLevelIndices.Find(PackageName);
+	if (!Index || !SubLevels.IsValidIndex(*Index) || SubLevels[*Index].Name != PackageName)
+	{
+		if (SubLevelIndices.Num() == SubLevels.Num() && !Index)
+		{
+			return nullptr;
+		}
+
+		RebuildSubLevelIndices();
+		Index = SubLevelIndices.Find(PackageName);
+		if (!Index)
+		{
+			return nullptr;
+		}
+	}
+	return &SubLevels[*Index];
+}
+
+FStreamingLevelRecord& USlotData::FindOrAddSubLevel(const ULevelStreaming& Level)
+{
+	const FName PackageName = Level.GetWorldAssetPackageFName();
+	if (FStreamingLevelRecord* Record = FindSubLevel(PackageName))
+	{
+		return *Record;
+	}
+
+	SubLevelIndices.Add(PackageName, SubLevels.Num());
+	return SubLevels.Add_GetRef({ Level });
+}
+
+void USlotData::RebuildSubLevelIndices()
+{
+	SubLevelIndices.Reset();
+	SubLevelIndices.Reserve(SubLevels.Num());
+	for (int32 I = 0; I < SubLevels.Num(); ++I)
+	{
+		SubLevelIndices.Add(SubLevels[I].Name, I);
 	}
 }
@@ -0,0 +1,142 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "SlotObjectPool.h"
+
+#include <Misc/ScopeLock.h>
+#include <UObject/UnrealType.h>
+
+#include "SlotData.h"
+#include "SlotInfo.h"
+
+
+/////////////////////////////////////////////////////
+// FSlotObjectPool
+
+UObject* FSlotObjectPool::Acquire(UClass* Class, UObject* Outer)
+{
+	check(Class);
+
+	UObject* Object = nullptr;
+	{
+		FScopeLock ScopeLock(&Lock);
+		if (TArray<UObject*>* Objects = FreeObjects.Find(Class))
+		{
+			if (Objects->Num() > 0)
+			{
+				Object = Objects->Pop(false);
+			}
+		}
+
+		if (Object && !IsInGameThread())
+		{
+			// Not referenced by the pool anymore. Protect it until the caller owns it
+			Object->SetInternalFlags(EInternalObjectFlags::Async);
+		}
+	}
+
+	if (Object)
+	{
+		ResetToDefaults(Object);
+		return Object;
+	}
+
+	Object = NewObject<UObject>(Outer? Outer : GetTransientPackage(), Class);
+	if (!IsInGameThread())
+	{
+		Object->SetInternalFlags(EInternalObjectFlags::Async);
+	}
+	return Object;
+}
+
+void FSlotObjectPool::Release(UObject* Object)
+{
+	if (!Object)
+	{
+		return;
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	TArray<UObject*>& Objects = FreeObjects.FindOrAdd(Object->GetClass());
+	if (Objects.Num() < MaxFreePerClass)
+	{
+		Objects.AddUnique(Object);
+	}
+}
+
+USlotInfo* FSlotObjectPool::FindListedInfo(FStringView SlotName, const FSlotFileGeneration& Generation) const
+{
+	if (!Generation.IsValid())
+	{
+		return nullptr;
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	const FListedInfo* Listed = ListedInfos.Find(FString{ SlotName });
+	return (Listed && Listed->Generation == Generation)? Listed->Info : nullptr;
+}
+
+void FSlotObjectPool::AddListedInfo(FStringView SlotName, const FSlotFileGeneration& Generation, USlotInfo* Info)
+{
+	if (!Info || !Generation.IsValid())
+	{
+		return;
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	// Replaced infos may still be in use, so they are left to the garbage collector
+	ListedInfos.Add(FString{ SlotName }, { Info, Generation });
+}
+
+void FSlotObjectPool::RetainListedInfos(const TArray<FString>& SlotNames)
+{
+	const TSet<FString> Existing{ SlotNames };
+
+	FScopeLock ScopeLock(&Lock);
+	for (auto It = ListedInfos.CreateIterator(); It; ++It)
+	{
+		if (!Existing.Contains(It->Key))
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FSlotObjectPool::Empty()
+{
+	FScopeLock ScopeLock(&Lock);
+	FreeObjects.Empty();
+	ListedInfos.Empty();
+}
+
+void FSlotObjectPool::AddReferencedObjects(FReferenceCollector& Collector, const UObject* Referencer)
+{
+	FScopeLock ScopeLock(&Lock);
+	for (auto& Objects : FreeObjects)
+	{
+		Collector.AddReferencedObjects(Objects.Value, Referencer);
+	}
+	for (auto& Listed : ListedInfos)
+	{
+		Collector.AddReferencedObject(Listed.Value.Info, Referencer);
+	}
+}
+
+void FSlotObjectPool::ResetToDefaults(UObject* Object)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FSlotObjectPool::ResetToDefaults);
+
+	// Saved properties are delta serialized against defaults, so any value left would survive a load
+	const UClass* Class = Object->GetClass();
+	const UObject* Defaults = Class->GetDefaultObject();
+	for (TFieldIterator<FProperty> It(Class); It; ++It)
+	{
+		It->CopyCompleteValue_InContainer(Object, Defaults);
+	}
+
+	if (auto* Data = Cast<USlotData>(Object))
+	{
+		Data->bStoreGameInstance = false;
+		Data->GeneralLevelFilter = {};
+		Data->CleanRecords(false);
+	}
+}
@@ -0,0 +1,112 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Storage/FileStorageBackend.h"
+
+#include <HAL/FileManager.h>
+#include <HAL/PlatformFilemanager.h>
+#include <Serialization/ArchiveProxy.h>
+
+#include "FileAdapter.h"
+#include "Misc/SlotHelpers.h"
+
+
+/////////////////////////////////////////////////////
+// Helpers
+
+namespace FileStorage
+{
+	struct FTempFile
+	{
+		FString Path;
+		TUniquePtr<FArchive> Writer;
+	};
+
+	/** Writes into a temporary file that replaces the slot once closed, so slots are never left half-written */
+	class FReplacingFileWriter : private FTempFile, public FArchiveProxy
+	{
+		const FString Path;
+		bool bClosed = false;
+
+	public:
+
+		FReplacingFileWriter(FString InPath, FString InTempPath, TUniquePtr<FArchive>&& InWriter)
+			: FTempFile{ MoveTemp(InTempPath), MoveTemp(InWriter) }
+			, FArchiveProxy(*FTempFile::Writer)
+			, Path(MoveTemp(InPath))
+		{}
+
+		virtual ~FReplacingFileWriter()
+		{
+			Close();
+		}
+
+		virtual bool Close() override
+		{
+			if (bClosed)
+			{
+				return !IsError();
+			}
+			bClosed = true;
+
+			if (!Writer->Close() || Writer->IsError())
+			{
+				SetError();
+			}
+
+			IFileManager& FileManager = IFileManager::Get();
+			if (IsError() || !FileManager.Move(*Path, *FTempFile::Path, true, true))
+			{
+				SetError();
+				FileManager.Delete(*FTempFile::Path, false, true, true);
+			}
+			return !IsError();
+		}
+	};
+}
+
+
+/////////////////////////////////////////////////////
+// FFileStorageBackend
+
+TUniquePtr<FArchive> FFileStorageBackend::CreateReader(FStringView SlotName)
+{
+	return TUniquePtr<FArchive>{ IFileManager::Get().CreateFileReader(*FFileAdapter::GetSlotPath(SlotName), FILEREAD_Silent) };
+}
+
+TUniquePtr<FArchive> FFileStorageBackend::CreateWriter(FStringView SlotName)
+{
+	FString Path = FFileAdapter::GetSlotPath(SlotName);
+	FString TempPath = Path + TEXT(".tmp");
+	TUniquePtr<FArchive> Writer{ IFileManager::Get().CreateFileWriter(*TempPath) };
+	if (!Writer)
+	{
+		return {};
+	}
+	return MakeUnique<FileStorage::FReplacingFileWriter>(MoveTemp(Path), MoveTemp(TempPath), MoveTemp(Writer));
+}
+
+bool FFileStorageBackend::Delete(FStringView SlotName)
+{
+	return IFileManager::Get().Delete(*FFileAdapter::GetSlotPath(SlotName), true, false, true);
+}
+
+bool FFileStorageBackend::Exists(FStringView SlotName)
+{
+	return IFileManager::Get().FileSize(*FFileAdapter::GetSlotPath(SlotName)) >= 0;
+}
+
+FSlotFileGeneration FFileStorageBackend::GetGeneration(FStringView SlotName)
+{
+	const FFileStatData Stat = IFileManager::Get().GetStatData(*FFileAdapter::GetSlotPath(SlotName));
+	if (!Stat.bIsValid || Stat.bIsDirectory)
+	{
+		return {};
+	}
+	return { Stat.ModificationTime, Stat.FileSize };
+}
+
+void FFileStorageBackend::FindSlotNames(TArray<FString>& OutSlotNames)
+{
+	FSlotHelpers::FFindSlotVisitor Visitor{ OutSlotNames };
+	FPlatformFileManager::Get().GetPlatformFile().IterateDirectory(*FFileAdapter::GetSaveFolder(), Visitor);
+}
@@ -0,0 +1,76 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Storage/MemoryStorageBackend.h"
+
+#include <Misc/ScopeLock.h>
+#include <Serialization/BufferReader.h>
+
+
+/////////////////////////////////////////////////////
+// FMemoryStorageBackend
+
+TUniquePtr<FArchive> FMemoryStorageBackend::CreateReader(FStringView SlotName)
+{
+	FScopeLock ScopeLock(&Lock);
+	const FEntry* Entry = Slots.Find(FString{ SlotName });
+	if (!Entry)
+	{
+		return {};
+	}
+
+	// Readers get their own copy so that slots can be overwritten while being read
+	const int64 Size = Entry->Bytes.Num();
+	void* Data = FMemory::Malloc(FMath::Max<int64>(Size, 1));
+	FMemory::Memcpy(Data, Entry->Bytes.GetData(), Size);
+	return MakeUnique<FBufferReader>(Data, Size, true, true);
+}
+
+TUniquePtr<FArchive> FMemoryStorageBackend::CreateWriter(FStringView SlotName)
+{
+	return MakeUnique<FStorageCommitWriter>([this, Name = FString{ SlotName }](TArray<uint8>& Bytes) {
+		FScopeLock ScopeLock(&Lock);
+		FEntry& Entry = Slots.FindOrAdd(Name);
+		LastWriteTicks = FMath::Max(FDateTime::UtcNow().GetTicks(), LastWriteTicks + 1);
+		Entry.Generation = { FDateTime{ LastWriteTicks }, Bytes.Num() };
+		Entry.Bytes = MoveTemp(Bytes);
+		return true;
+	});
+}
+
+bool FMemoryStorageBackend::Delete(FStringView SlotName)
+{
+	FScopeLock ScopeLock(&Lock);
+	return Slots.Remove(FString{ SlotName }) > 0;
+}
+
+bool FMemoryStorageBackend::Exists(FStringView SlotName)
+{
+	FScopeLock ScopeLock(&Lock);
+	return Slots.Contains(FString{ SlotName });
+}
+
+FSlotFileGeneration FMemoryStorageBackend::GetGeneration(FStringView SlotName)
+{
+	FScopeLock ScopeLock(&Lock);
+	const FEntry* Entry = Slots.Find(FString{ SlotName });
+	return Entry? Entry->Generation : FSlotFileGeneration{};
+}
+
+void FMemoryStorageBackend::FindSlotNames(TArray<FString>& OutSlotNames)
+{
+	FScopeLock ScopeLock(&Lock);
+	for (const auto& Slot : Slots)
+	{
+		// Sub-slots live in a subfolder
+		if (!Slot.Key.Contains(TEXT("/")))
+		{
+			OutSlotNames.Add(Slot.Key);
+		}
+	}
+}
+
+void FMemoryStorageBackend::Empty()
+{
+	FScopeLock ScopeLock(&Lock);
+	Slots.Empty();
+}
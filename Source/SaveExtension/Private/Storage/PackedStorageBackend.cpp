@@ -0,0 +1,367 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#include "Storage/PackedStorageBackend.h"
+
+#include <HAL/PlatformFilemanager.h>
+#include <Misc/Paths.h>
+#include <Misc/ScopeLock.h>
+#include <Serialization/BufferReader.h>
+#include <Serialization/MemoryReader.h>
+
+#include "FileAdapter.h"
+#include "ISaveExtension.h"
+
+
+/////////////////////////////////////////////////////
+// FPackedStorageBackend
+
+FPackedStorageBackend::FPackedStorageBackend(FString InPackPath)
+	: PackPath(MoveTemp(InPackPath))
+{
+	if (PackPath.IsEmpty())
+	{
+		PackPath = FFileAdapter::GetSaveFolder() / TEXT("Slots.sepack");
+	}
+}
+
+TUniquePtr<FArchive> FPackedStorageBackend::CreateReader(FStringView SlotName)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FPackedStorageBackend::CreateReader);
+	FScopeLock ScopeLock(&Lock);
+
+	const FEntry* Entry = Index.Find(FString{ SlotName });
+	if (!Entry || !Open() || !Handle->Seek(Entry->Offset))
+	{
+		return {};
+	}
+
+	void* Data = FMemory::Malloc(FMath::Max<int64>(Entry->Size, 1));
+	if (!Handle->Read(static_cast<uint8*>(Data), Entry->Size))
+	{
+		FMemory::Free(Data);
+		return {};
+	}
+	return MakeUnique<FBufferReader>(Data, Entry->Size, true, true);
+}
+
+TUniquePtr<FArchive> FPackedStorageBackend::CreateWriter(FStringView SlotName)
+{
+	return MakeUnique<FStorageCommitWriter>([this, Name = FString{ SlotName }](TArray<uint8>& Bytes) {
+		FScopeLock ScopeLock(&Lock);
+		return Commit(Name, Bytes);
+	});
+}
+
+bool FPackedStorageBackend::Delete(FStringView SlotName)
+{
+	FScopeLock ScopeLock(&Lock);
+	if (!Open())
+	{
+		return false;
+	}
+
+	FEntry Entry;
+	if (!Index.RemoveAndCopyValue(FString{ SlotName }, Entry))
+	{
+		return false;
+	}
+	LiveBytes -= Entry.Size;
+
+	const bool bSuccess = WriteIndex();
+	TryCompact();
+	return bSuccess;
+}
+
+bool FPackedStorageBackend::Exists(FStringView SlotName)
+{
+	FScopeLock ScopeLock(&Lock);
+	return Open() && Index.Contains(FString{ SlotName });
+}
+
+FSlotFileGeneration FPackedStorageBackend::GetGeneration(FStringView SlotName)
+{
+	FScopeLock ScopeLock(&Lock);
+	if (Open())
+	{
+		if (const FEntry* Entry = Index.Find(FString{ SlotName }))
+		{
+			return { Entry->Timestamp, Entry->Size };
+		}
+	}
+	return {};
+}
+
+void FPackedStorageBackend::FindSlotNames(TArray<FString>& OutSlotNames)
+{
+	FScopeLock ScopeLock(&Lock);
+	if (!Open())
+	{
+		return;
+	}
+
+	for (const auto& Entry : Index)
+	{
+		// Sub-slots live in a subfolder
+		if (!Entry.Key.Contains(TEXT("/")))
+		{
+			OutSlotNames.Add(Entry.Key);
+		}
+	}
+}
+
+bool FPackedStorageBackend::Open()
+{
+	if (Handle)
+	{
+		return true;
+	}
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(PackPath));
+
+	// Compaction was interrupted after moving the old file away. A compacted file is only
+	// left behind once fully written, otherwise the old file is restored
+	const FString TempPath = GetTempPath();
+	const FString OldPath = GetOldPath();
+	if (!PlatformFile.FileExists(*PackPath))
+	{
+		if (PlatformFile.FileExists(*TempPath))
+		{
+			PlatformFile.MoveFile(*PackPath, *TempPath);
+		}
+		else if (PlatformFile.FileExists(*OldPath))
+		{
+			PlatformFile.MoveFile(*PackPath, *OldPath);
+		}
+	}
+
+	if (PlatformFile.FileExists(*PackPath))
+	{
+		Handle.Reset(PlatformFile.OpenWrite(*PackPath, true, true));
+		if (!Handle)
+		{
+			// Not corrupted, maybe only in use. Tried again on the next operation
+			UE_LOG(LogSaveExtension, Warning, TEXT("Failed to open packed save file '%s'."), *PackPath);
+			return false;
+		}
+
+		if (ReadIndex())
+		{
+			PlatformFile.DeleteFile(*OldPath);
+			return true;
+		}
+		Handle.Reset();
+
+		// Moved aside so that its slots can still be recovered. A new pack is only started once it is out of the way
+		const FString CorruptPath = FString::Printf(TEXT("%s.%s.corrupt"), *PackPath, *FDateTime::UtcNow().ToString());
+		if (!PlatformFile.MoveFile(*CorruptPath, *PackPath))
+		{
+			UE_LOG(LogSaveExtension, Error, TEXT("Packed save file '%s' is corrupted and couldn't be moved aside."), *PackPath);
+			return false;
+		}
+		UE_LOG(LogSaveExtension, Warning, TEXT("Packed save file '%s' is corrupted. It was moved to '%s'."), *PackPath, *CorruptPath);
+	}
+	return Reset();
+}
+
+bool FPackedStorageBackend::OpenExisting()
+{
+	Handle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*PackPath, true, true));
+	if (Handle && ReadIndex())
+	{
+		return true;
+	}
+	Handle.Reset();
+	return false;
+}
+
+bool FPackedStorageBackend::ReadIndex()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FPackedStorageBackend::ReadIndex);
+	Index.Empty();
+	LiveBytes = 0;
+	EndOffset = Handle->Size();
+	if (EndOffset < HeaderSize)
+	{
+		return false;
+	}
+
+	TArray<uint8> Header;
+	Header.SetNumUninitialized(HeaderSize);
+	if (!Handle->Seek(0) || !Handle->Read(Header.GetData(), HeaderSize))
+	{
+		return false;
+	}
+
+	uint32 FileMagic = 0;
+	int32 FileVersion = 0;
+	int64 IndexOffset = 0;
+	{
+		FMemoryReader Ar(Header);
+		Ar << FileMagic << FileVersion << IndexOffset;
+	}
+	if (FileMagic != Magic || FileVersion != Version || IndexOffset < HeaderSize || IndexOffset > EndOffset)
+	{
+		return false;
+	}
+
+	// Anything after the index was an interrupted write
+	TArray<uint8> IndexBytes;
+	IndexBytes.SetNumUninitialized(EndOffset - IndexOffset);
+	if (!Handle->Seek(IndexOffset) || !Handle->Read(IndexBytes.GetData(), IndexBytes.Num()))
+	{
+		return false;
+	}
+
+	FMemoryReader Ar(IndexBytes);
+	Ar << Index;
+	if (Ar.IsError())
+	{
+		Index.Empty();
+		return false;
+	}
+
+	for (const auto& Entry : Index)
+	{
+		LiveBytes += Entry.Value.Size;
+	}
+	EndOffset = IndexOffset + Ar.Tell();
+	return true;
+}
+
+bool FPackedStorageBackend::Reset()
+{
+	Handle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*PackPath, false, true));
+	if (!Handle)
+	{
+		UE_LOG(LogSaveExtension, Warning, TEXT("Failed to open packed save file '%s'."), *PackPath);
+		return false;
+	}
+
+	Index.Empty();
+	LiveBytes = 0;
+	EndOffset = HeaderSize;
+	return WriteIndex();
+}
+
+bool FPackedStorageBackend::Commit(const FString& SlotName, const TArray<uint8>& Bytes)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FPackedStorageBackend::Commit);
+	if (!Open() || !Append(SlotName, Bytes, FDateTime::UtcNow()))
+	{
+		return false;
+	}
+
+	const bool bSuccess = WriteIndex();
+	TryCompact();
+	return bSuccess;
+}
+
+bool FPackedStorageBackend::Append(const FString& SlotName, const TArray<uint8>& Bytes, FDateTime Timestamp)
+{
+	FEntry Entry;
+	Entry.Offset = EndOffset;
+	Entry.Size = Bytes.Num();
+	Entry.Timestamp = Timestamp;
+	if (!Handle->Seek(Entry.Offset) || !Handle->Write(Bytes.GetData(), Entry.Size))
+	{
+		return false;
+	}
+	EndOffset += Entry.Size;
+
+	if (const FEntry* Previous = Index.Find(SlotName))
+	{
+		LiveBytes -= Previous->Size;
+	}
+	Index.Add(SlotName, Entry);
+	LiveBytes += Entry.Size;
+	return true;
+}
+
+bool FPackedStorageBackend::WriteIndex()
+{
+	TArray<uint8> IndexBytes;
+	{
+		FMemoryWriter Ar(IndexBytes);
+		Ar << Index;
+	}
+
+	// Slots and index must reach disk before the header points to them
+	const int64 IndexOffset = EndOffset;
+	if (!Handle->Seek(IndexOffset) || !Handle->Write(IndexBytes.GetData(), IndexBytes.Num()) || !Handle->Flush(true))
+	{
+		return false;
+	}
+	EndOffset += IndexBytes.Num();
+
+	TArray<uint8> Header;
+	{
+		FMemoryWriter Ar(Header);
+		uint32 FileMagic = Magic;
+		int32 FileVersion = Version;
+		int64 Offset = IndexOffset;
+		Ar << FileMagic << FileVersion << Offset;
+	}
+	return Handle->Seek(0) && Handle->Write(Header.GetData(), Header.Num()) && Handle->Flush(true);
+}
+
+void FPackedStorageBackend::TryCompact()
+{
+	const int64 WastedBytes = EndOffset - HeaderSize - LiveBytes;
+	if (WastedBytes < FMath::Max(LiveBytes, MinCompactBytes))
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(FPackedStorageBackend::TryCompact);
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const FString TempPath = GetTempPath();
+	{
+		FPackedStorageBackend Compacted{ TempPath };
+		FScopeLock CompactedLock(&Compacted.Lock);
+		bool bSuccess = Compacted.Reset();
+
+		// Copy live slots one by one keeping their timestamps, then write a single index
+		TArray<uint8> Bytes;
+		for (auto It = Index.CreateConstIterator(); bSuccess && It; ++It)
+		{
+			const FEntry& Entry = It.Value();
+			Bytes.SetNumUninitialized(Entry.Size, false);
+			bSuccess = Handle->Seek(Entry.Offset) && Handle->Read(Bytes.GetData(), Entry.Size) &&
+					   Compacted.Append(It.Key(), Bytes, Entry.Timestamp);
+		}
+		bSuccess = bSuccess && Compacted.WriteIndex();
+
+		Compacted.Handle.Reset();
+		if (!bSuccess)
+		{
+			PlatformFile.DeleteFile(*TempPath);
+			return;
+		}
+	}
+
+	// The old pack is kept until the compacted one is opened
+	Handle.Reset();
+	const FString OldPath = GetOldPath();
+	PlatformFile.DeleteFile(*OldPath);
+	if (PlatformFile.MoveFile(*OldPath, *PackPath))
+	{
+		if (PlatformFile.MoveFile(*PackPath, *TempPath) && OpenExisting())
+		{
+			PlatformFile.DeleteFile(*OldPath);
+			return;
+		}
+
+		UE_LOG(LogSaveExtension, Warning, TEXT("Failed to open compacted save file '%s'. Keeping the previous one."), *PackPath);
+		PlatformFile.DeleteFile(*PackPath);
+		PlatformFile.MoveFile(*PackPath, *OldPath);
+	}
+	PlatformFile.DeleteFile(*TempPath);
+
+	// Never reset here, the previous pack is still valid
+	if (!OpenExisting())
+	{
+		UE_LOG(LogSaveExtension, Warning, TEXT("Failed to reopen packed save file '%s'."), *PackPath);
+	}
+}
@@ -19,45 +19,58 @@ class USlotInfo;
 class USlotData;
 class FMemoryReader;
 class FMemoryWriter;
+class ISaveStorageBackend;
+class FSlotObjectPool;
+class FSlotCache;
+enum class ESaveStorage : uint8;
 
+using FSaveStorageRef = TSharedRef<ISaveStorageBackend, ESPMode::ThreadSafe>;
 
+
+/** Writes a slot into a storage backend */
 struct FScopedFileWriter
 {
 private:
-	FArchive* Writer = nullptr;
+	TUniquePtr<FArchive> Writer;
 
 public:
-	FScopedFileWriter(FStringView Filename, int32 Flags = 0);
-	~FScopedFileWriter()
-	{
-		delete Writer;
-	}
+	FScopedFileWriter(ISaveStorageBackend& Storage, FStringView SlotName);
 
 	FArchive& GetArchive() { return *Writer; }
-	bool IsValid() const { return Writer != nullptr; }
+	bool IsValid() const { return Writer.IsValid(); }
 	bool IsError() const { return Writer && (Writer->IsError() || Writer->IsCriticalError()); }
 };
 
 
+/** Reads a slot from a storage backend */
 struct FScopedFileReader
 {
 private:
 	FScopedLoadingState ScopedLoadingState;
-	FArchive* Reader = nullptr;
+	TUniquePtr<FArchive> Reader;
 
 public:
-	FScopedFileReader(FStringView Filename, int32 Flags = 0);
-	~FScopedFileReader()
-	{
-		delete Reader;
-	}
+	FScopedFileReader(ISaveStorageBackend& Storage, FStringView SlotName);
 
 	FArchive& GetArchive() { return *Reader; }
-	bool IsValid() const { return Reader != nullptr; }
+	bool IsValid() const { return Reader.IsValid(); }
+};
+
+
+/**
+ * Bytes of a slot file. Based on GameplayStatics to add multi-threading.
+ * Reading and writing is thread-safe. Creating objects from it is not.
+ */
+/** How slot files are written. Captured from the preset when a write is started, so that later changes don't affect it */
+struct FSaveFileSettings
+{
+	bool bUseCompression = true;
+	/** Registered compression dictionary. 0 compresses without dictionary */
+	uint32 DictionaryId = 0;
+	bool bEncrypt = false;
 };
 
 
-/** Based on GameplayStatics to add multi-threading */
 struct FSaveFile
 {
 	int32 FileTypeTag = 0;
@@ -80,32 +93,75 @@ struct FSaveFile
 	void Empty();
 	bool IsEmpty() const;
 
+	/** @return true if the file was written with older file, engine or custom versions. Only the header needs to be read */
+	bool IsOutdated() const;
+
 	void Read(FScopedFileReader& Reader, bool bSkipData);
-	void Write(FScopedFileWriter& Writer, bool bCompressData);
+	void Write(FScopedFileWriter& Writer, const FSaveFileSettings& Settings);
 
 	void SerializeInfo(USlotInfo* SlotInfo);
 	void SerializeData(USlotData* SlotData);
-	USlotInfo* CreateAndDeserializeInfo(const UObject* Outer) const;
-	USlotData* CreateAndDeserializeData(const UObject* Outer) const;
+	/** Objects are taken from the pool if provided */
+	USlotInfo* CreateAndDeserializeInfo(const UObject* Outer, FSlotObjectPool* Pool = nullptr) const;
+	USlotData* CreateAndDeserializeData(const UObject* Outer, FSlotObjectPool* Pool = nullptr) const;
 };
 
 
-/** Based on GameplayStatics to add multi-threading */
+/**
+ * Based on GameplayStatics to add multi-threading.
+ * Slots are read from and written to the storage backend provided, usually the one of a save manager.
+ */
 class SAVEEXTENSION_API FFileAdapter
 {
 public:
 
-	static bool SaveFile(FStringView SlotName, USlotInfo* Info, USlotData* Data, const bool bUseCompression);
+	static bool SaveFile(ISaveStorageBackend& Storage, FStringView SlotName, USlotInfo* Info, USlotData* Data, const FSaveFileSettings& Settings);
+
+	/**
+	 * Writes an already serialized file to disk
+	 * @param Cache if provided, the file is moved into it before the slot is unlocked
+	 */
+	static bool SaveFile(ISaveStorageBackend& Storage, FStringView SlotName, FSaveFile& File, const FSaveFileSettings& Settings, FSlotCache* Cache = nullptr);
+
+	/**
+	 * Writes an already serialized file only if the slot was not written or deleted since Revision was taken.
+	 * The check and the write can't be interleaved with other writes to the same slot.
+	 */
+	static bool SaveFileIfUnchanged(ISaveStorageBackend& Storage, FStringView SlotName, FSaveFile& File, const FSaveFileSettings& Settings, uint32 Revision);
 
-	// Not safe for Multi-threading
-	static bool LoadFile(FStringView SlotName, USlotInfo*& Info, USlotData*& Data, bool bLoadData, const UObject* Outer);
+	/** @return a counter increased every time the slot is written or deleted by this process. Thread-safe */
+	static uint32 GetSlotRevision(FStringView SlotName);
 
-	static bool DeleteFile(FStringView SlotName);
-	static bool DoesFileExist(FStringView SlotName);
+	/** Reads and decompresses a slot without creating any objects. Thread-safe */
+	static bool ReadFile(ISaveStorageBackend& Storage, FStringView SlotName, FSaveFile& OutFile, bool bSkipData = false);
+
+	// Not safe for Multi-threading. Use ReadFile to read from other threads
+	static bool LoadFile(ISaveStorageBackend& Storage, FStringView SlotName, USlotInfo*& Info, USlotData*& Data, bool bLoadData, const UObject* Outer);
+
+	static bool DeleteFile(ISaveStorageBackend& Storage, FStringView SlotName);
+	static bool DoesFileExist(ISaveStorageBackend& Storage, FStringView SlotName);
+
+	/** Loose files in the save folder. Used when no save manager is involved, e.g by editor tools */
+	static FSaveStorageRef GetDefaultStorage();
+
+	/**
+	 * @return a backend of the provided type.
+	 * Backends stored on disk are shared since they use the same files. Memory backends are never shared.
+	 */
+	static FSaveStorageRef MakeStorage(ESaveStorage Type);
 
 	static const FString& GetSaveFolder();
+	/** Path of a slot when stored as loose files */
 	static FString GetSlotPath(FStringView SlotName);
+	/** Thumbnails are always stored as loose files */
 	static FString GetThumbnailPath(FStringView SlotName);
 
-	static void DeserializeObject(UObject*& Object, FStringView ClassName, const UObject* Outer, const TArray<uint8>& Bytes);
+	/** Sub-slots are stored in their own folder so that they are never listed as slots */
+	static FString GetSubSlotName(FName SubSlotName);
+
+	static void DeserializeObject(UObject*& Object, FStringView ClassName, const UObject* Outer, const TArray<uint8>& Bytes, FSlotObjectPool* Pool = nullptr);
+
+private:
+
+	static bool WriteFile(ISaveStorageBackend& Storage, FStringView SlotName, FSaveFile& File, const FSaveFileSettings& Settings);
 };
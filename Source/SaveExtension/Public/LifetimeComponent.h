@@ -62,11 +62,11 @@ protected:
 	UPROPERTY(BlueprintAssignable, Category = SaveExtension)
 	FLifetimeStartSignature Start;
 
-	// Called when game is saved
+	// Called when game is saved, or the level of this actor
 	UPROPERTY(BlueprintAssignable, Category = SaveExtension)
 	FLifetimeSavedSignature Saved;
 
-	// Called when game loaded
+	// Called when game loaded, or the level of this actor
 	UPROPERTY(BlueprintAssignable, Category = SaveExtension)
 	FLifetimeResumeSignature Resume;
 
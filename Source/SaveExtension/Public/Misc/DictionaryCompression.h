@@ -0,0 +1,47 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <HAL/CriticalSection.h>
+#include <Templates/SharedPointer.h>
+
+
+using FSharedDictionary = TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe>;
+
+/**
+ * Zlib compression with a preset dictionary.
+ * Small files share most of their content (class and property names), which a dictionary provides up front.
+ * Compressed streams identify their dictionary, so any registered dictionary can decompress them.
+ * Thread-safe.
+ */
+struct SAVEEXTENSION_API FDictionaryCompression
+{
+private:
+
+	static FCriticalSection Lock;
+	static TMap<uint32, FSharedDictionary> Dictionaries;
+
+public:
+
+	/** zlib only uses the last 32KB of a dictionary */
+	static constexpr int32 MaxDictionarySize = 32 * 1024;
+
+
+	/** Registers a dictionary so that data compressed with it can be decompressed. @return its id. 0 if empty */
+	static uint32 Register(const TArray<uint8>& Dictionary);
+
+	/** @return the registered dictionary with this id. Invalid if 0 or not registered */
+	static FSharedDictionary Find(uint32 Id);
+
+	static bool Compress(const TArray<uint8>& Dictionary, const TArray<uint8>& Uncompressed, TArray<uint8>& OutCompressed);
+
+	/** @param UncompressedSize must be the exact size of the original data */
+	static bool Decompress(const TArray<uint8>& Compressed, int32 UncompressedSize, TArray<uint8>& OutUncompressed);
+
+	/**
+	 * Builds a dictionary from sample files. Segments containing the byte sequences repeated by most samples are
+	 * picked, placing the most common ones at the end where they are cheaper to reference.
+	 */
+	static void Train(const TArray<TArray<uint8>>& Samples, int32 MaxSize, TArray<uint8>& OutDictionary);
+};
@@ -0,0 +1,68 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <HAL/CriticalSection.h>
+#include <Misc/Guid.h>
+#include <Templates/SharedPointer.h>
+
+
+/** Nonce and authentication tags of data encrypted with FSaveEncryption */
+struct FEncryptedBlocks
+{
+	/** Unique per file. Each block's IV also includes its index */
+	FGuid Nonce;
+	/** One tag per block */
+	TArray<uint8> Tags;
+
+	friend FArchive& operator<<(FArchive& Ar, FEncryptedBlocks& Blocks)
+	{
+		Ar << Blocks.Nonce;
+		Ar << Blocks.Tags;
+		return Ar;
+	}
+};
+
+
+/**
+ * AES-256-GCM encryption of slot data.
+ * Data is split in blocks that are encrypted and authenticated in parallel and in place, so it costs no extra copies.
+ * OpenSSL is used, which runs on the CPU's AES instructions when available.
+ * Only platforms shipping OpenSSL are supported. Thread-safe.
+ */
+struct SAVEEXTENSION_API FSaveEncryption
+{
+private:
+
+	using FSharedKey = TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe>;
+
+	static FCriticalSection Lock;
+	static FSharedKey Key;
+
+public:
+
+	static constexpr int32 KeySize = 32;
+	static constexpr int32 TagSize = 16;
+	static constexpr int32 BlockSize = 256 * 1024;
+
+
+	static bool IsSupported();
+
+	/** Key used to encrypt and decrypt files. @return false if not supported or not KeySize bytes. Empty clears it */
+	static bool SetKey(TArrayView<const uint8> NewKey);
+	static bool HasKey();
+
+	/**
+	 * Encrypts Bytes in place
+	 * @param Context authenticated along with the data, e.g the format of the encrypted bytes
+	 */
+	static bool Encrypt(TArray<uint8>& Bytes, uint32 Context, FEncryptedBlocks& OutBlocks);
+
+	/** Decrypts Bytes in place. @return false if the key is missing or data was modified */
+	static bool Decrypt(TArray<uint8>& Bytes, uint32 Context, const FEncryptedBlocks& Blocks);
+
+private:
+
+	static FSharedKey GetKey();
+};
@@ -0,0 +1,141 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <UObject/ObjectKey.h>
+#include <UObject/UObjectGlobals.h>
+
+class ULevel;
+class ISaveExtensionInterface;
+
+
+/** Events of ISaveExtensionInterface */
+enum class ESaveEvent : uint8
+{
+	None         = 0,
+	SaveBegan    = 1 << 0,
+	SaveFinished = 1 << 1,
+	LoadBegan    = 1 << 2,
+	LoadFinished = 1 << 3
+};
+ENUM_CLASS_FLAGS(ESaveEvent)
+
+
+/**
+ * Objects subscribed to save and load events, bucketed by the level they belong to.
+ * Subscribing and unsubscribing are O(1). Subscribers can be added or removed while dispatching.
+ */
+class SAVEEXTENSION_API FSaveEventSubscribers
+{
+public:
+
+	struct FSubscriber
+	{
+		FObjectKey Key;
+		UObject* Object = nullptr;
+
+		/** Null if the object doesn't implement the interface in C++ */
+		ISaveExtensionInterface* Native = nullptr;
+
+		/** Blueprint events implemented by the object. Others are never called */
+		ESaveEvent ScriptEvents = ESaveEvent::None;
+	};
+
+private:
+
+	struct FBucket
+	{
+		TArray<FSubscriber> Subscribers;
+		bool bHasRemoved = false;
+	};
+
+	struct FLocation
+	{
+		FObjectKey Level;
+		int32 Index = INDEX_NONE;
+	};
+
+	/** Subscribers by level. Objects outside of levels use an empty key */
+	TMap<FObjectKey, FBucket> Buckets;
+	TMap<FObjectKey, FLocation> Locations;
+	TMap<FObjectKey, ESaveEvent> ScriptEventsByClass;
+
+	/** Subscribed while dispatching */
+	TArray<UObject*> PendingAdds;
+	int32 DispatchDepth = 0;
+	bool bHasRemoved = false;
+
+
+public:
+
+	void Add(UObject* Object);
+	void Remove(UObject* Object);
+
+	int32 Num() const { return Locations.Num() + PendingAdds.Num(); }
+
+	/**
+	 * Calls Callback(const FSubscriber&) on each valid subscriber.
+	 * @param Level if provided, only subscribers in this level are notified
+	 */
+	template<typename FunctionType>
+	void ForEach(const ULevel* Level, FunctionType&& Callback);
+
+	void AddReferencedObjects(FReferenceCollector& Collector, const UObject* Referencer);
+
+private:
+
+	template<typename FunctionType>
+	void ForEachInBucket(FBucket& Bucket, FunctionType& Callback);
+
+	void BeginDispatch() { ++DispatchDepth; }
+	void EndDispatch();
+
+	void RemoveAtSwap(FBucket& Bucket, FObjectKey LevelKey, int32 Index);
+	void RemoveDuringDispatch(FBucket& Bucket, int32 Index);
+
+	ESaveEvent GetScriptEvents(const UClass* Class);
+	static FObjectKey GetLevelKey(const UObject* Object);
+};
+
+
+template<typename FunctionType>
+void FSaveEventSubscribers::ForEach(const ULevel* Level, FunctionType&& Callback)
+{
+	BeginDispatch();
+	if (Level)
+	{
+		if (FBucket* Bucket = Buckets.Find(FObjectKey{ Level }))
+		{
+			ForEachInBucket(*Bucket, Callback);
+		}
+	}
+	else
+	{
+		for (auto& Pair : Buckets)
+		{
+			ForEachInBucket(Pair.Value, Callback);
+		}
+	}
+	EndDispatch();
+}
+
+template<typename FunctionType>
+void FSaveEventSubscribers::ForEachInBucket(FBucket& Bucket, FunctionType& Callback)
+{
+	// Buckets don't change size while dispatching
+	for (int32 I = 0; I < Bucket.Subscribers.Num(); ++I)
+	{
+		const FSubscriber Subscriber = Bucket.Subscribers[I];
+		if (::IsValid(Subscriber.Object))
+		{
+			Callback(Subscriber);
+		}
+		else if (Subscriber.Key != FObjectKey{})
+		{
+			// Destroyed without unsubscribing
+			Locations.Remove(Subscriber.Key);
+			RemoveDuringDispatch(Bucket, I);
+		}
+	}
+}
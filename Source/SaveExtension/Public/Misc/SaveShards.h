@@ -0,0 +1,51 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+
+class AActor;
+class APlayerState;
+class UWorld;
+struct FSELevelFilter;
+
+
+/**
+ * Splits the world in shards saved as independent sub-slots:
+ * One per player, with the actors it owns, and one with the rest of the world.
+ */
+struct SAVEEXTENSION_API FSaveShards
+{
+	/** Actors with a tag starting with this prefix belong to the owner id that follows it */
+	static const FString OwnerTagPrefix;
+
+	static const FName WorldShardName;
+
+
+	/** @return tag assigning an actor to the shard of an owner id */
+	static FName MakeOwnerTag(const FString& OwnerId);
+
+	/**
+	 * @return persistent id of a player, valid as a file name: its owner tag, or its online id.
+	 * Empty if it has neither, since it couldn't be recognized in another session
+	 */
+	static FString GetPlayerId(const APlayerState* Player);
+
+	/**
+	 * @return id of the player owning an actor, from its owner tag or its owner chain
+	 * (player states, player controllers and their pawns). Empty if owned by the world
+	 */
+	static FString GetOwnerId(const AActor* Actor);
+
+	static FName GetShardName(const FString& OwnerId);
+	static FName GetPlayerShardName(const APlayerState* Player)
+	{
+		return GetShardName(GetPlayerId(Player));
+	}
+
+	/** @return the id in the owner tag of an actor. Empty if it has none */
+	static FString FindOwnerTag(const AActor* Actor);
+
+	/** Groups in one pass all actors that pass a filter by owner id. World actors use an empty id */
+	static void GatherActors(const UWorld* World, const FSELevelFilter& Filter, TMap<FString, TArray<AActor*>>& OutActors);
+};
@@ -0,0 +1,64 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <HAL/PlatformTime.h>
+
+
+/**
+ * Finds actors and components that are slow to save or load.
+ * Enabled with "SaveExtension.Watchdog 1". Records are sampled, timed and logged if they take more than
+ * "SaveExtension.Watchdog.ThresholdMs" or "SaveExtension.Watchdog.ThresholdKB".
+ * "SaveExtension.Watchdog.Top [N]" prints the classes that took most time since "SaveExtension.Watchdog.Reset".
+ * Thread-safe.
+ */
+struct SAVEEXTENSION_API FSerializationWatchdog
+{
+	enum class EOperation : uint8
+	{
+		Save,
+		Load
+	};
+
+	/** @return true if the next record should be timed. Cheap and safe on any thread */
+	static bool ShouldSample();
+
+	static void Report(EOperation Operation, const UObject* Object, double Seconds, int32 Bytes);
+
+	/** Prints the N classes that took most time */
+	static void PrintTop(int32 Num, FOutputDevice& Ar);
+
+	static void Reset();
+};
+
+
+/** Times the serialization of a record while in scope, if sampled */
+class FScopedSerializationWatch
+{
+	const UObject* Object = nullptr;
+	const TArray<uint8>* Data = nullptr;
+	FSerializationWatchdog::EOperation Operation;
+	double StartTime = 0.0;
+
+public:
+
+	FScopedSerializationWatch(FSerializationWatchdog::EOperation InOperation, const UObject* InObject, const TArray<uint8>& InData)
+		: Operation(InOperation)
+	{
+		if (FSerializationWatchdog::ShouldSample())
+		{
+			Object = InObject;
+			Data = &InData;
+			StartTime = FPlatformTime::Seconds();
+		}
+	}
+
+	~FScopedSerializationWatch()
+	{
+		if (Object)
+		{
+			FSerializationWatchdog::Report(Operation, Object, FPlatformTime::Seconds() - StartTime, Data->Num());
+		}
+	}
+};
@@ -10,7 +10,7 @@
 
 struct FSlotHelpers
 {
-	static void FindSlotFileNames(TArray<FString>& FoundSlots);
+	static void FindSlotFileNames(ISaveStorageBackend& Storage, TArray<FString>& FoundSlots);
 
 	/** Used to find next available slot id */
 	class FFindSlotVisitor : public IPlatformFile::FDirectoryVisitor
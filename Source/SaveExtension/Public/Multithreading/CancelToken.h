@@ -0,0 +1,24 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <HAL/ThreadSafeBool.h>
+#include <Templates/SharedPointer.h>
+
+
+/**
+ * Flag shared between a slot task and the async work it starts.
+ * Async work checks it at safe points and stops early once cancelled.
+ */
+class FSECancelToken
+{
+	FThreadSafeBool bCancelled = false;
+
+public:
+
+	void Cancel() { bCancelled = true; }
+	bool IsCancelled() const { return bCancelled; }
+};
+
+using FSECancelTokenPtr = TSharedPtr<FSECancelToken, ESPMode::ThreadSafe>;
@@ -4,8 +4,13 @@
 
 #include <CoreMinimal.h>
 
+#include "SlotCache.h"
+
 
 DECLARE_DELEGATE_OneParam(FOnSlotInfosLoaded, const TArray<class USlotInfo*>&);
 
+// @param Files read, in the same order as requested. Missing slots are null
+DECLARE_DELEGATE_OneParam(FOnSlotFilesRead, const TArray<FSharedSaveFile>&);
+
 // @param Amount of slots removed
 DECLARE_DELEGATE(FOnSlotsDeleted);
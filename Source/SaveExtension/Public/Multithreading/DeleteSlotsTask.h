@@ -10,6 +10,7 @@
 #include <Async/AsyncWork.h>
 
 
+class FSlotCache;
 class USaveManager;
 
 /**
@@ -20,6 +21,7 @@ class FDeleteSlotsTask : public FNonAbandonableTask {
 protected:
 
 	const USaveManager* const Manager = nullptr;
+	FSaveStorageRef Storage;
 	FString SpecificSlotName;
 
 public:
@@ -31,6 +33,11 @@ public:
 
 	void DoWork();
 
+	/** Deletes many slots and their thumbnails in parallel
+	 * @return true if any file was deleted
+	 */
+	static bool DeleteSlots(ISaveStorageBackend& Storage, TArrayView<const FString> SlotNames, FSlotCache* Cache);
+
 	FORCEINLINE TStatId GetStatId() const
 	{
 		RETURN_QUICK_DECLARE_CYCLE_STAT(FDeleteSlotsTask, STATGROUP_ThreadPoolAsyncTasks);
@@ -4,6 +4,12 @@
 
 #include <Async/AsyncWork.h>
 #include "FileAdapter.h"
+#include "Multithreading/CancelToken.h"
+#include "SlotCache.h"
+#include "SlotObjectPool.h"
+
+
+class USaveManager;
 
 
 /////////////////////////////////////////////////////
@@ -16,47 +22,48 @@ protected:
 	TWeakObjectPtr<USaveManager> Manager;
 	const FString SlotName;
 
+	/** Captured on creation, so that changing the manager's storage doesn't affect this task */
+	FSaveStorageRef Storage;
+
+	/** If valid, slots will be read from memory when possible */
+	TSharedPtr<FSlotCache, ESPMode::ThreadSafe> Cache;
+
+	/** If valid, objects are reused from it */
+	TSharedPtr<FSlotObjectPool, ESPMode::ThreadSafe> Pool;
+
+	/** If cancelled, objects are not created. Bytes already read are still cached */
+	FSECancelTokenPtr CancelToken;
+
+	/** Read on the worker. Objects are created from it on the game thread */
+	FSharedSaveFile File;
+	bool bCreatedObjects = false;
+
 	TWeakObjectPtr<USlotInfo> SlotInfo;
 	TWeakObjectPtr<USlotData> SlotData;
 
 
 public:
 
-	explicit FLoadFileTask(USaveManager* Manager, FStringView SlotName)
-		: Manager(Manager)
-		, SlotName(SlotName)
-	{}
-	~FLoadFileTask()
-	{
-		if(SlotInfo.IsValid())
-		{
-			SlotInfo->ClearInternalFlags(EInternalObjectFlags::Async);
-		}
-		if(SlotData.IsValid())
-		{
-			SlotData->ClearInternalFlags(EInternalObjectFlags::Async);
-		}
-	}
+	explicit FLoadFileTask(USaveManager* Manager, FStringView SlotName, FSECancelTokenPtr InCancelToken = {});
 
-	void DoWork()
+	/** Only reads the file. Objects are not created on workers */
+	void DoWork();
+
+	bool IsCancelled() const
 	{
-		FScopedFileReader FileReader(FFileAdapter::GetSlotPath(SlotName));
-		if(FileReader.IsValid())
-		{
-			FSaveFile File;
-			File.Read(FileReader, false);
-			SlotInfo = File.CreateAndDeserializeInfo(Manager.Get());
-			SlotData = File.CreateAndDeserializeData(Manager.Get());
-		}
+		return CancelToken.IsValid() && CancelToken->IsCancelled();
 	}
 
+	/** Info and data are created on first access. Game thread only, once the task is done */
 	USlotInfo* GetInfo()
 	{
+		CreateObjects();
 		return SlotInfo.Get();
 	}
 
 	USlotData* GetData()
 	{
+		CreateObjects();
 		return SlotData.Get();
 	}
 
@@ -64,4 +71,8 @@ public:
 	{
 		RETURN_QUICK_DECLARE_CYCLE_STAT(FLoadFileTask, STATGROUP_ThreadPoolAsyncTasks);
 	}
+
+private:
+
+	void CreateObjects();
 };
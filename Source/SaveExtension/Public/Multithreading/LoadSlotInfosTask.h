@@ -5,7 +5,9 @@
 #include <Async/AsyncWork.h>
 #include "FileAdapter.h"
 #include "Multithreading/Delegates.h"
+#include "Multithreading/SlotPromise.h"
 
+#include "SlotCache.h"
 #include "SlotInfo.h"
 
 class USaveManager;
@@ -21,33 +23,44 @@ protected:
 
 	const USaveManager* Manager;
 
+	/** Captured on creation, so that changing the manager's storage doesn't affect this task */
+	FSaveStorageRef Storage;
+
 	const bool bSortByRecent = false;
 	// If not empty, only this specific slot will be loaded
 	const FName SlotName;
 
+	/** Read on the worker. Infos that didn't change since they were listed are reused instead */
+	TArray<FString> FileNames;
+	TArray<FSlotFileGeneration> Generations;
+	TArray<FSharedSaveFile> LoadedFiles;
+	TArray<USlotInfo*> ListedInfos;
+
 	TArray<USlotInfo*> LoadedSlots;
 
 	FOnSlotInfosLoaded Delegate;
 
+	/** Resolved after finishing, once infos are safe to use outside of the task */
+	TSlotPromisePtr<TArray<USlotInfo*>> Promise;
+
 
 public:
 
 	/** All infos Constructor */
-	explicit FLoadSlotInfosTask(const USaveManager* Manager, bool bInSortByRecent, const FOnSlotInfosLoaded& Delegate)
-		: Manager(Manager)
-		, bSortByRecent(bInSortByRecent)
-		, Delegate(Delegate)
-	{}
+	explicit FLoadSlotInfosTask(const USaveManager* Manager, bool bInSortByRecent, const FOnSlotInfosLoaded& Delegate);
 
 	/** One info Constructor */
-	explicit FLoadSlotInfosTask(USaveManager* Manager, FName SlotName)
-		: Manager(Manager)
-		, SlotName(SlotName)
-	{}
+	explicit FLoadSlotInfosTask(USaveManager* Manager, FName SlotName);
+
+	void BindPromise(TSlotPromisePtr<TArray<USlotInfo*>> InPromise)
+	{
+		Promise = MoveTemp(InPromise);
+	}
 
+	/** Only reads files. Objects are not created on workers */
 	void DoWork();
 
-	/** Called after the task has finished */
+	/** Called on the game thread after the task has finished. Creates the infos */
 	void AfterFinish();
 
 	const TArray<USlotInfo*>& GetLoadedSlots() const
@@ -59,4 +72,9 @@ public:
 	{
 		RETURN_QUICK_DECLARE_CYCLE_STAT(FLoadAllSlotInfosTask, STATGROUP_ThreadPoolAsyncTasks);
 	}
+
+private:
+
+	void ReadSlots();
+	void CreateInfos();
 };
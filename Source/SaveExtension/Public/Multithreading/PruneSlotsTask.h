@@ -0,0 +1,61 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <Async/AsyncWork.h>
+
+#include "FileAdapter.h"
+
+
+class FSlotCache;
+
+/** Limits enforced by FPruneSlotsTask. Zero disables a limit */
+struct FSlotRetention
+{
+	int32 MaxSlots = 0;
+	FTimespan MaxAge = FTimespan::Zero();
+	int64 MaxBytes = 0;
+
+	bool IsEnabled() const
+	{
+		return MaxSlots > 0 || MaxAge > FTimespan::Zero() || MaxBytes > 0;
+	}
+};
+
+
+/**
+ * FPruneSlotsTask
+ * Async task deleting the oldest slots that don't fit a retention policy
+ */
+class FPruneSlotsTask : public FNonAbandonableTask
+{
+protected:
+
+	FSaveStorageRef Storage;
+	const FSlotRetention Retention;
+
+	/** Slot that is never deleted, usually the one just saved */
+	const FString KeptSlotName;
+
+	TSharedPtr<FSlotCache, ESPMode::ThreadSafe> Cache;
+
+public:
+
+	TArray<FString> DeletedSlots;
+
+
+	explicit FPruneSlotsTask(FSaveStorageRef InStorage, const FSlotRetention& InRetention, FName InKeptSlotName, const TSharedPtr<FSlotCache, ESPMode::ThreadSafe>& InCache)
+		: Storage(MoveTemp(InStorage))
+		, Retention(InRetention)
+		, KeptSlotName(InKeptSlotName.IsNone()? FString{} : InKeptSlotName.ToString())
+		, Cache(InCache)
+	{}
+
+	void DoWork();
+
+	FORCEINLINE TStatId GetStatId() const
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(FPruneSlotsTask, STATGROUP_ThreadPoolAsyncTasks);
+	}
+};
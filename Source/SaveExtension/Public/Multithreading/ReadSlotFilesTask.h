@@ -0,0 +1,47 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include "Multithreading/Delegates.h"
+#include "SlotCache.h"
+
+#include <Async/AsyncWork.h>
+#include <CoreMinimal.h>
+
+
+/**
+ * FReadSlotFilesTask
+ * Async task to read many slot files in parallel without creating any objects
+ */
+class FReadSlotFilesTask : public FNonAbandonableTask
+{
+protected:
+
+	FSaveStorageRef Storage;
+	TArray<FString> SlotNames;
+	const bool bSkipData = false;
+	TSharedPtr<FSlotCache, ESPMode::ThreadSafe> Cache;
+
+	TArray<FSharedSaveFile> Files;
+
+	FOnSlotFilesRead Delegate;
+
+
+public:
+
+	explicit FReadSlotFilesTask(FSaveStorageRef InStorage, const TArray<FName>& InSlotNames, bool bInSkipData,
+		TSharedPtr<FSlotCache, ESPMode::ThreadSafe> InCache, const FOnSlotFilesRead& Delegate);
+
+	void DoWork();
+
+	/** Called after the task has finished */
+	void AfterFinish()
+	{
+		Delegate.ExecuteIfBound(Files);
+	}
+
+	FORCEINLINE TStatId GetStatId() const
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(FReadSlotFilesTask, STATGROUP_ThreadPoolAsyncTasks);
+	}
+};
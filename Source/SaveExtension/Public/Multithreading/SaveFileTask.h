@@ -4,6 +4,7 @@
 
 #include <Async/AsyncWork.h>
 #include "FileAdapter.h"
+#include "SlotCache.h"
 
 
 /////////////////////////////////////////////////////
@@ -12,27 +13,42 @@
 class FSaveFileTask : public FNonAbandonableTask {
 protected:
 
+	FSaveStorageRef Storage;
 	USlotInfo* Info;
 	USlotData* Data;
 	const FString SlotName;
-	const bool bUseCompression;
+	const FSaveFileSettings Settings;
+
+	/** If valid, saved bytes will be kept in memory for fast reloads */
+	TSharedPtr<FSlotCache, ESPMode::ThreadSafe> Cache;
+
+	bool bSucceeded = false;
 
 public:
 
-	FSaveFileTask(USlotInfo* Info, USlotData* Data, const FString& InSlotName, const bool bInUseCompression) :
+	/** Called from the thread that wrote the file, as soon as it is written */
+	TUniqueFunction<void(bool bSuccess)> OnWritten;
+
+	FSaveFileTask(FSaveStorageRef InStorage, USlotInfo* Info, USlotData* Data, const FString& InSlotName, const FSaveFileSettings& InSettings,
+		TSharedPtr<FSlotCache, ESPMode::ThreadSafe> InCache = {}) :
+		Storage(MoveTemp(InStorage)),
 		Info(Info),
 		Data(Data),
 		SlotName(InSlotName),
-		bUseCompression(bInUseCompression)
+		Settings(InSettings),
+		Cache(MoveTemp(InCache))
 	{}
 
-	void DoWork()
-	{
-		FFileAdapter::SaveFile(SlotName, Info, Data, bUseCompression);
-	}
+	void DoWork();
+
+	bool IsSucceeded() const { return bSucceeded; }
 
 	FORCEINLINE TStatId GetStatId() const
 	{
 		RETURN_QUICK_DECLARE_CYCLE_STAT(FSaveFileTask, STATGROUP_ThreadPoolAsyncTasks);
 	}
+
+private:
+
+	bool Write();
 };
@@ -0,0 +1,47 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <Async/Future.h>
+#include <HAL/ThreadSafeBool.h>
+
+
+/**
+ * Promise shared between a save task and the threads that can complete it.
+ * Only the first value set is kept, so a task can resolve it from a worker thread and still
+ * resolve it again safely (e.g on failure or cancellation) when it finishes on the game thread.
+ */
+template<typename ResultType>
+class TSlotPromise
+{
+	TPromise<ResultType> Promise;
+	FThreadSafeBool bSet = false;
+
+public:
+
+	TFuture<ResultType> GetFuture()
+	{
+		return Promise.GetFuture();
+	}
+
+	/** @return true if this call resolved the promise */
+	bool SetValue(const ResultType& Value)
+	{
+		if (bSet.AtomicSet(true))
+		{
+			return false;
+		}
+		Promise.SetValue(Value);
+		return true;
+	}
+
+	bool IsSet() const
+	{
+		return bSet;
+	}
+};
+
+template<typename ResultType>
+using TSlotPromisePtr = TSharedPtr<TSlotPromise<ResultType>, ESPMode::ThreadSafe>;
+
@@ -0,0 +1,117 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <Async/AsyncWork.h>
+
+#include "FileAdapter.h"
+#include "Multithreading/CancelToken.h"
+
+
+class FSlotCache;
+class USaveManager;
+
+/** A slot saved with older versions, upgraded one at a time by the save manager */
+struct FOutdatedSlot
+{
+	FString SlotName;
+
+	/** Revision of the slot when it was read. The upgrade is dropped if it changed */
+	uint32 Revision = 0;
+	FSlotFileGeneration Generation;
+
+	/** Read in the old format, then serialized again in the current one */
+	FSaveFile File;
+};
+
+
+/**
+ * FUpgradeSlotsTask
+ * Async task finding slots saved with older versions. Only their headers are read.
+ * Slots found up to date are remembered and not read again while they don't change.
+ */
+class FUpgradeSlotsTask : public FNonAbandonableTask
+{
+protected:
+
+	const USaveManager* Manager;
+	FSaveStorageRef Storage;
+
+	/** Checked between slots, e.g to not delay shutdown */
+	FSECancelTokenPtr CancelToken;
+
+public:
+
+	TArray<FString> OutdatedSlots;
+
+
+	explicit FUpgradeSlotsTask(const USaveManager* InManager, FSECancelTokenPtr InCancelToken);
+
+	void DoWork();
+
+	/**
+	 * Creates the objects of a slot read by FUpgradeSlotFileTask and serializes them again with current versions.
+	 * Must be called on the game thread. Objects are taken from and given back to the pool if provided.
+	 * @return true if the slot can be written
+	 */
+	static bool Reserialize(const UObject* Outer, FOutdatedSlot& Slot, FSlotObjectPool* Pool = nullptr);
+
+	FORCEINLINE TStatId GetStatId() const
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(FUpgradeSlotsTask, STATGROUP_ThreadPoolAsyncTasks);
+	}
+};
+
+
+/**
+ * FUpgradeSlotFileTask
+ * Async task reading an outdated slot, or writing it back once upgraded.
+ * Each file is replaced only once its upgraded version was fully written, and only if no save wrote the slot meanwhile.
+ */
+class FUpgradeSlotFileTask : public FNonAbandonableTask
+{
+public:
+
+	enum class EMode : uint8
+	{
+		Read,
+		Write
+	};
+
+protected:
+
+	FSaveStorageRef Storage;
+	TSharedPtr<FOutdatedSlot, ESPMode::ThreadSafe> Slot;
+	const EMode Mode;
+	const FSaveFileSettings Settings;
+
+	TSharedPtr<FSlotCache, ESPMode::ThreadSafe> Cache;
+	FSECancelTokenPtr CancelToken;
+
+	bool bSucceeded = false;
+
+public:
+
+	FUpgradeSlotFileTask(FSaveStorageRef InStorage, TSharedPtr<FOutdatedSlot, ESPMode::ThreadSafe> InSlot, EMode InMode,
+		const FSaveFileSettings& InSettings, TSharedPtr<FSlotCache, ESPMode::ThreadSafe> InCache, FSECancelTokenPtr InCancelToken);
+
+	void DoWork();
+
+	bool IsSucceeded() const { return bSucceeded; }
+
+	FORCEINLINE TStatId GetStatId() const
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(FUpgradeSlotFileTask, STATGROUP_ThreadPoolAsyncTasks);
+	}
+
+private:
+
+	bool IsCancelled() const
+	{
+		return CancelToken.IsValid() && CancelToken->IsCancelled();
+	}
+
+	bool Read();
+	bool Write();
+};
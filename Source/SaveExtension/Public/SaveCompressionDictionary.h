@@ -0,0 +1,57 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <Engine/DataAsset.h>
+
+#include "SaveCompressionDictionary.generated.h"
+
+
+/**
+ * Compression dictionary trained from saved files and shipped with the project.
+ * Makes small files (sub-slots, shards) compress close to the ratio of big ones.
+ * Files compressed with a dictionary need it to be loaded, so keep old dictionaries referenced when replacing one.
+ */
+UCLASS(ClassGroup = SaveExtension, BlueprintType)
+class SAVEEXTENSION_API USaveCompressionDictionary : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Maximum size of the dictionary in bytes */
+	UPROPERTY(EditAnywhere, Category = Dictionary, meta = (ClampMin = "256", ClampMax = "32768"))
+	int32 MaxSize = 32 * 1024;
+
+	/** Id written in files compressed with this dictionary */
+	UPROPERTY(VisibleAnywhere, Category = Dictionary)
+	int64 Id = 0;
+
+	UPROPERTY(VisibleAnywhere, Category = Dictionary)
+	int32 NumSamples = 0;
+
+private:
+
+	UPROPERTY()
+	TArray<uint8> Bytes;
+
+
+public:
+
+	/** Trains the dictionary from all slot files currently saved */
+	UFUNCTION(CallInEditor, Category = Dictionary)
+	void TrainFromSavedSlots();
+
+	void Train(const TArray<TArray<uint8>>& Samples);
+
+	/** Registers the dictionary so that files using it can be loaded. @return its id */
+	uint32 Register() const;
+
+	const TArray<uint8>& GetBytes() const
+	{
+		return Bytes;
+	}
+
+	virtual void PostLoad() override;
+};
@@ -7,17 +7,25 @@
 #include "LatentActions/LoadGameAction.h"
 #include "LatentActions/SaveGameAction.h"
 #include "LevelStreamingNotifier.h"
+#include "Misc/SaveEventSubscribers.h"
 #include "Multithreading/ScopedTaskManager.h"
+#include "Multithreading/CancelToken.h"
 #include "Multithreading/Delegates.h"
+#include "Multithreading/SlotPromise.h"
 #include "SaveExtensionInterface.h"
 #include "SavePreset.h"
+#include "Serialization/ChunkedActorSerializer.h"
 #include "Serialization/SlotDataTask.h"
+#include "Serialization/SnapshotBuffer.h"
+#include "SlotCache.h"
 #include "SlotData.h"
 #include "SlotInfo.h"
+#include "SlotObjectPool.h"
 
 #include <Async/AsyncWork.h>
 #include <CoreMinimal.h>
 #include <Engine/GameInstance.h>
+#include <Engine/World.h>
 #include <GenericPlatform/GenericPlatformFile.h>
 #include <HAL/PlatformFilemanager.h>
 #include <Subsystems/GameInstanceSubsystem.h>
@@ -28,9 +36,14 @@
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnGameSavedMC, USlotInfo*, SlotInfo);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnGameLoadedMC, USlotInfo*, SlotInfo);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnLoadRadiusCompleteMC, USlotInfo*, SlotInfo);
 
 
 struct FLatentActionInfo;
+class AController;
+class AGameModeBase;
+class APlayerState;
+struct FOutdatedSlot;
 
 USTRUCT(BlueprintType)
 struct FScreenshotSize
@@ -86,15 +99,68 @@ private:
 
 	FScopedTaskList MTTasks;
 
+	/** Recently saved or loaded slots kept in memory. Shared with file tasks */
+	TSharedPtr<FSlotCache, ESPMode::ThreadSafe> SlotCache;
+
+	/** Reusable info and data objects. Shared with file tasks */
+	TSharedPtr<FSlotObjectPool, ESPMode::ThreadSafe> ObjectPool;
+
+	/** Actors of the current world that were large when last saved. Shared with serialization tasks */
+	TSharedPtr<FLargeActorSizes, ESPMode::ThreadSafe> LargeActorSizes;
+
+	/** In-memory world snapshots used for rewinding */
+	FSnapshotBuffer Snapshots;
+
+	/** Backend where the slots of this manager are stored. Shared with file tasks */
+	FSaveStorageRef Storage;
+
+	/** Storage type last applied from the preset */
+	TOptional<ESaveStorage> AppliedStorage;
+
 	UPROPERTY(Transient)
 	TArray<ULevelStreamingNotifier*> LevelStreamingNotifiers;
 
-	UPROPERTY(Transient)
-	TArray<TScriptInterface<ISaveExtensionInterface>> SubscribedInterfaces;
+	/** Referenced through AddReferencedObjects */
+	FSaveEventSubscribers Subscribers;
 
 	UPROPERTY(Transient)
 	TArray<USlotDataTask*> Tasks;
 
+	/** A sub-slot file written in the background. Info and Data are rooted until it is written */
+	struct FSubSlotWrite
+	{
+		USlotInfo* Info = nullptr;
+		USlotData* Data = nullptr;
+		FName SubSlotName;
+		FSaveFileSettings Settings;
+		FOnGameSaved OnSaved;
+	};
+
+	/** Sub-slots being written by background file tasks */
+	TSet<FName> SubSlotWrites;
+
+	/** Writes waiting for a previous write of the same sub-slot to finish */
+	TArray<FSubSlotWrite> QueuedSubSlotWrites;
+
+	/** Seconds since the world shard was last saved automatically */
+	float WorldShardTime = 0.f;
+
+	/** True while old slots are being deleted in the background */
+	bool bPruningSlots = false;
+
+	/** Valid while outdated slots are being upgraded in the background */
+	FSECancelTokenPtr UpgradeCancelToken;
+
+	/** Outdated slots waiting to be upgraded, one at a time */
+	TArray<FString> OutdatedSlots;
+
+	/** Slot read and upgraded on the game thread, waiting to be written */
+	TSharedPtr<FOutdatedSlot, ESPMode::ThreadSafe> UpgradedSlot;
+
+	/** True while a background task of the upgrade is running */
+	bool bUpgradeTaskRunning = false;
+	int32 UpgradedSlotsCount = 0;
+
 
 	/************************************************************************/
 	/* METHODS											     			    */
@@ -109,6 +175,8 @@ public:
 	virtual void Deinitialize() override;
 	/** End USubsystem */
 
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+
 	void SetGameInstance(UGameInstance* GameInstance)
 	{
 		OwningGameInstance = GameInstance;
@@ -128,6 +196,16 @@ public:
 	bool SaveSlot(int32 SlotId, bool bOverrideIfNeeded = true, bool bScreenshot = false,
 		const FScreenshotSize Size = {}, FOnGameSaved OnSaved = {});
 
+	/**
+	 * Save the Game into an specified slot name
+	 * @return a future resolved with the saved info, or null if saving failed. It is resolved from the worker
+	 * thread that wrote the file, or once the thumbnail is ready if one was requested
+	 * Don't call Get() on the game thread while other save or load tasks are queued. Tasks run one at a time
+	 * starting from the game thread, so this save never starts and Get() blocks forever
+	 */
+	TFuture<USlotInfo*> SaveSlotAsync(FName SlotName, bool bOverrideIfNeeded = true, bool bScreenshot = false,
+		const FScreenshotSize Size = {});
+
 	/** Save the currently loaded Slot */
 	bool SaveCurrentSlot(bool bScreenshot = false, const FScreenshotSize Size = {}, FOnGameSaved OnSaved = {});
 
@@ -141,6 +219,12 @@ public:
 	/** Load game from a SlotInfo */
 	bool LoadSlot(const USlotInfo* SlotInfo, FOnGameLoaded OnLoaded = {});
 
+	/**
+	 * Load game from a file name
+	 * @return a future resolved on the game thread with the loaded info, or null if loading failed
+	 */
+	TFuture<USlotInfo*> LoadSlotAsync(FName SlotName);
+
 	/** Reload the currently loaded slot if any */
 	bool ReloadCurrentSlot(FOnGameLoaded OnLoaded = {})
 	{
@@ -155,14 +239,124 @@ public:
 	void LoadAllSlotInfos(bool bSortByRecent, FOnSlotInfosLoaded Delegate);
 	void LoadAllSlotInfosSync(bool bSortByRecent, FOnSlotInfosLoaded Delegate);
 
+	/**
+	 * Find all saved games and return their SlotInfos
+	 * @return a future resolved on the game thread once infos are loaded and safe to use
+	 */
+	TFuture<TArray<USlotInfo*>> LoadAllSlotInfosAsync(bool bSortByRecent);
+
+	/**
+	 * Read many slot files in parallel without creating any objects. Files can be inspected from any thread
+	 * and turned into objects on the game thread with CreateAndDeserializeInfo/Data.
+	 * @param bSkipData if true, only slot infos are read
+	 */
+	void ReadSlotFiles(const TArray<FName>& SlotNames, bool bSkipData, FOnSlotFilesRead Delegate);
+
+	/**
+	 * Read slots into the slot cache in the background, so that loading them later doesn't touch disk.
+	 * Only as many slots as 'CachedSlots' allows will be kept
+	 */
+	void PreloadSlots(const TArray<FName>& SlotNames)
+	{
+		ReadSlotFiles(SlotNames, false, {});
+	}
+
 	/** Delete a saved game on an specified slot name
 	 * Performance: Interacts with disk, can be slow
 	 */
 	bool DeleteSlot(FName SlotName);
 
+	/**
+	 * Restore the world from an in-memory snapshot
+	 * @param Index of the snapshot. 0 is the oldest
+	 * @param bDiscardNewer if true, snapshots taken after this one will be removed
+	 */
+	bool RestoreSnapshot(int32 Index, bool bDiscardNewer = true, FOnGameLoaded OnLoaded = {});
+
+	/** Restore the snapshot closest to a game time in seconds */
+	bool RestoreSnapshotAt(float TimeSeconds, bool bDiscardNewer = true, FOnGameLoaded OnLoaded = {})
+	{
+		return RestoreSnapshot(Snapshots.FindClosest(TimeSeconds), bDiscardNewer, MoveTemp(OnLoaded));
+	}
+
+	FSnapshotBuffer& GetSnapshots()
+	{
+		return Snapshots;
+	}
+
+	/**
+	 * Save only the provided actors into a sub-slot. The rest of the world is not serialized.
+	 * Sub-slots don't replace the current slot and are not listed with other slots.
+	 * Performance: Cost depends on the number of actors, not on the size of the world
+	 */
+	bool SaveActors(FName SubSlotName, const TArray<AActor*>& Actors, FOnGameSaved OnSaved = {});
+
+	/** Save all actors with a tag into a sub-slot */
+	bool SaveActorsWithTag(FName SubSlotName, FName Tag, FOnGameSaved OnSaved = {});
+
+	/** Save all actors allowed by a class filter into a sub-slot */
+	bool SaveActorsOfClass(FName SubSlotName, const FSEActorClassFilter& Filter, FOnGameSaved OnSaved = {});
+
+	/**
+	 * Load the actors saved in a sub-slot. Other actors are not touched. Saved actors missing from the world are skipped.
+	 * Sub-slots can only be loaded in the map they were saved
+	 */
+	bool LoadActors(FName SubSlotName, FOnGameLoaded OnLoaded = {});
+
+	/**
+	 * Save the shard of a player: all actors it owns (see FSaveShards::GetOwnerId).
+	 * Shards are sub-slots, so they can be saved and loaded independently of each other
+	 */
+	bool SavePlayerShard(const APlayerState* Player, FOnGameSaved OnSaved = {});
+
+	/** Load the shard of a player. Its actors are matched by owner and class, since their names change between sessions */
+	bool LoadPlayerShard(const APlayerState* Player, FOnGameLoaded OnLoaded = {});
+
+	/** Save the shard of the world: all actors not owned by any player */
+	bool SaveWorldShard(FOnGameSaved OnSaved = {});
+
+	bool LoadWorldShard(FOnGameLoaded OnLoaded = {});
+
+	/** Save the world shard and the shards of all players, visiting actors only once */
+	bool SaveAllShards();
+
+	/**
+	 * Writes a sub-slot file in the background without blocking other tasks.
+	 * Writes of the same sub-slot happen in order. Info and Data are kept alive until the file is written
+	 */
+	void WriteSubSlotFile(USlotInfo* Info, USlotData* Data, FName SubSlotName, FOnGameSaved OnSaved);
+
+	/** @return true while a sub-slot file is being written in the background or waits to be */
+	bool IsWritingSubSlot(FName SubSlotName) const
+	{
+		return SubSlotWrites.Contains(SubSlotName) || QueuedSubSlotWrites.ContainsByPredicate([SubSlotName](const FSubSlotWrite& Write) {
+			return Write.SubSlotName == SubSlotName;
+		});
+	}
+
 	/** Delete all saved slots from disk, loaded or not */
 	void DeleteAllSlots(FOnSlotsDeleted Delegate);
 
+	/** Deletes in the background the oldest slots that exceed the retention limits of the preset
+	 * (MaxSlots, MaxSlotAgeDays and MaxSlotsSizeMB). Done automatically after each save if bPruneSlots is checked
+	 * @param KeptSlotName slot that is never deleted, usually the one just saved
+	 */
+	void PruneSlots(FName KeptSlotName = {});
+
+	/** Rewrites in the background the slots saved with older versions, so that loading them is faster.
+	 * Done automatically at startup and when slots are listed if bUpgradeSlots is checked
+	 */
+	void UpgradeSlots();
+
+	/** @return true while outdated slots are being upgraded */
+	bool IsUpgradingSlots() const
+	{
+		return UpgradeCancelToken.IsValid();
+	}
+
+	/** Cancel a save or load task. Fails if the task already reached a point where it can't be stopped */
+	bool CancelTask(USlotDataTask* Task);
+
 
 	/** BLUEPRINT ONLY API */
 public:
@@ -250,6 +444,34 @@ public:
 			DisplayName = "Delete All Slots"))
 	void BPDeleteAllSlots(EDeleteSlotsResult& Result, FLatentActionInfo LatentInfo);
 
+	/**
+	 * Take an in-memory snapshot of the world. Doesn't touch disk.
+	 * Only the last 'MaxSnapshots' snapshots are kept
+	 * @return true if the snapshot was taken or scheduled
+	 */
+	UFUNCTION(BlueprintCallable, Category = "SaveExtension|Snapshots")
+	bool TakeSnapshot();
+
+	/**
+	 * Cancel all pending saves and loads, and running loads that didn't start deserializing yet.
+	 * Cancelled tasks notify their delegates as failed
+	 * @return number of tasks cancelled
+	 */
+	UFUNCTION(BlueprintCallable, Category = "SaveExtension")
+	int32 CancelAllTasks();
+
+	UFUNCTION(BlueprintPure, Category = "SaveExtension|Snapshots")
+	int32 GetNumSnapshots() const
+	{
+		return Snapshots.Num();
+	}
+
+	UFUNCTION(BlueprintCallable, Category = "SaveExtension|Snapshots")
+	void ClearSnapshots()
+	{
+		Snapshots.Empty();
+	}
+
 	UFUNCTION(BlueprintPure, Category = "SaveExtension")
 	USavePreset* BPGetPreset() const
 	{
@@ -344,9 +566,39 @@ public:
 
 	void __SetCurrentData(USlotData* NewData)
 	{
+		// The previous data is never pooled. Queued tasks and blueprints may still reference it
 		CurrentData = NewData;
 	}
 
+	const TSharedPtr<FSlotCache, ESPMode::ThreadSafe>& GetSlotCache() const
+	{
+		return SlotCache;
+	}
+
+	const TSharedPtr<FSlotObjectPool, ESPMode::ThreadSafe>& GetObjectPool() const
+	{
+		return ObjectPool;
+	}
+
+	const TSharedPtr<FLargeActorSizes, ESPMode::ThreadSafe>& GetLargeActorSizes() const
+	{
+		return LargeActorSizes;
+	}
+
+	const FSaveStorageRef& GetStorage() const
+	{
+		return Storage;
+	}
+
+	/** Compression and encryption of the active preset. Taken by each write when it starts */
+	FSaveFileSettings GetFileSettings() const;
+
+	/**
+	 * Stores slots of this manager in a custom backend. Other managers are not affected.
+	 * Kept until the storage type of the preset changes. Tasks already started keep using the previous backend
+	 */
+	void SetStorage(FSaveStorageRef InStorage);
+
 	USlotInfo* LoadInfo(FName SlotName);
 	USlotInfo* LoadInfo(uint32 SlotId)
 	{
@@ -364,10 +616,15 @@ private:
 	void SerializeStreamingLevel(ULevelStreaming* LevelStreaming);
 	UFUNCTION()
 	void DeserializeStreamingLevel(ULevelStreaming* LevelStreaming);
+	UFUNCTION()
+	void CaptureStreamingLevelBaselines(ULevelStreaming* LevelStreaming);
 	//~ End LevelStreaming
 
 	void OnLevelLoaded(ULevelStreaming* StreamingLevel) {}
 
+	/** Remembers instanced components of a level so that only their changes get saved */
+	void CaptureInstanceBaselines(const ULevel* Level) const;
+
 	USlotDataTask* CreateTask(TSubclassOf<USlotDataTask> TaskType);
 
 	template <class TaskType>
@@ -378,6 +635,24 @@ private:
 
 	void FinishTask(USlotDataTask* Task);
 
+	void StartSubSlotWrite(FSubSlotWrite&& Write);
+	void StartQueuedSubSlotWrites();
+
+	/** Advances the upgrade of outdated slots by one step. Objects are only created on the game thread */
+	void UpgradeNextSlot();
+	void FinishUpgradingSlots();
+
+	/** Cancels all tasks made redundant by NewTask */
+	void SupersedeTasks(const USlotDataTask* NewTask);
+
+	/** Selects the storage backend of the active preset */
+	void UpdateStorage();
+
+	/** Saving and loading can report to a delegate, a promise or both */
+	bool StartSaving(FName SlotName, bool bOverrideIfNeeded, bool bScreenshot, const FScreenshotSize Size,
+		FOnGameSaved OnSaved, TSlotPromisePtr<USlotInfo*> Promise);
+	bool StartLoading(FName SlotName, FOnGameLoaded OnLoaded, TSlotPromisePtr<USlotInfo*> Promise);
+
 public:
 	bool HasTasks() const
 	{
@@ -416,6 +691,11 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = SaveExtension)
 	FOnGameLoadedMC OnGameLoaded;
 
+	/** Called during progressive loads once actors around the player are restored.
+	 * Gameplay can resume while the rest of the world keeps loading */
+	UPROPERTY(BlueprintAssignable, Category = SaveExtension)
+	FOnLoadRadiusCompleteMC OnLoadRadiusComplete;
+
 
 	/** Subscribe to receive save and load events on an Interface */
 	UFUNCTION(Category = SaveExtension, BlueprintCallable)
@@ -425,16 +705,17 @@ public:
 	UFUNCTION(Category = SaveExtension, BlueprintCallable)
 	void UnsubscribeFromEvents(const TScriptInterface<ISaveExtensionInterface>& Interface);
 
-	void OnSaveBegan(const FSELevelFilter& Filter);
-	void OnSaveFinished(const FSELevelFilter& Filter, const bool bError);
-	void OnLoadBegan(const FSELevelFilter& Filter);
-	void OnLoadFinished(const FSELevelFilter& Filter, const bool bError);
+	/** Events are sent to all subscribers. If a level is provided, only subscribers in that level are notified */
+	void OnSaveBegan(const FSELevelFilter& Filter, const ULevel* Level = nullptr);
+	void OnSaveFinished(const FSELevelFilter& Filter, const bool bError, const ULevel* Level = nullptr);
+	void OnLoadBegan(const FSELevelFilter& Filter, const ULevel* Level = nullptr);
+	void OnLoadFinished(const FSELevelFilter& Filter, const bool bError, const ULevel* Level = nullptr);
 
 private:
 	void OnMapLoadStarted(const FString& MapName);
 	void OnMapLoadFinished(UWorld* LoadedWorld);
-
-	void IterateSubscribedInterfaces(TFunction<void(UObject*)>&& Callback);
+	void OnWorldActorsInitialized(const UWorld::FActorsInitializedParams& Params);
+	void OnLogout(AGameModeBase* GameMode, AController* Exiting);
 
 
 	/***********************************************************************/
@@ -554,17 +835,6 @@ inline bool USaveManager::IsValidSlot(const int32 Slot) const
 	return GetPreset()->IsValidId(Slot);
 }
 
-inline void USaveManager::IterateSubscribedInterfaces(TFunction<void(UObject*)>&& Callback)
-{
-	for (const TScriptInterface<ISaveExtensionInterface>& Interface : SubscribedInterfaces)
-	{
-		if (UObject* const Object = Interface.GetObject())
-		{
-			Callback(Object);
-		}
-	}
-}
-
 inline USaveManager* USaveManager::Get(const UObject* Context)
 {
 	UWorld* World = GEngine->GetWorldFromContextObject(Context, EGetWorldErrorMode::LogAndReturnNull);
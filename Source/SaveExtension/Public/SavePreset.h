@@ -21,6 +21,20 @@ enum class ESaveASyncMode : uint8 {
 	SaveAndLoadAsync
 };
 
+/**
+* Where slots are stored
+*/
+UENUM()
+enum class ESaveStorage : uint8 {
+	/** One file per slot */
+	Files,
+	/** All slots inside a single indexed file */
+	PackedFile,
+	/** Slots are only kept in memory. Useful for tests and benchmarks */
+	Memory
+};
+
+class USaveCompressionDictionary;
 class USlotInfo;
 class USlotData;
 
@@ -51,6 +65,27 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Gameplay, meta = (ClampMin = "0"))
 	int32 MaxSlots = 0;
 
+	/** If checked, the oldest slots are deleted on the background after each save
+	 * to respect MaxSlots, MaxSlotAgeDays and MaxSlotsSizeMB. The slot just saved is never deleted
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
+	bool bPruneSlots = false;
+
+	/** Slots older than this many days are deleted. 0 keeps them forever */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (ClampMin = "0", EditCondition = "bPruneSlots"))
+	int32 MaxSlotAgeDays = 0;
+
+	/** Oldest slots are deleted while all slots together take more than this many megabytes. 0 disables the limit */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (ClampMin = "0", EditCondition = "bPruneSlots"))
+	int32 MaxSlotsSizeMB = 0;
+
+	/** If checked, slots saved with older versions are rewritten in the current format on the background
+	 * at startup and when slots are listed, so that later loads don't go through version upgrades.
+	 * Rewriting slots costs disk writes and old versions are lost, so it is opt-in
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
+	bool bUpgradeSlots = false;
+
 	/** If checked, will attempt to Save Game to first Slot found, timed event. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
 	bool bAutoSave = true;
@@ -88,6 +123,33 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Serialization)
 	bool bUseCompression = true;
 
+	/** Dictionary used to compress files. Improves compression of small files like sub-slots.
+	 * Files saved with a dictionary can't be loaded without it
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Serialization, meta = (EditCondition = "bUseCompression"))
+	USaveCompressionDictionary* CompressionDictionary = nullptr;
+
+	/** If true slot data will be encrypted with the key provided to FSaveEncryption::SetKey.
+	 * Saving fails while there is no key. Slot infos are not encrypted so that slots can be listed without it
+	 * Performance: Close to a memory copy on CPUs with AES instructions
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Serialization)
+	bool bEncryptData = false;
+
+	/** Where slots are stored. Packed files avoid opening one file per slot on platforms with slow small-file I/O */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Serialization)
+	ESaveStorage Storage = ESaveStorage::Files;
+
+	/** Amount of recently saved or loaded slots kept in memory.
+	 * Loading a cached slot skips disk access and decompression. 0 disables the cache
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Serialization, meta = (ClampMin = "0"))
+	int32 CachedSlots = 1;
+
+	/** Maximum memory in megabytes that cached slots can use */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Serialization, meta = (ClampMin = "0", EditCondition = "CachedSlots > 0"))
+	int32 MaxSlotCacheMB = 64;
+
 	/** If true will store the game instance */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Serialization)
 	bool bStoreGameInstance = true;
@@ -116,12 +178,32 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Serialization|Components", meta = (EditCondition = "bUseLoadComponentFilter"))
 	FSEComponentClassFilter LoadComponentFilter;
 
+	/** Amount of in-memory world snapshots kept for rewinding. Older snapshots are discarded
+	 * Snapshots are delta-encoded against the previous one to reduce memory usage
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Snapshots, meta = (ClampMin = "0"))
+	int32 MaxSnapshots = 32;
+
+	/** Seconds between automatic saves of the world shard (actors not owned by any player). 0 disables them */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Shards, meta = (ClampMin = "0"))
+	float WorldShardInterval = 0.f;
+
+	/** If true, the shard of a player is saved when it logs out */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Shards)
+	bool bSavePlayerShardOnLogout = false;
+
 public:
 
 	/** Serialization will be multi-threaded between all available cores. */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Asynchronous")
 	ESaveASyncMode MultithreadedSerialization = ESaveASyncMode::SaveAsync;
 
+	/** Actors that took at least this many KB on their last save get their big SaveGame arrays and maps
+	 * serialized in parallel chunks. 0 disables it
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Asynchronous", meta = (ClampMin = "0", Units = "KB"))
+	int32 LargeActorKB = 1024;
+
 	/** Split serialization between multiple frames. Ignored if MultithreadedSerialization is used
 	 * Currently only implemented on Loading
 	 */
@@ -137,10 +219,24 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Asynchronous", meta = (UIMin="3", UIMax="10"))
 	float MaxFrameMs = 5.f;
 
+	/** Frame-splitted loads restore actors closest to the player first, ordered by their saved location */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Asynchronous")
+	bool bProgressiveLoading = false;
+
+	/** 'OnLoadRadiusComplete' is called once all actors inside this distance of the player have been restored */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Asynchronous", meta = (EditCondition = "bProgressiveLoading", ClampMin = "0"))
+	float ProgressiveLoadRadius = 5000.f;
+
 	/** Files will be loaded or saved on a secondary thread while game continues */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Asynchronous")
 	ESaveASyncMode MultithreadedFiles = ESaveASyncMode::SaveAndLoadAsync;
 
+	/** If true, a new load cancels older loads that didn't start deserializing yet,
+	 * and a new save cancels pending saves to the same slot.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Asynchronous")
+	bool bSupersedeTasks = true;
+
 
 protected:
 
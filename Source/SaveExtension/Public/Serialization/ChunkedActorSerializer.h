@@ -0,0 +1,55 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <HAL/CriticalSection.h>
+#include <UObject/ObjectKey.h>
+
+class AActor;
+
+
+/**
+ * Serializes actors holding huge SaveGame arrays or maps.
+ * Big containers are split in chunks serialized in parallel, and the rest of the actor is serialized as usual.
+ *
+ * Data layout: Magic, big containers (name, chunks), then the regular actor bytes
+ */
+struct SAVEEXTENSION_API FChunkedActorSerializer
+{
+	/** Containers with less elements are serialized with the rest of the actor */
+	static constexpr int32 MinChunkElements = 4096;
+
+
+	/** @return true if the actor had big containers and was written in chunks. Thread-safe */
+	static bool Save(AActor* Actor, TArray<uint8>& OutData);
+
+	/**
+	 * @return true if Data was written in chunks and has been loaded. Game thread only.
+	 * Containers referencing objects are loaded on the calling thread.
+	 * Chunked data that is corrupted returns false and is not loaded further.
+	 */
+	static bool Load(AActor* Actor, const TArray<uint8>& Data);
+
+	static bool IsChunked(const TArray<uint8>& Data);
+};
+
+
+/**
+ * Sizes of the actors that were large the last time they were saved. Each save manager has its own.
+ * Thread-safe
+ */
+class SAVEEXTENSION_API FLargeActorSizes
+{
+	mutable FCriticalSection Lock;
+	TMap<FObjectKey, int32> Sizes;
+
+public:
+
+	/** @return true if the actor took at least MinBytes last time it was saved */
+	bool IsLarge(const AActor* Actor, int32 MinBytes) const;
+	void RecordSize(const AActor* Actor, int32 Bytes, int32 MinBytes);
+
+	/** Forgets all actors. Call it when their world is unloaded */
+	void Empty();
+};
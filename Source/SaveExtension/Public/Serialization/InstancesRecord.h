@@ -0,0 +1,76 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <Containers/BitArray.h>
+#include <HAL/CriticalSection.h>
+#include <Templates/SharedPointer.h>
+#include <UObject/ObjectKey.h>
+
+class ULevel;
+class UInstancedStaticMeshComponent;
+struct FSELevelFilter;
+
+
+using FInstancesBaseline = TSharedPtr<const TArray<FMatrix>, ESPMode::ThreadSafe>;
+
+/**
+ * Instances of each instanced static mesh (and foliage) component as they were when its level was loaded.
+ * Instance records only store the changes from these instances.
+ * Thread-safe.
+ */
+class SAVEEXTENSION_API FInstanceBaselines
+{
+	static FCriticalSection Lock;
+	static TMap<FObjectKey, FInstancesBaseline> Baselines;
+
+public:
+
+	/** Captures all instanced components of a level that pass the filter. Call it before its actors begin play */
+	static void CaptureLevel(const ULevel* Level, const FSELevelFilter& Filter);
+
+	/** @return the baseline of a component. Captured from its current instances if it didn't exist */
+	static FInstancesBaseline FindOrCapture(const UInstancedStaticMeshComponent* Component);
+
+private:
+
+	static FInstancesBaseline Capture(const UInstancedStaticMeshComponent* Component);
+};
+
+
+/**
+ * Compact changes of an instanced static mesh component from its baseline.
+ * Removed instances are stored as a bitset, modified ones as a list of deltas.
+ */
+struct SAVEEXTENSION_API FInstancesRecord
+{
+	int32 NumBaseInstances = 0;
+
+	/** One bit per baseline instance. Empty if none was removed */
+	TBitArray<> Removed;
+
+	/** Baseline indices of moved instances and their new local transforms */
+	TArray<int32> ModifiedIndices;
+	TArray<FTransform> ModifiedTransforms;
+
+	/** Instances that didn't exist in the baseline */
+	TArray<FTransform> AddedTransforms;
+
+
+	/** Fills this record with the differences between the component and its baseline */
+	void Capture(const UInstancedStaticMeshComponent* Component);
+
+	/**
+	 * Applies all changes in bulk. Instances that differ from the baseline are restored first
+	 * @return false if the baseline doesn't match the one this record was saved from
+	 */
+	bool Apply(UInstancedStaticMeshComponent* Component) const;
+
+	bool HasChanges() const
+	{
+		return Removed.Num() > 0 || ModifiedIndices.Num() > 0 || AddedTransforms.Num() > 0;
+	}
+
+	friend FArchive& operator<<(FArchive& Ar, FInstancesRecord& Record);
+};
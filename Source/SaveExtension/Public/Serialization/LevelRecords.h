@@ -25,9 +25,12 @@ struct FLevelRecord : public FBaseRecord
 	/** Record of the Level Script Actor */
 	FActorRecord LevelScript;
 
-	/** Records of the World Actors */
+	/** Records of the World Actors. Saved in canonical order (see FRecordOrder) */
 	TArray<FActorRecord> Actors;
 
+	/** True if Actors are in canonical order and can be binary searched. Older files may not be */
+	bool bSortedActors = false;
+
 
 	FLevelRecord() : Super() {}
 
@@ -36,6 +39,15 @@ struct FLevelRecord : public FBaseRecord
 	bool IsValid() const { return !Name.IsNone(); }
 
 	void CleanRecords();
+
+	/** Sorts actor records in canonical order */
+	void SortActors();
+
+	/** Checks again if actor records are sorted, after they were modified */
+	void UpdateSortedActors();
+
+	/** @return the record of an actor. O(log n) if records are sorted */
+	const FActorRecord* FindActorRecord(const AActor* Actor) const;
 };
 
 
@@ -12,8 +12,10 @@
 #include "SavePreset.h"
 
 #include "MTTask.h"
+#include "Serialization/ChunkedActorSerializer.h"
 #include "Serialization/Records.h"
 #include "Serialization/LevelRecords.h"
+#include "Serialization/PhysicsSnapshot.h"
 
 
 class USlotData;
@@ -37,6 +39,15 @@ class FMTTask_SerializeActors : public FMTTask
 	/** USE ONLY FOR DUMPING DATA */
 	FLevelRecord* LevelRecord = nullptr;
 
+	/** Physics state captured before the task started. Optional */
+	const FPhysicsSnapshot* Physics = nullptr;
+
+	/** Actors of at least this size are serialized in parallel chunks. 0 disables it */
+	const int32 LargeActorBytes = 0;
+
+	/** Sizes of large actors, owned by the save manager */
+	const TSharedPtr<FLargeActorSizes, ESPMode::ThreadSafe> LargeActors;
+
 	FActorRecord LevelScriptRecord;
 	TArray<FActorRecord> ActorRecords;
 
@@ -44,13 +55,17 @@ class FMTTask_SerializeActors : public FMTTask
 public:
 	FMTTask_SerializeActors(const UWorld* World, USlotData* SlotData,
 		const TArray<AActor*>* const InLevelActors, const int32 InStartIndex, const int32 InNum, bool bStoreGameInstance,
-		FLevelRecord* InLevelRecord, const FSELevelFilter& Filter)
+		FLevelRecord* InLevelRecord, const FSELevelFilter& Filter, const FPhysicsSnapshot* InPhysics = nullptr,
+		int32 InLargeActorBytes = 0, TSharedPtr<FLargeActorSizes, ESPMode::ThreadSafe> InLargeActors = {})
 		: FMTTask(false, World, SlotData, Filter)
 		, LevelActors(InLevelActors)
 		, StartIndex(InStartIndex)
 		, Num(InNum)
 		, bStoreGameInstance(bStoreGameInstance)
 		, LevelRecord(InLevelRecord)
+		, Physics(InPhysics)
+		, LargeActorBytes(InLargeActors.IsValid()? InLargeActorBytes : 0)
+		, LargeActors(MoveTemp(InLargeActors))
 		, LevelScriptRecord{}
 		, ActorRecords{}
 	{
@@ -60,6 +75,17 @@ public:
 
 	void DoWork();
 
+	/** Adds the actors of this task to a physics snapshot. Game thread only */
+	void GatherPhysics(FPhysicsSnapshot& Snapshot) const
+	{
+		Snapshot.Gather(*LevelActors, StartIndex, Num, Filter);
+	}
+
+	FLevelRecord* GetLevelRecord() const
+	{
+		return LevelRecord;
+	}
+
 	/** Called after task has completed to recover resulting information */
 	void DumpData() {
 		if (LevelScriptRecord.IsValid())
@@ -0,0 +1,73 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <HAL/CriticalSection.h>
+#include <Templates/Function.h>
+#include <UObject/ObjectKey.h>
+
+
+/**
+ * Specialize to provide a hand-written serializer for a class, then register it with FNativeSerializers::Register<T>().
+ *
+ * template<>
+ * struct TNativeSerializer<ANPC>
+ * {
+ *     static void Serialize(ANPC& NPC, FArchive& Ar) { Ar << NPC.Health << NPC.Inventory; }
+ * };
+ */
+template<typename T>
+struct TNativeSerializer;
+
+
+/**
+ * Per-class table of serializers that replace reflection based serialization of actors and components.
+ * A serializer also applies to child classes (including blueprints), which then don't serialize their own SaveGame
+ * properties. Serializers can be called from any thread while saving.
+ * Register them on module startup. Thread-safe.
+ */
+class SAVEEXTENSION_API FNativeSerializers
+{
+public:
+
+	using FSerializer = TFunction<void(UObject&, FArchive&)>;
+
+private:
+
+	static FRWLock Lock;
+	static TMap<const UClass*, TSharedPtr<const FSerializer, ESPMode::ThreadSafe>> Serializers;
+
+	/** Resolved serializer of each class, including classes without one */
+	static TMap<FObjectKey, TSharedPtr<const FSerializer, ESPMode::ThreadSafe>> ClassCache;
+
+public:
+
+	static void Register(const UClass* Class, FSerializer&& Serializer);
+	static void Unregister(const UClass* Class);
+
+	/** Registers the serializer provided by TNativeSerializer<T> */
+	template<typename T>
+	static void Register()
+	{
+		Register<T>(&TNativeSerializer<T>::Serialize);
+	}
+
+	template<typename T, typename FunctionType>
+	static void Register(FunctionType&& Function)
+	{
+		Register(T::StaticClass(), [Function = Forward<FunctionType>(Function)](UObject& Object, FArchive& Ar)
+		{
+			Function(static_cast<T&>(Object), Ar);
+		});
+	}
+
+	template<typename T>
+	static void Unregister()
+	{
+		Unregister(T::StaticClass());
+	}
+
+	/** @return the serializer of a class or its closest parent. Null if none */
+	static TSharedPtr<const FSerializer, ESPMode::ThreadSafe> Find(const UClass* Class);
+};
@@ -0,0 +1,52 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+
+class AActor;
+class UPrimitiveComponent;
+class UWorld;
+struct FSELevelFilter;
+
+
+/** Rigid body state of the root of an actor */
+struct FActorPhysicsState
+{
+	FTransform Transform;
+	FVector LinearVelocity = FVector::ZeroVector;
+	FVector AngularVelocity = FVector::ZeroVector;
+	bool bSleeping = false;
+	bool bKinematic = false;
+};
+
+
+/**
+ * Physics state of all actors being saved, read in one pass under a single physics scene lock.
+ * Filled on the game thread before serialization tasks start. Tasks only read from it.
+ */
+class FPhysicsSnapshot
+{
+	TArray<const AActor*> PendingActors;
+	TMap<const AActor*, FActorPhysicsState> States;
+
+public:
+
+	/** Adds actors to be captured if they store physics */
+	void Gather(const TArray<AActor*>& Actors, int32 StartIndex, int32 Num, const FSELevelFilter& Filter);
+
+	/** Reads the state of all gathered actors at once */
+	void Capture(const UWorld* World);
+
+	/** @return the captured state of an actor. Null if it doesn't simulate physics */
+	const FActorPhysicsState* Find(const AActor* Actor) const
+	{
+		return States.Find(Actor);
+	}
+
+	void Reset()
+	{
+		PendingActors.Reset();
+		States.Reset();
+	}
+};
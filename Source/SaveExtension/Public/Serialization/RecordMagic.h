@@ -0,0 +1,22 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+
+
+/**
+ * Markers written at the start of object data that doesn't begin with tagged properties.
+ * Tagged properties begin with the length of a property name, which is never one of these values.
+ */
+namespace RecordMagic
+{
+	/** Written by a native serializer. See FNativeSerializers */
+	static constexpr int32 Native = 0x7F53454E;
+
+	/** Arrays of plain data copied in bulk, followed by tagged properties */
+	static constexpr int32 Bulk = 0x7F534550;
+
+	/** Large actor with containers split in chunks. See FChunkedActorSerializer */
+	static constexpr int32 Chunked = 0x7F534543;
+}
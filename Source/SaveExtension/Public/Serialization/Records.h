@@ -68,6 +68,21 @@ struct FObjectRecord : public FBaseRecord
 };
 
 
+/**
+ * Canonical order of object records: by class, then by name.
+ * It doesn't depend on how serialization was split, so identical worlds are saved identically
+ */
+struct SAVEEXTENSION_API FRecordOrder
+{
+	static int32 Compare(const UClass* ClassA, FName NameA, const UClass* ClassB, FName NameB);
+
+	bool operator()(const FObjectRecord& A, const FObjectRecord& B) const
+	{
+		return Compare(A.Class, A.Name, B.Class, B.Name) < 0;
+	}
+};
+
+
 /** Represents a serialized Component */
 USTRUCT()
 struct FComponentRecord : public FObjectRecord
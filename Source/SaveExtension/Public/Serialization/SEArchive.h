@@ -17,5 +17,39 @@ public:
 		ArNoDelta = true;
 	}
 
+	/** Properties left out of this archive. Used when they are serialized separately */
+	TArray<const FProperty*> SkippedProperties;
+
+
 	virtual FArchive& operator<<(UObject*& Obj) override;
+
+	/**
+	 * Serializes an object with its native serializer if registered (see FNativeSerializers).
+	 * Otherwise SaveGame arrays of plain data are copied in bulk before its other properties
+	 * @return false if the record was corrupted
+	 */
+	bool SerializeObject(UObject* Object);
+
+	/** @return true if the elements of this array are plain data and can be copied as raw memory */
+	static bool CanBulkSerialize(const FArrayProperty* Property);
+
+	/**
+	 * Sizes read from a record can't be trusted before allocating.
+	 * @return true if Size bytes are left to load. Otherwise the archive is marked as failed
+	 */
+	static bool CanLoad(FArchive& Ar, int64 Size);
+
+	/** Loads a string or byte array only if its size fits in the remaining bytes */
+	static bool LoadChecked(FArchive& Ar, FString& Value);
+	static bool LoadChecked(FArchive& Ar, TArray<uint8>& Value);
+
+	virtual bool ShouldSkipProperty(const FProperty* InProperty) const override
+	{
+		return SkippedProperties.Contains(InProperty);
+	}
+
+private:
+
+	void SaveBulkArrays(UObject* Object, const TArray<const FArrayProperty*>& Properties);
+	void LoadBulkArrays(UObject* Object);
 };
@@ -8,8 +8,9 @@
 #include <Engine/LevelStreaming.h>
 #include <GameFramework/Actor.h>
 
-#include "SlotData.h"
 #include "LevelFilter.h"
+#include "Multithreading/CancelToken.h"
+#include "SlotData.h"
 
 #include "SlotDataTask.generated.h"
 
@@ -41,9 +42,21 @@ protected:
 	UPROPERTY()
 	float MaxFrameMs = 0.f;
 
+	/** Shared with async work started by this task */
+	FSECancelTokenPtr CancelToken;
+
+	/** Subscribers were notified that saving or loading began.
+	 * Finished events are only sent when true, so cancelled tasks never send them alone */
+	bool bNotifiedBegan = false;
+
 public:
 
-	USlotDataTask() : Super(), bRunning(false), bFinished(false) {}
+	USlotDataTask()
+		: Super()
+		, bRunning(false)
+		, bFinished(false)
+		, CancelToken(MakeShared<FSECancelToken, ESPMode::ThreadSafe>())
+	{}
 
 	void Prepare(USlotData* InSaveData, const USavePreset& InPreset)
 	{
@@ -58,6 +71,21 @@ public:
 
 	void Finish(bool bSuccess);
 
+	/**
+	 * Stops this task if it is pending or still at a point where it can be safely stopped.
+	 * Cancelled tasks finish as failed.
+	 * @return true if the task was cancelled
+	 */
+	bool Cancel();
+
+	/** @return true if this task can still be stopped without leaving the world or files half-done */
+	virtual bool CanCancel() const { return !bRunning; }
+
+	/** @return true if running Other makes this task redundant */
+	virtual bool IsSupersededBy(const USlotDataTask& Other) const { return false; }
+
+	bool IsCancelled() const { return CancelToken->IsCancelled(); }
+
 	bool IsRunning() const { return bRunning; }
 	bool IsFinished() const { return bFinished; }
 	bool IsSucceeded() const { return IsFinished() && bSucceeded; }
@@ -72,6 +100,9 @@ protected:
 
 	virtual void OnFinish(bool bSuccess) {}
 
+	/** Called when cancelled, before finishing. Async work should be stopped here */
+	virtual void OnCancel() {}
+
 	USaveManager* GetManager() const;
 
 	void BakeAllFilters();
@@ -30,9 +30,14 @@ public:
 		return this;
 	}
 
+	/** Level loads restore from memory and are never superseded */
+	virtual bool CanCancel() const override { return !IsRunning(); }
+	virtual bool IsSupersededBy(const USlotDataTask& Other) const override { return false; }
+
 private:
 
 	virtual void OnStart() override;
+	virtual void OnFinish(bool bSuccess) override;
 
 	virtual void DeserializeASyncLoop(float StartMS = 0.0f) override;
 };
@@ -33,7 +33,5 @@ public:
 private:
 
 	virtual void OnStart() override;
-	virtual void OnFinish(bool bSuccess) override  {
-		SELog(Preset, "Finished Serializing level", FColor::Green);
-	}
+	virtual void OnFinish(bool bSuccess) override;
 };
@@ -5,6 +5,7 @@
 #include "Delegates.h"
 #include "ISaveExtension.h"
 #include "Multithreading/LoadFileTask.h"
+#include "Multithreading/SlotPromise.h"
 #include "SavePreset.h"
 #include "SlotInfo.h"
 #include "SlotData.h"
@@ -19,6 +20,10 @@
 #include "SlotDataTask_Loader.generated.h"
 
 
+class FScopedMovementUpdate;
+class USceneComponent;
+class USlotDataTask_Loader;
+
 enum class ELoadDataTaskState : uint8
 {
 	NotStarted,
@@ -31,6 +36,39 @@ enum class ELoadDataTaskState : uint8
 	Deserializing
 };
 
+/**
+ * Defers the movement updates of all actors restored by a loader while it exists.
+ * Overlaps, child transforms and physics bodies are updated together when it is released, then saved velocities are applied.
+ * Does nothing if the loader already has a batch, so it can be used around a whole pass and around single actors.
+ */
+class FDeferredMovementBatch
+{
+	struct FVelocity
+	{
+		TWeakObjectPtr<USceneComponent> Component;
+		FVector Linear;
+		FVector Angular;
+	};
+
+	USlotDataTask_Loader& Loader;
+	bool bActive = false;
+
+	/** Released in reverse order, since movement scopes must not overlap */
+	TArray<TUniquePtr<FScopedMovementUpdate>> Scopes;
+	TArray<FVelocity> Velocities;
+
+public:
+
+	explicit FDeferredMovementBatch(USlotDataTask_Loader& InLoader);
+	~FDeferredMovementBatch();
+
+	void Defer(USceneComponent* Component);
+
+	/** Applied once all movement was updated */
+	void SetVelocity(USceneComponent* Component, const FVector& Linear, const FVector& Angular);
+};
+
+
 /**
 * Manages the loading process of a SaveData file
 */
@@ -39,18 +77,23 @@ class USlotDataTask_Loader : public USlotDataTask
 {
 	GENERATED_BODY()
 
-	FName SlotName;
+	friend FDeferredMovementBatch;
 
-	UPROPERTY()
-	USlotInfo* NewSlotInfo;
+	FName SlotName;
 
 	FOnGameLoaded Delegate;
+	TSlotPromisePtr<USlotInfo*> Promise;
 
 protected:
 
+	UPROPERTY()
+	USlotInfo* NewSlotInfo;
+
 	// Async variables
 	TWeakObjectPtr<ULevel> CurrentLevel;
 	TWeakObjectPtr<ULevelStreaming> CurrentSLevel;
+	/** Index of the next streaming level to deserialize */
+	int32 NextSLevelIndex = 0;
 
 	int32 CurrentActorIndex = 0;
 	TArray<TWeakObjectPtr<AActor>> CurrentLevelActors;
@@ -61,6 +104,21 @@ protected:
 
 	ELoadDataTaskState LoadState = ELoadDataTaskState::NotStarted;
 
+	/** Actors of all levels sorted by distance to the player. Used by progressive loading */
+	struct FProgressiveActor
+	{
+		TWeakObjectPtr<AActor> Actor;
+		const FActorRecord* Record = nullptr;
+		const FSELevelFilter* Filter = nullptr;
+		float DistanceSqr = 0.f;
+	};
+	TArray<FProgressiveActor> ProgressiveActors;
+	bool bProgressive = false;
+	bool bRadiusComplete = false;
+
+	/** Batch deferring the movement of restored actors, if any is open */
+	FDeferredMovementBatch* MovementBatch = nullptr;
+
 
 public:
 
@@ -74,27 +132,40 @@ public:
 
 	auto Bind(const FOnGameLoaded& OnLoaded) { Delegate = OnLoaded; return this; }
 
+	/** Actors are restored on the game thread, so the promise is resolved there once loading finishes */
+	auto BindPromise(TSlotPromisePtr<USlotInfo*> InPromise) { Promise = MoveTemp(InPromise); return this; }
+
 	void OnMapLoaded();
 
+	FName GetSlotName() const { return SlotName; }
+
+	/** Loading can be cancelled while waiting for data, but not while the map is opened or once deserialization starts */
+	virtual bool CanCancel() const override;
+
+	/** Any newer slot load replaces the state this task would load */
+	virtual bool IsSupersededBy(const USlotDataTask& Other) const override;
+
 private:
 
 	virtual void OnStart() override;
 
 	virtual void Tick(float DeltaTime) override;
-	virtual void OnFinish(bool bSuccess) override;
 	virtual void BeginDestroy() override;
 
+protected:
+
+	virtual void OnFinish(bool bSuccess) override;
+	virtual void OnCancel() override;
+
 	void StartDeserialization();
 
 	/** Spawns Actors hat were saved but which actors are not in the world. */
 	void RespawnActors(const TArray<FActorRecord*>& Records, const ULevel* Level);
 
-protected:
-
 	//~ Begin Files
 	void StartLoadingData();
 
-	USlotData* GetLoadedData() const;
+	virtual USlotData* GetLoadedData() const;
 	FORCEINLINE const bool IsDataLoaded() const { return LoadDataTask && LoadDataTask->IsDone(); };
 	//~ End Files
 
@@ -109,7 +180,14 @@ protected:
 
 	virtual void DeserializeASyncLoop(float StartMS = 0.0f);
 
-	void FinishedDeserializing();
+	/** Deserializes actors of all levels from closest to furthest from the player */
+	void DeserializeProgressive();
+	void DeserializeProgressiveLoop(float StartMS = 0.0f);
+
+	/** @return the saved location of the player, or its camera if there is no pawn */
+	bool FindFocusLocation(FVector& OutLocation) const;
+
+	virtual void FinishedDeserializing();
 
 	void PrepareAllLevels();
 	void PrepareLevel(const ULevel* Level, FLevelRecord& LevelRecord);
@@ -117,7 +195,10 @@ protected:
 	/** Deserializes all Level actors. */
 	inline void DeserializeLevel_Actor(AActor* const Actor, const FLevelRecord& LevelRecord, const FSELevelFilter& Filter);
 
-	void FindNextAsyncLevel(ULevelStreaming*& OutLevelStreaming) const;
+	void FindNextAsyncLevel(ULevelStreaming*& OutLevelStreaming);
+
+	/** Serializes an actor into this Actor Record */
+	bool DeserializeActor(AActor* Actor, const FActorRecord& Record, const FSELevelFilter& Filter);
 
 private:
 
@@ -125,9 +206,6 @@ private:
 	Requires 'SaveGameMode' flag to be used. */
 	void DeserializeGameInstance();
 
-	/** Serializes an actor into this Actor Record */
-	bool DeserializeActor(AActor* Actor, const FActorRecord& Record, const FSELevelFilter& Filter);
-
 	/** Deserializes the components of an actor from a provided Record */
 	void DeserializeActorComponents(AActor* Actor, const FActorRecord& ActorRecord, const FSELevelFilter& Filter, int8 indent = 0);
 	/** END Deserialization */
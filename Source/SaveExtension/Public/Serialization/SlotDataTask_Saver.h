@@ -6,6 +6,7 @@
 #include "ISaveExtension.h"
 #include "MTTask_SerializeActors.h"
 #include "Multithreading/SaveFileTask.h"
+#include "Multithreading/SlotPromise.h"
 #include "SavePreset.h"
 #include "SlotData.h"
 #include "SlotDataTask.h"
@@ -36,6 +37,7 @@ class USlotDataTask_Saver : public USlotDataTask
 	int32 Height;
 
 	FOnGameSaved Delegate;
+	TSlotPromisePtr<USlotInfo*> Promise;
 
 protected:
 
@@ -51,6 +53,7 @@ protected:
 
 	/** Begin AsyncTasks */
 	TArray<FAsyncTask<FMTTask_SerializeActors>> Tasks;
+	FPhysicsSnapshot PhysicsSnapshot;
 	FAsyncTask<FSaveFileTask>* SaveTask;
 	/** End AsyncTasks */
 
@@ -75,6 +78,15 @@ public:
 
 	auto* Bind(const FOnGameSaved& OnSaved) { Delegate = OnSaved; return this; }
 
+	/** The promise is resolved from the worker thread as soon as the file is written, unless a thumbnail is awaited */
+	auto* BindPromise(TSlotPromisePtr<USlotInfo*> InPromise) { Promise = MoveTemp(InPromise); return this; }
+
+	FName GetSlotName() const { return SlotName; }
+
+	/** A pending save is redundant if a newer save to the same slot is requested.
+	 * Running saves are never interrupted so that slots are not left half-written */
+	virtual bool IsSupersededBy(const USlotDataTask& Other) const override;
+
 	// Where all magic happens
 	virtual void OnStart() override;
 	virtual void Tick(float DeltaTime) override;
@@ -91,6 +103,9 @@ protected:
 
 	void SerializeLevelSync(const ULevel* Level, int32 AssignedThreads, const ULevelStreaming* StreamingLevel = nullptr);
 
+	/** Splits actors between serialization tasks that will dump their records into LevelRecord */
+	void ScheduleActorTasks(const TArray<AActor*>* Actors, FLevelRecord* LevelRecord, const FSELevelFilter& Filter, int32 AssignedTasks);
+
 	/** END Serialization */
 
 	void RunScheduledTasks();
@@ -0,0 +1,46 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include "ISaveExtension.h"
+
+#include "SavePreset.h"
+
+#include "SlotDataTask_Loader.h"
+#include "SlotDataTask_SnapshotLoader.generated.h"
+
+
+/**
+* Restores the world from an in-memory snapshot using the normal deserialization process
+*/
+UCLASS()
+class USlotDataTask_SnapshotLoader : public USlotDataTask_Loader
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	USlotData* SnapshotData;
+
+	/** Restoring a snapshot doesn't start a new play session */
+	FDateTime SessionLoadDate;
+
+public:
+
+	auto Setup(USlotData* InSnapshotData)
+	{
+		SnapshotData = InSnapshotData;
+		return this;
+	}
+
+protected:
+
+	virtual USlotData* GetLoadedData() const override { return SnapshotData; }
+
+private:
+
+	virtual void OnStart() override;
+	virtual void OnFinish(bool bSuccess) override;
+
+	/** Merges the restored records into the current data instead of replacing it */
+	virtual void FinishedDeserializing() override;
+};
@@ -0,0 +1,26 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include "ISaveExtension.h"
+
+#include "SavePreset.h"
+
+#include "SlotDataTask_Saver.h"
+#include "SlotDataTask_SnapshotSaver.generated.h"
+
+
+/**
+* Serializes the world into an in-memory snapshot. Never touches disk.
+* Save events are not called, snapshots are meant to be taken very often.
+*/
+UCLASS()
+class USlotDataTask_SnapshotSaver : public USlotDataTask_Saver
+{
+	GENERATED_BODY()
+
+private:
+
+	virtual void OnStart() override;
+	virtual void OnFinish(bool bSuccess) override;
+};
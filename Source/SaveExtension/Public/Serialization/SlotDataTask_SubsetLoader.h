@@ -0,0 +1,68 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include "ISaveExtension.h"
+
+#include "SavePreset.h"
+
+#include "SlotDataTask_Loader.h"
+#include "SlotDataTask_SubsetLoader.generated.h"
+
+
+/**
+* Restores the actors stored in a sub-slot. Other actors in the world are not touched.
+* Saved actors are matched by name, or by owner and class for player shards. Records without a matching
+* actor are skipped and reported, since respawning them would duplicate actors that were renamed.
+*/
+UCLASS()
+class USlotDataTask_SubsetLoader : public USlotDataTask_Loader
+{
+	GENERATED_BODY()
+
+	FName SubSlotName;
+
+	FOnGameLoaded OnLoaded;
+
+	/** The sub-slot is being written in the background */
+	bool bWaitingForWrite = false;
+
+	/** Levels notified with OnLoadBegan. Only these receive OnLoadFinished */
+	TArray<TWeakObjectPtr<const ULevel>> NotifiedLevels;
+
+	/** Persistent id of the player whose shard is loaded. Empty for other sub-slots */
+	FString OwnerId;
+
+	/** Actors owned by OwnerId that were not matched to a record yet */
+	TArray<AActor*> OwnedActors;
+
+public:
+
+	auto* Setup(FName InSubSlotName)
+	{
+		SubSlotName = InSubSlotName;
+		return this;
+	}
+
+	/** Matches records to the actors owned by a player (see FSaveShards::GetOwnerId) instead of by name */
+	auto* SetupOwner(const FString& InOwnerId)
+	{
+		OwnerId = InOwnerId;
+		return this;
+	}
+
+	auto* Bind(const FOnGameLoaded& InOnLoaded) { OnLoaded = InOnLoaded; return this; }
+
+private:
+
+	virtual void OnStart() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual void OnFinish(bool bSuccess) override;
+
+	void LoadFile();
+	void DeserializeSubset();
+	void DeserializeSubsetLevel(const ULevel* Level, FLevelRecord& LevelRecord);
+
+	/** @return the owned actor of a record, preferring the one with its name. Null if none is left */
+	AActor* TakeOwnedActor(const ULevel* Level, const FActorRecord& Record);
+};
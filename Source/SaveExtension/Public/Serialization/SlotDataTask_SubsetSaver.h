@@ -0,0 +1,55 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include "ISaveExtension.h"
+
+#include "SavePreset.h"
+
+#include "SlotDataTask_Saver.h"
+#include "SlotDataTask_SubsetSaver.generated.h"
+
+
+/**
+* Serializes an explicit set of actors into a sub-slot.
+* Cost is proportional to the amount of actors, the rest of the world is not visited.
+*/
+UCLASS()
+class USlotDataTask_SubsetSaver : public USlotDataTask_Saver
+{
+	GENERATED_BODY()
+
+	FName SubSlotName;
+	TArray<TWeakObjectPtr<AActor>> Actors;
+
+	FOnGameSaved OnSaved;
+
+	/** Actors to serialize grouped by level. Referenced by serialization tasks */
+	TArray<TArray<AActor*>> LevelActors;
+
+	/** Levels notified with OnSaveBegan. Only these receive OnSaveFinished */
+	TArray<TWeakObjectPtr<const ULevel>> NotifiedLevels;
+
+	/** The file is written by the manager, which notifies OnSaved */
+	bool bWriteHandedOff = false;
+
+public:
+
+	auto* Setup(FName InSubSlotName, const TArray<AActor*>& InActors)
+	{
+		SubSlotName = InSubSlotName;
+		Actors.Reserve(InActors.Num());
+		for (AActor* Actor : InActors)
+		{
+			Actors.Add(Actor);
+		}
+		return this;
+	}
+
+	auto* Bind(const FOnGameSaved& InOnSaved) { OnSaved = InOnSaved; return this; }
+
+private:
+
+	virtual void OnStart() override;
+	virtual void OnFinish(bool bSuccess) override;
+};
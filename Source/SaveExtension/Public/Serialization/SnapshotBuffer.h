@@ -0,0 +1,90 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+
+
+class USlotData;
+class FSlotObjectPool;
+
+/** A world state captured in memory */
+struct FWorldSnapshot
+{
+	float TimeSeconds = 0.f;
+	FName Map;
+
+	/** If true Bytes contains the full snapshot, otherwise a delta from the previous snapshot */
+	bool bKeyframe = true;
+
+	/** Size of the snapshot once decoded */
+	int32 RawSize = 0;
+	TArray<uint8> Bytes;
+};
+
+
+/**
+ * Fixed-size ring buffer of world snapshots.
+ * Snapshots are delta-encoded against the previous one, with a full keyframe every few snapshots
+ * to keep decoding cheap.
+ */
+class SAVEEXTENSION_API FSnapshotBuffer
+{
+	/** Ring storage. Oldest snapshot is at First */
+	TArray<FWorldSnapshot> Snapshots;
+	int32 First = 0;
+	int32 Count = 0;
+
+	/** Class of the SlotData stored in all snapshots */
+	FString DataClassName;
+
+	/** Decoded bytes of the newest snapshot. The next snapshot is encoded against them */
+	TArray<uint8> LastRawBytes;
+	int32 SinceKeyframe = 0;
+
+
+public:
+
+	static constexpr int32 KeyframeInterval = 16;
+
+
+	void SetCapacity(int32 Capacity);
+	int32 GetCapacity() const { return Snapshots.Num(); }
+
+	/** Serializes a SlotData with its records into a new snapshot. Oldest snapshot is dropped if full */
+	void Push(USlotData* Data, float TimeSeconds, FName Map);
+
+	/** Decodes a snapshot into a new SlotData object. The object is taken from the pool if provided */
+	USlotData* CreateData(int32 Index, UObject* Outer, FSlotObjectPool* Pool = nullptr) const;
+
+	/** Decodes the full bytes of a snapshot. @param Index 0 is the oldest snapshot */
+	bool Decode(int32 Index, TArray<uint8>& OutBytes) const;
+
+	/** Removes all snapshots newer than Index */
+	void DiscardNewerThan(int32 Index);
+
+	const FWorldSnapshot& Get(int32 Index) const
+	{
+		check(Snapshots.Num() > 0 && Index >= 0 && Index < Count);
+		return Snapshots[(First + Index) % Snapshots.Num()];
+	}
+
+	/** @return index of the snapshot closest in time, or INDEX_NONE if empty */
+	int32 FindClosest(float TimeSeconds) const;
+
+	int32 Num() const { return Count; }
+
+	void Empty();
+
+private:
+
+	FWorldSnapshot& GetMutable(int32 Index)
+	{
+		return Snapshots[(First + Index) % Snapshots.Num()];
+	}
+
+	void PopOldest();
+
+	static void EncodeDelta(const TArray<uint8>& Base, const TArray<uint8>& Target, TArray<uint8>& OutDelta);
+	static bool ApplyDelta(const TArray<uint8>& Base, const FWorldSnapshot& Delta, TArray<uint8>& OutBytes);
+};
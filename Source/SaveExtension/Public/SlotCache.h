@@ -0,0 +1,96 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include "FileAdapter.h"
+
+#include <CoreMinimal.h>
+#include <HAL/CriticalSection.h>
+#include <Misc/DateTime.h>
+#include <Templates/SharedPointer.h>
+
+
+/** Identifies one specific version of a slot file on disk */
+struct FSlotFileGeneration
+{
+	FDateTime Timestamp;
+	int64 Size = -1;
+
+
+	FSlotFileGeneration() = default;
+	FSlotFileGeneration(FDateTime InTimestamp, int64 InSize)
+		: Timestamp(InTimestamp)
+		, Size(InSize)
+	{}
+
+	bool IsValid() const { return Size >= 0; }
+
+	bool operator==(const FSlotFileGeneration& Other) const
+	{
+		return Size == Other.Size && Timestamp == Other.Timestamp;
+	}
+};
+
+
+using FSharedSaveFile = TSharedPtr<const FSaveFile, ESPMode::ThreadSafe>;
+
+/**
+ * Keeps the decompressed bytes of the most recently saved or loaded slots in memory.
+ * Loading a cached slot skips disk access and decompression entirely.
+ * Entries are keyed by slot name and slot revision (see FFileAdapter::GetSlotRevision),
+ * so a slot written or deleted since it was cached is never served from memory.
+ * Thread-safe.
+ */
+class SAVEEXTENSION_API FSlotCache
+{
+	struct FEntry
+	{
+		FString SlotName;
+		uint32 Revision = 0;
+		FSharedSaveFile File;
+		int64 Bytes = 0;
+	};
+
+	mutable FCriticalSection Lock;
+
+	// Sorted from least to most recently used
+	TArray<FEntry> Entries;
+	int64 UsedBytes = 0;
+
+	int32 MaxEntries = 0;
+	int64 MaxBytes = 0;
+
+
+public:
+
+	void SetLimits(int32 InMaxEntries, int64 InMaxBytes);
+
+	bool IsEnabled() const;
+
+	/**
+	 * Caches a file that was just written to or read from disk
+	 * @param Revision of the slot when it was written or before it was read
+	 * @return the shared file, even if it didn't fit in the cache
+	 */
+	FSharedSaveFile Store(FStringView SlotName, uint32 Revision, FSaveFile&& File);
+
+	/** @return the cached file if it matches the provided revision */
+	FSharedSaveFile Find(FStringView SlotName, uint32 Revision);
+
+	/**
+	 * @return the cached file if it is up to date, otherwise reads it from storage.
+	 * Full reads are cached. Thread-safe and lock-free while reading.
+	 */
+	FSharedSaveFile FindOrRead(ISaveStorageBackend& Storage, FStringView SlotName, bool bSkipData = false);
+
+	void Remove(FStringView SlotName);
+	void Empty();
+
+private:
+
+	int32 IndexOf(FStringView SlotName) const;
+	void RemoveAt(int32 Index);
+
+	/** Removes least recently used entries until the cache fits its limits */
+	void Trim();
+};
@@ -54,6 +54,17 @@ public:
 
 	void CleanRecords(bool bKeepSublevels);
 
+	/** @return the record of a sub-level by its package name. O(1) */
+	FStreamingLevelRecord* FindSubLevel(FName PackageName);
+	FStreamingLevelRecord& FindOrAddSubLevel(const ULevelStreaming& Level);
+
 	/** Using manual serialization. It's way faster than reflection serialization */
 	virtual void Serialize(FArchive& Ar) override;
+
+private:
+
+	/** Index of each sub-level record by package name. Rebuilt if SubLevels changed */
+	TMap<FName, int32> SubLevelIndices;
+
+	void RebuildSubLevelIndices();
 };
@@ -0,0 +1,71 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include "SlotCache.h"
+
+#include <CoreMinimal.h>
+#include <HAL/CriticalSection.h>
+#include <UObject/UObjectGlobals.h>
+
+class USlotInfo;
+
+
+/**
+ * Reuses slot info and data objects instead of creating new ones for every load or slot listing.
+ * - Released objects are reset to their defaults and handed out again for the same class.
+ *   Only objects no one else can reference are released (e.g data of sub-slot saves and loads, or of failed loads),
+ *   never the current data.
+ * - Infos read while listing slots are kept and reused while their file doesn't change.
+ * Pooled objects are referenced by the SaveManager. Thread-safe.
+ */
+class SAVEEXTENSION_API FSlotObjectPool
+{
+	struct FListedInfo
+	{
+		USlotInfo* Info = nullptr;
+		FSlotFileGeneration Generation;
+	};
+
+	mutable FCriticalSection Lock;
+
+	TMap<const UClass*, TArray<UObject*>> FreeObjects;
+	TMap<FString, FListedInfo> ListedInfos;
+
+
+public:
+
+	/** Released objects kept per class */
+	static constexpr int32 MaxFreePerClass = 4;
+
+
+	/**
+	 * @return a released object of this class reset to defaults, or a new object.
+	 * Outside of the game thread, objects are flagged as Async so that they are not collected until the caller clears it.
+	 */
+	UObject* Acquire(UClass* Class, UObject* Outer);
+
+	template<typename T>
+	T* Acquire(UClass* Class, UObject* Outer)
+	{
+		return CastChecked<T>(Acquire(Class? Class : T::StaticClass(), Outer));
+	}
+
+	/** Gives back an object that is not used anymore. It must not be accessed after this */
+	void Release(UObject* Object);
+
+	/** @return the info listed for a slot if its file didn't change since */
+	USlotInfo* FindListedInfo(FStringView SlotName, const FSlotFileGeneration& Generation) const;
+	void AddListedInfo(FStringView SlotName, const FSlotFileGeneration& Generation, USlotInfo* Info);
+
+	/** Forgets listed infos of slots that don't exist anymore */
+	void RetainListedInfos(const TArray<FString>& SlotNames);
+
+	void Empty();
+
+	void AddReferencedObjects(FReferenceCollector& Collector, const UObject* Referencer);
+
+private:
+
+	static void ResetToDefaults(UObject* Object);
+};
@@ -0,0 +1,22 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include "SaveStorageBackend.h"
+
+
+/** Stores each slot as a loose .sav file inside the SaveGames folder */
+class SAVEEXTENSION_API FFileStorageBackend : public ISaveStorageBackend
+{
+public:
+
+	virtual TUniquePtr<FArchive> CreateReader(FStringView SlotName) override;
+	virtual TUniquePtr<FArchive> CreateWriter(FStringView SlotName) override;
+
+	virtual bool Delete(FStringView SlotName) override;
+	virtual bool Exists(FStringView SlotName) override;
+
+	virtual FSlotFileGeneration GetGeneration(FStringView SlotName) override;
+
+	virtual void FindSlotNames(TArray<FString>& OutSlotNames) override;
+};
@@ -0,0 +1,39 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include "SaveStorageBackend.h"
+
+#include <HAL/CriticalSection.h>
+
+
+/** Keeps slots in memory only. Nothing touches disk, which is useful for tests and benchmarks */
+class SAVEEXTENSION_API FMemoryStorageBackend : public ISaveStorageBackend
+{
+	struct FEntry
+	{
+		TArray<uint8> Bytes;
+		FSlotFileGeneration Generation;
+	};
+
+	FCriticalSection Lock;
+	TMap<FString, FEntry> Slots;
+
+	/** Generations use the time of the write, bumped so that quick rewrites are still told apart */
+	int64 LastWriteTicks = 0;
+
+
+public:
+
+	virtual TUniquePtr<FArchive> CreateReader(FStringView SlotName) override;
+	virtual TUniquePtr<FArchive> CreateWriter(FStringView SlotName) override;
+
+	virtual bool Delete(FStringView SlotName) override;
+	virtual bool Exists(FStringView SlotName) override;
+
+	virtual FSlotFileGeneration GetGeneration(FStringView SlotName) override;
+
+	virtual void FindSlotNames(TArray<FString>& OutSlotNames) override;
+
+	void Empty();
+};
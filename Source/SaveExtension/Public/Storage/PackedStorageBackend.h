@@ -0,0 +1,87 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include "SaveStorageBackend.h"
+
+#include <GenericPlatform/GenericPlatformFile.h>
+#include <HAL/CriticalSection.h>
+
+
+/**
+ * Stores all slots inside a single file with an index, keeping it open between operations.
+ * Avoids opening and closing one file per slot on platforms where small-file I/O is expensive.
+ *
+ * Slots are always appended and followed by a new index. The header is updated last, so an
+ * interrupted write keeps the previous index. Space left by replaced slots is reclaimed by compacting.
+ */
+class SAVEEXTENSION_API FPackedStorageBackend : public ISaveStorageBackend
+{
+	struct FEntry
+	{
+		int64 Offset = 0;
+		int64 Size = 0;
+		FDateTime Timestamp;
+
+		friend FArchive& operator<<(FArchive& Ar, FEntry& Entry)
+		{
+			Ar << Entry.Offset << Entry.Size << Entry.Timestamp;
+			return Ar;
+		}
+	};
+
+	static constexpr uint32 Magic = 0x4B504553; // "SEPK"
+	static constexpr int32 Version = 1;
+	static constexpr int64 HeaderSize = sizeof(uint32) + sizeof(int32) + sizeof(int64);
+
+	/** Files are compacted when wasted space exceeds live data and this amount */
+	static constexpr int64 MinCompactBytes = 1024 * 1024;
+
+	FCriticalSection Lock;
+	FString PackPath;
+	TUniquePtr<IFileHandle> Handle;
+
+	TMap<FString, FEntry> Index;
+	int64 EndOffset = 0;
+	int64 LiveBytes = 0;
+
+
+public:
+
+	explicit FPackedStorageBackend(FString InPackPath = {});
+
+	virtual TUniquePtr<FArchive> CreateReader(FStringView SlotName) override;
+	virtual TUniquePtr<FArchive> CreateWriter(FStringView SlotName) override;
+
+	virtual bool Delete(FStringView SlotName) override;
+	virtual bool Exists(FStringView SlotName) override;
+
+	virtual FSlotFileGeneration GetGeneration(FStringView SlotName) override;
+
+	virtual void FindSlotNames(TArray<FString>& OutSlotNames) override;
+
+	const FString& GetPackPath() const { return PackPath; }
+
+private:
+
+	// All private functions expect the lock to be held
+	bool Open();
+	/** Opens the pack if it exists and is valid. Never creates or truncates it */
+	bool OpenExisting();
+	bool ReadIndex();
+	bool Reset();
+	bool Commit(const FString& SlotName, const TArray<uint8>& Bytes);
+
+	/** Writes a slot at the end of the file without updating the index */
+	bool Append(const FString& SlotName, const TArray<uint8>& Bytes, FDateTime Timestamp);
+
+	/** Appends the index and points the header to it */
+	bool WriteIndex();
+
+	/** Rewrites the file with only live slots if too much space is wasted */
+	void TryCompact();
+
+	FString GetTempPath() const { return PackPath + TEXT(".tmp"); }
+	/** Previous pack, kept while a compacted one replaces it */
+	FString GetOldPath() const { return PackPath + TEXT(".old"); }
+};
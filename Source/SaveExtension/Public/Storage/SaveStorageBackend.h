@@ -0,0 +1,86 @@
+// Copyright 2015-2020 Piperift. All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <Containers/StringView.h>
+#include <Serialization/MemoryWriter.h>
+#include <Templates/Function.h>
+#include <Templates/UniquePtr.h>
+
+#include "SlotCache.h"
+
+
+/**
+ * Where and how slot files are stored.
+ * Implementations must be thread-safe, since files are read and written from worker threads.
+ */
+class SAVEEXTENSION_API ISaveStorageBackend
+{
+public:
+
+	virtual ~ISaveStorageBackend() {}
+
+	/** @return an archive reading a stored slot, or null if it doesn't exist */
+	virtual TUniquePtr<FArchive> CreateReader(FStringView SlotName) = 0;
+
+	/** @return an archive writing a slot. Content is stored once the archive is closed */
+	virtual TUniquePtr<FArchive> CreateWriter(FStringView SlotName) = 0;
+
+	virtual bool Delete(FStringView SlotName) = 0;
+	virtual bool Exists(FStringView SlotName) = 0;
+
+	/** @return the generation of a stored slot. Invalid if the slot doesn't exist */
+	virtual FSlotFileGeneration GetGeneration(FStringView SlotName) = 0;
+
+	/** Finds the names of all stored slots. Sub-slots are not included */
+	virtual void FindSlotNames(TArray<FString>& OutSlotNames) = 0;
+};
+
+
+struct FStorageWriterBytes
+{
+	TArray<uint8> Bytes;
+};
+
+/**
+ * Writes a slot into memory and hands the bytes to a backend when closed.
+ * Used by backends that don't stream into individual files.
+ */
+class FStorageCommitWriter : private FStorageWriterBytes, public FMemoryWriter
+{
+public:
+
+	using FCommit = TFunction<bool(TArray<uint8>&)>;
+
+private:
+
+	FCommit Commit;
+	bool bCommitted = false;
+
+public:
+
+	explicit FStorageCommitWriter(FCommit&& InCommit)
+		: FStorageWriterBytes()
+		, FMemoryWriter(FStorageWriterBytes::Bytes, true)
+		, Commit(MoveTemp(InCommit))
+	{}
+
+	virtual ~FStorageCommitWriter()
+	{
+		Close();
+	}
+
+	virtual bool Close() override
+	{
+		if (!bCommitted)
+		{
+			bCommitted = true;
+			if (!IsError() && !Commit(FStorageWriterBytes::Bytes))
+			{
+				SetError();
+			}
+		}
+		return !IsError();
+	}
+};
@@ -23,6 +23,21 @@ public class SaveExtension : ModuleRules
 			"ImageWrapper",
 			"NavigationSystem"
 		});
+
+		// Compression with preset dictionaries
+		AddEngineThirdPartyPrivateStaticDependencies(Target, "zlib");
+
+		// Encryption of slot data. OpenSSL runs on hardware AES instructions when available
+		bool bWithEncryption = Target.Platform == UnrealTargetPlatform.Win64 ||
+			Target.Platform == UnrealTargetPlatform.Win32 ||
+			Target.Platform == UnrealTargetPlatform.Linux ||
+			Target.Platform == UnrealTargetPlatform.Mac ||
+			Target.Platform == UnrealTargetPlatform.Android;
+		if (bWithEncryption)
+		{
+			AddEngineThirdPartyPrivateStaticDependencies(Target, "OpenSSL");
+		}
+		PrivateDefinitions.Add("WITH_SE_ENCRYPTION=" + (bWithEncryption ? "1" : "0"));
 	}
 }
 
@@ -4,6 +4,42 @@
 #include "Helpers/TestActor.h"
 #include "SaveManager.h"
 #include "FileAdapter.h"
+#include "Misc/SaveEncryption.h"
+#include "Multithreading/LoadFileTask.h"
+#include "Multithreading/PruneSlotsTask.h"
+#include "Multithreading/UpgradeSlotsTask.h"
+#include "SlotCache.h"
+#include "Storage/SaveStorageBackend.h"
+
+
+/** Forwards to another backend reporting chosen save times, since file times only have a resolution of seconds */
+class FTimedStorage : public ISaveStorageBackend
+{
+	FSaveStorageRef Inner;
+
+public:
+
+	TMap<FString, FDateTime> Timestamps;
+
+
+	explicit FTimedStorage(FSaveStorageRef InInner) : Inner(MoveTemp(InInner)) {}
+
+	virtual TUniquePtr<FArchive> CreateReader(FStringView SlotName) override { return Inner->CreateReader(SlotName); }
+	virtual TUniquePtr<FArchive> CreateWriter(FStringView SlotName) override { return Inner->CreateWriter(SlotName); }
+	virtual bool Delete(FStringView SlotName) override { return Inner->Delete(SlotName); }
+	virtual bool Exists(FStringView SlotName) override { return Inner->Exists(SlotName); }
+	virtual void FindSlotNames(TArray<FString>& OutSlotNames) override { Inner->FindSlotNames(OutSlotNames); }
+
+	virtual FSlotFileGeneration GetGeneration(FStringView SlotName) override
+	{
+		FSlotFileGeneration Generation = Inner->GetGeneration(SlotName);
+		if (const FDateTime* Timestamp = Timestamps.Find(FString{ SlotName.Len(), SlotName.GetData() }))
+		{
+			Generation.Timestamp = *Timestamp;
+		}
+		return Generation;
+	}
+};
 
 
 class FSaveSpec_Files : public Automatron::FTestSpec
@@ -44,7 +80,7 @@ void FSaveSpec_Files::Define()
 
 		TestTrue("Saved", SaveManager->SaveSlot(0));
 
-		TestTrue("Info File exists in disk", FFileAdapter::DoesFileExist(TEXT("0")));
+		TestTrue("Info File exists in disk", FFileAdapter::DoesFileExist(*SaveManager->GetStorage(), TEXT("0")));
 	});
 
 	It("Can save files asynchronously", [this]() {
@@ -53,13 +89,13 @@ void FSaveSpec_Files::Define()
 
 		bool bSaving = SaveManager->SaveSlot(0, true, false, {}, FOnGameSaved::CreateLambda([this](auto* Info) {
 			// Notified that files have been saved asynchronously
-			TestTrue("Info File exists in disk", FFileAdapter::DoesFileExist(TEXT("0")));
+			TestTrue("Info File exists in disk", FFileAdapter::DoesFileExist(*SaveManager->GetStorage(), TEXT("0")));
 			bFinishTick = true;
 		}));
 		TestTrue("Started Saving", bSaving);
 
 		// Files shouldn't exist yet
-		TestFalse("Info File exists in disk", FFileAdapter::DoesFileExist(TEXT("0")));
+		TestFalse("Info File exists in disk", FFileAdapter::DoesFileExist(*SaveManager->GetStorage(), TEXT("0")));
 
 		TickWorldUntil(GetMainWorld(), true, [this](float) {
 			return !bFinishTick;
@@ -73,11 +109,213 @@ void FSaveSpec_Files::Define()
 
 		USlotInfo* Info = nullptr;
 		USlotData* Data = nullptr;
-		TestTrue("File was loaded", FFileAdapter::LoadFile(TEXT("0"), Info, Data, true, SaveManager));
+		TestTrue("File was loaded", FFileAdapter::LoadFile(*SaveManager->GetStorage(), TEXT("0"), Info, Data, true, SaveManager));
+		TestNotNull("Info is valid", Info);
+		TestNotNull("Data is valid", Data);
+	});
+
+	It("Creates loaded objects on the game thread", [this]() {
+		TestPreset->MultithreadedFiles = ESaveASyncMode::OnlySync;
+		TestTrue("Saved", SaveManager->SaveSlot(0));
+
+		FAsyncTask<FLoadFileTask> Task{ SaveManager, TEXT("0") };
+		Task.StartBackgroundTask();
+		Task.EnsureCompletion(false);
+
+		USlotInfo* Info = Task.GetTask().GetInfo();
+		USlotData* Data = Task.GetTask().GetData();
+		TestNotNull("Info is valid", Info);
+		TestNotNull("Data is valid", Data);
+		TestFalse("Info was not created on a worker", Info && Info->HasAnyInternalFlags(EInternalObjectFlags::Async));
+		TestFalse("Data was not created on a worker", Data && Data->HasAnyInternalFlags(EInternalObjectFlags::Async));
+	});
+
+	It("Can save and load files from a packed file", [this]() {
+		TestPreset->MultithreadedFiles = ESaveASyncMode::OnlySync;
+		TestPreset->Storage = ESaveStorage::PackedFile;
+
+		TestTrue("Saved", SaveManager->SaveSlot(0));
+		TestTrue("Slot exists in the packed file", FFileAdapter::DoesFileExist(*SaveManager->GetStorage(), TEXT("0")));
+
+		USlotInfo* Info = nullptr;
+		USlotData* Data = nullptr;
+		TestTrue("File was loaded", FFileAdapter::LoadFile(*SaveManager->GetStorage(), TEXT("0"), Info, Data, true, SaveManager));
 		TestNotNull("Info is valid", Info);
 		TestNotNull("Data is valid", Data);
 	});
 
+	It("Stores slots in the backend of its manager", [this]() {
+		TestPreset->MultithreadedFiles = ESaveASyncMode::OnlySync;
+		TestPreset->Storage = ESaveStorage::Memory;
+
+		TestTrue("Saved", SaveManager->SaveSlot(0));
+		TestTrue("Slot exists in memory", FFileAdapter::DoesFileExist(*SaveManager->GetStorage(), TEXT("0")));
+		TestFalse("Slot doesn't exist in files", FFileAdapter::DoesFileExist(*FFileAdapter::GetDefaultStorage(), TEXT("0")));
+	});
+
+	It("Resolves save futures from the thread writing files", [this]() {
+		TestPreset->MultithreadedFiles = ESaveASyncMode::SaveAsync;
+
+		// Waiting doesn't need the world to tick, as long as no other task is queued before this save
+		TestFalse("No tasks are queued", SaveManager->HasTasks());
+		TFuture<USlotInfo*> Saved = SaveManager->SaveSlotAsync(TEXT("0"));
+		TestNotNull("Saved Info", Saved.Get());
+		TestTrue("Info File exists in disk", FFileAdapter::DoesFileExist(*SaveManager->GetStorage(), TEXT("0")));
+
+		TickWorldUntil(GetMainWorld(), true, [this](float) {
+			return SaveManager->HasTasks();
+		});
+	});
+
+	It("Keeps saved files in the slot cache", [this]() {
+		TestPreset->MultithreadedFiles = ESaveASyncMode::OnlySync;
+		TestPreset->CachedSlots = 1;
+
+		TestTrue("Saved", SaveManager->SaveSlot(0));
+
+		const auto& Cache = SaveManager->GetSlotCache();
+		const uint32 Revision = FFileAdapter::GetSlotRevision(TEXT("0"));
+		TestTrue("Slot is cached", Cache->Find(TEXT("0"), Revision).IsValid());
+
+		// Saved within the same second, so file timestamps can't tell both saves apart
+		TestTrue("Saved again", SaveManager->SaveSlot(0));
+		TestFalse("Previous save is not cached", Cache->Find(TEXT("0"), Revision).IsValid());
+		TestTrue("Last save is cached", Cache->Find(TEXT("0"), FFileAdapter::GetSlotRevision(TEXT("0"))).IsValid());
+
+		TestTrue("Deleted", SaveManager->DeleteSlotById(0));
+		TestFalse("Deleted slot is not cached", Cache->Find(TEXT("0"), FFileAdapter::GetSlotRevision(TEXT("0"))).IsValid());
+	});
+
+	It("Encrypts slot data", [this]() {
+		if (!FSaveEncryption::IsSupported())
+		{
+			return;
+		}
+		TestPreset->MultithreadedFiles = ESaveASyncMode::OnlySync;
+		TestPreset->bEncryptData = true;
+
+		TArray<uint8> Key;
+		Key.Init(7, FSaveEncryption::KeySize);
+		TestTrue("Key is valid", FSaveEncryption::SetKey(Key));
+		TestTrue("Saved", SaveManager->SaveSlot(0));
+
+		FSaveFile File;
+		TestTrue("Read", FFileAdapter::ReadFile(*SaveManager->GetStorage(), TEXT("0"), File));
+		TestTrue("Data was decrypted", File.DataBytes.Num() > 0);
+
+		FSaveEncryption::SetKey({});
+		TestTrue("Read", FFileAdapter::ReadFile(*SaveManager->GetStorage(), TEXT("0"), File));
+		TestEqual("Data can't be decrypted without key", File.DataBytes.Num(), 0);
+	});
+
+	It("Encrypts only files written with encryption", [this]() {
+		if (!FSaveEncryption::IsSupported())
+		{
+			return;
+		}
+		TestPreset->MultithreadedFiles = ESaveASyncMode::OnlySync;
+		TestTrue("Saved", SaveManager->SaveSlot(0));
+
+		FSaveFile File;
+		TestTrue("Read", FFileAdapter::ReadFile(*SaveManager->GetStorage(), TEXT("0"), File));
+
+		TArray<uint8> Key;
+		Key.Init(7, FSaveEncryption::KeySize);
+		TestTrue("Key is valid", FSaveEncryption::SetKey(Key));
+		FSaveFileSettings Encrypted;
+		Encrypted.bEncrypt = true;
+		TestTrue("Saved", FFileAdapter::SaveFile(*SaveManager->GetStorage(), TEXT("1"), File, Encrypted));
+		TestTrue("Saved", FFileAdapter::SaveFile(*SaveManager->GetStorage(), TEXT("2"), File, FSaveFileSettings{}));
+		FSaveEncryption::SetKey({});
+
+		TestTrue("Read", FFileAdapter::ReadFile(*SaveManager->GetStorage(), TEXT("1"), File));
+		TestEqual("Encrypted data can't be read without key", File.DataBytes.Num(), 0);
+		TestTrue("Read", FFileAdapter::ReadFile(*SaveManager->GetStorage(), TEXT("2"), File));
+		TestTrue("Other data is not encrypted", File.DataBytes.Num() > 0);
+	});
+
+	Describe("Pruning", [this]() {
+		BeforeEach([this]() {
+			TestPreset->MultithreadedFiles = ESaveASyncMode::OnlySync;
+			TestTrue("Saved", SaveManager->SaveSlot(0));
+			TestTrue("Saved", SaveManager->SaveSlot(1));
+			TestTrue("Saved", SaveManager->SaveSlot(2));
+		});
+
+		It("Prunes the oldest slots out of the retention limits", [this]() {
+			auto Storage = MakeShared<FTimedStorage, ESPMode::ThreadSafe>(SaveManager->GetStorage());
+			const FDateTime Now = FDateTime::UtcNow();
+			Storage->Timestamps.Add(TEXT("0"), Now - FTimespan::FromMinutes(3));
+			Storage->Timestamps.Add(TEXT("1"), Now - FTimespan::FromMinutes(2));
+			Storage->Timestamps.Add(TEXT("2"), Now - FTimespan::FromMinutes(1));
+
+			FSlotRetention Retention;
+			Retention.MaxSlots = 1;
+			FPruneSlotsTask Task{ Storage, Retention, TEXT("2"), SaveManager->GetSlotCache() };
+			Task.DoWork();
+
+			TestEqual("Deleted slots", Task.DeletedSlots.Num(), 2);
+			TestTrue("Kept slot exists", FFileAdapter::DoesFileExist(*Storage, TEXT("2")));
+			TestFalse("Old slot was deleted", FFileAdapter::DoesFileExist(*Storage, TEXT("0")));
+		});
+
+		It("Counts the kept slot in the retention limits", [this]() {
+			auto Storage = MakeShared<FTimedStorage, ESPMode::ThreadSafe>(SaveManager->GetStorage());
+			const FDateTime Now = FDateTime::UtcNow();
+			Storage->Timestamps.Add(TEXT("0"), Now - FTimespan::FromMinutes(3));
+			Storage->Timestamps.Add(TEXT("1"), Now - FTimespan::FromMinutes(2));
+			Storage->Timestamps.Add(TEXT("2"), Now - FTimespan::FromMinutes(1));
+
+			FSlotRetention Retention;
+			Retention.MaxSlots = 2;
+			FPruneSlotsTask Task{ Storage, Retention, TEXT("0"), SaveManager->GetSlotCache() };
+			Task.DoWork();
+
+			TestTrue("Only one slot was deleted", Task.DeletedSlots.Num() == 1 && Task.DeletedSlots[0] == TEXT("1"));
+			TestTrue("Kept slot exists", FFileAdapter::DoesFileExist(*Storage, TEXT("0")));
+			TestTrue("Newest slot exists", FFileAdapter::DoesFileExist(*Storage, TEXT("2")));
+		});
+
+		It("Breaks ties between slots saved at the same time by name", [this]() {
+			auto Storage = MakeShared<FTimedStorage, ESPMode::ThreadSafe>(SaveManager->GetStorage());
+			const FDateTime Now = FDateTime::UtcNow();
+			Storage->Timestamps.Add(TEXT("0"), Now - FTimespan::FromMinutes(2));
+			Storage->Timestamps.Add(TEXT("1"), Now - FTimespan::FromMinutes(1));
+			Storage->Timestamps.Add(TEXT("2"), Now - FTimespan::FromMinutes(1));
+
+			FSlotRetention Retention;
+			Retention.MaxSlots = 1;
+			FPruneSlotsTask Task{ Storage, Retention, {}, SaveManager->GetSlotCache() };
+			Task.DoWork();
+
+			TestTrue("First name was kept", FFileAdapter::DoesFileExist(*Storage, TEXT("1")));
+			TestFalse("Second name was deleted", FFileAdapter::DoesFileExist(*Storage, TEXT("2")));
+		});
+	});
+
+	It("Upgrades outdated slots", [this]() {
+		TestPreset->MultithreadedFiles = ESaveASyncMode::OnlySync;
+		TestTrue("Saved", SaveManager->SaveSlot(0));
+
+		FSaveFile File;
+		TestTrue("Read", FFileAdapter::ReadFile(*SaveManager->GetStorage(), TEXT("0"), File));
+		File.PackageFileUE4Version -= 1;
+		TestTrue("Slot is outdated", File.IsOutdated());
+		TestTrue("Saved", FFileAdapter::SaveFile(*SaveManager->GetStorage(), TEXT("0"), File, FSaveFileSettings{ false }));
+
+		FUpgradeSlotsTask Task{ SaveManager, {} };
+		Task.DoWork();
+		TestEqual("Outdated slots", Task.OutdatedSlots.Num(), 1);
+
+		SaveManager->UpgradeSlots();
+		TickWorldUntil(GetMainWorld(), true, [this](float) {
+			return SaveManager->IsUpgradingSlots();
+		});
+
+		TestTrue("Read", FFileAdapter::ReadFile(*SaveManager->GetStorage(), TEXT("0"), File));
+		TestFalse("Slot is outdated", File.IsOutdated());
+	});
+
 	AfterEach([this]() {
 		if (SaveManager)
 		{
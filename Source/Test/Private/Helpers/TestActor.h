@@ -5,6 +5,8 @@
 
 #include <CoreMinimal.h>
 #include <GameFramework/Actor.h>
+#include <Components/SceneComponent.h>
+#include "SaveExtensionInterface.h"
 #include "TestActor.generated.h"
 
 
@@ -16,12 +18,32 @@ struct FTestSaveStruct
 
 
 UCLASS()
-class ATestActor : public AActor
+class ATestActor : public AActor, public ISaveExtensionInterface
 {
     GENERATED_BODY()
 
 public:
 
+    ATestActor()
+    {
+        // A movable root is required to save transforms
+        RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+    }
+
+
+    // EVENTS (only counted if subscribed)
+
+    int32 NumSaveBegan = 0;
+    int32 NumSaveFinished = 0;
+    int32 NumLoadBegan = 0;
+    int32 NumLoadFinished = 0;
+
+    virtual void OnSaveBegan(const FSELevelFilter& Filter) override { ++NumSaveBegan; }
+    virtual void OnSaveFinished(const FSELevelFilter& Filter, bool bError) override { ++NumSaveFinished; }
+    virtual void OnLoadBegan(const FSELevelFilter& Filter) override { ++NumLoadBegan; }
+    virtual void OnLoadFinished(const FSELevelFilter& Filter, bool bError) override { ++NumLoadFinished; }
+
+
     UPROPERTY(SaveGame)
     bool bMyBool = false;
 
@@ -58,4 +80,16 @@ public:
 
     UPROPERTY(SaveGame)
     FTestSaveStruct MyStruct;
+
+
+    // ARRAYS
+
+    UPROPERTY(SaveGame)
+    TArray<int32> MyI32Array;
+
+    UPROPERTY(SaveGame)
+    TArray<FVector> MyVectorArray;
+
+    UPROPERTY(SaveGame)
+    TArray<AActor*> MyActorArray;
 };
@@ -2,7 +2,16 @@
 
 #include "Automatron.h"
 #include "Helpers/TestActor.h"
+#include "Misc/SaveShards.h"
 #include "SaveManager.h"
+#include "Serialization/ChunkedActorSerializer.h"
+#include "Serialization/InstancesRecord.h"
+#include "Serialization/LevelRecords.h"
+
+#include <Algo/IsSorted.h>
+#include <Components/InstancedStaticMeshComponent.h>
+#include <EngineUtils.h>
+#include <GameFramework/PlayerState.h>
 
 
 class FSaveSpec_Preset : public Automatron::FTestSpec
@@ -73,6 +82,192 @@ void FSaveSpec_Preset::Define()
 			TestTrue("Loaded", SaveManager->LoadSlot(0));
 		});
 
+		It("Sorts actor records canonically", [this]() {
+			ATestActor* OtherActor = GetMainWorld()->SpawnActor<ATestActor>();
+
+			FLevelRecord Record;
+			Record.Actors.Emplace(OtherActor);
+			Record.Actors.Emplace(TestActor);
+			Record.Actors.Emplace(GetMainWorld()->GetWorldSettings());
+			Record.SortActors();
+
+			TestTrue("Records are sorted", Algo::IsSorted(Record.Actors, FRecordOrder{}));
+			TestTrue("Finds first actor", Record.FindActorRecord(TestActor) && *Record.FindActorRecord(TestActor) == TestActor);
+			TestTrue("Finds second actor", Record.FindActorRecord(OtherActor) && *Record.FindActorRecord(OtherActor) == OtherActor);
+		});
+
+		It("Restores instance changes from the baseline", [this]() {
+			auto* Instances = NewObject<UInstancedStaticMeshComponent>(TestActor);
+			Instances->RegisterComponent();
+			const FTransform A{ FVector{ 0.f, 0.f, 0.f } };
+			const FTransform B{ FVector{ 100.f, 0.f, 0.f } };
+			const FTransform C{ FVector{ 200.f, 0.f, 0.f } };
+			Instances->AddInstances({ A, B, C }, false);
+			FInstanceBaselines::FindOrCapture(Instances);
+
+			// Saved state: B moved, D added
+			const FTransform Moved{ FRotator{ 0.f, 45.f, 0.f }, FVector{ 150.f, 0.f, 0.f } };
+			const FTransform D{ FVector{ 300.f, 0.f, 0.f } };
+			Instances->UpdateInstanceTransform(1, Moved, false, false, true);
+			Instances->AddInstance(D);
+
+			FInstancesRecord Record;
+			Record.Capture(Instances);
+			TestEqual("Only changes are recorded", Record.ModifiedIndices.Num() + Record.AddedTransforms.Num(), 2);
+
+			// Changed again after saving
+			Instances->UpdateInstanceTransform(0, C, false, false, true);
+			Instances->RemoveInstance(3);
+			Instances->RemoveInstance(2);
+
+			TestTrue("Applied", Record.Apply(Instances));
+			TestEqual("Instances were restored", Instances->GetInstanceCount(), 4);
+
+			const TArray<FTransform> Expected{ A, Moved, C, D };
+			for (int32 I = 0; I < Expected.Num() && I < Instances->GetInstanceCount(); ++I)
+			{
+				FTransform Transform;
+				Instances->GetInstanceTransform(I, Transform);
+				TestTrue(FString::Printf(TEXT("Instance %i was restored"), I), Transform.Equals(Expected[I], KINDA_SMALL_NUMBER));
+			}
+		});
+
+		It("Loads chunked object references", [this]() {
+			TestActor->MyActorArray.Init(TestActor, FChunkedActorSerializer::MinChunkElements * 2);
+
+			TArray<uint8> Data;
+			TestTrue("Saved in chunks", FChunkedActorSerializer::Save(TestActor, Data));
+
+			TestActor->MyActorArray.Empty();
+			TestTrue("Loaded", FChunkedActorSerializer::Load(TestActor, Data));
+			TestEqual("Array was restored", TestActor->MyActorArray.Num(), FChunkedActorSerializer::MinChunkElements * 2);
+			TestTrue("References were resolved", !TestActor->MyActorArray.ContainsByPredicate([this](const AActor* Actor) {
+				return Actor != TestActor;
+			}));
+		});
+
+		It("Rejects chunked records with corrupted sizes", [this]() {
+			TestActor->MyActorArray.Init(TestActor, FChunkedActorSerializer::MinChunkElements * 2);
+
+			TArray<uint8> Data;
+			TestTrue("Saved in chunks", FChunkedActorSerializer::Save(TestActor, Data));
+
+			// Number of containers follows the magic
+			const int32 NumContainers = MAX_int32;
+			FMemory::Memcpy(Data.GetData() + sizeof(int32), &NumContainers, sizeof(int32));
+			TestFalse("Not loaded", FChunkedActorSerializer::Load(TestActor, Data));
+
+			// Truncated chunks
+			Data.Empty();
+			TestTrue("Saved in chunks", FChunkedActorSerializer::Save(TestActor, Data));
+			Data.SetNum(Data.Num() / 2);
+			TestFalse("Truncated record not loaded", FChunkedActorSerializer::Load(TestActor, Data));
+		});
+
+		It("Forgets large actors when emptied", [this]() {
+			FLargeActorSizes Sizes;
+			Sizes.RecordSize(TestActor, 2048, 1024);
+			TestTrue("Actor is large", Sizes.IsLarge(TestActor, 1024));
+
+			Sizes.Empty();
+			TestFalse("Actor was forgotten", Sizes.IsLarge(TestActor, 1024));
+		});
+
+		It("Can restore an actor from a snapshot", [this]() {
+			TestPreset->MultithreadedSerialization = ESaveASyncMode::OnlySync;
+			TestPreset->MaxSnapshots = 2;
+
+			TestActor->MyI32 = 34;
+			TestTrue("Snapshot taken", SaveManager->TakeSnapshot());
+			TestActor->MyI32 = 56;
+			TestTrue("Snapshot taken", SaveManager->TakeSnapshot());
+			TestActor->MyI32 = 78;
+			TestTrue("Snapshot taken", SaveManager->TakeSnapshot());
+			TestEqual("Oldest snapshot was discarded", SaveManager->GetNumSnapshots(), 2);
+
+			TestTrue("Restored", SaveManager->RestoreSnapshot(0));
+			TickUntilSaveTasksFinish();
+			TestEqual("int32 was restored", TestActor->MyI32, 56);
+			TestEqual("Newer snapshots were discarded", SaveManager->GetNumSnapshots(), 1);
+		});
+
+		It("Restores actor transforms", [this]() {
+			TestPreset->MultithreadedSerialization = ESaveASyncMode::OnlySync;
+
+			const FVector SavedLocation{ 100.f, 200.f, 300.f };
+			TestActor->SetActorLocation(SavedLocation);
+			TestActor->MyI32 = 34;
+			TestTrue("Saved", SaveManager->SaveSlot(0));
+
+			TestActor->SetActorLocation(FVector::ZeroVector);
+			TestActor->MyI32 = 56;
+			TestTrue("Loaded", SaveManager->LoadSlot(0));
+			TickUntilSaveTasksFinish();
+
+			TestTrue("Transform was restored", TestActor->GetActorLocation().Equals(SavedLocation));
+			TestEqual("int32 was restored", TestActor->MyI32, 34);
+		});
+
+		It("Can save and load a subset of actors", [this]() {
+			TestPreset->MultithreadedSerialization = ESaveASyncMode::OnlySync;
+			SaveManager->SubscribeForEvents(TestActor);
+
+			ATestActor* OtherActor = GetMainWorld()->SpawnActor<ATestActor>();
+			TestActor->MyI32 = 34;
+			OtherActor->MyI32 = 56;
+			TestTrue("Saved", SaveManager->SaveActors(TEXT("TestSubset"), { TestActor, OtherActor }));
+			TickUntilSaveTasksFinish();
+			TestEqual("Save events are paired", TestActor->NumSaveBegan, 1);
+			TestEqual("Save events are paired", TestActor->NumSaveFinished, 1);
+
+			// Missing actors must not be respawned
+			OtherActor->Destroy();
+			TestActor->MyI32 = 78;
+			TestTrue("Loaded", SaveManager->LoadActors(TEXT("TestSubset")));
+			TickUntilSaveTasksFinish();
+			TestEqual("int32 was restored", TestActor->MyI32, 34);
+			TestEqual("Load events are paired", TestActor->NumLoadBegan, 1);
+			TestEqual("Load events are paired", TestActor->NumLoadFinished, 1);
+
+			int32 NumActors = 0;
+			for (TActorIterator<ATestActor> It(GetMainWorld()); It; ++It)
+			{
+				++NumActors;
+			}
+			TestEqual("Unmatched actors were skipped", NumActors, 1);
+
+			SaveManager->UnsubscribeFromEvents(TestActor);
+		});
+
+		It("Loads player shards in a new session", [this]() {
+			TestPreset->MultithreadedSerialization = ESaveASyncMode::OnlySync;
+
+			APlayerState* Player = GetMainWorld()->SpawnActor<APlayerState>();
+			Player->Tags.Add(FSaveShards::MakeOwnerTag(TEXT("TestPlayer")));
+			TestActor->SetOwner(Player);
+			TestActor->MyI32 = 34;
+			TestTrue("Saved", SaveManager->SavePlayerShard(Player));
+			TickUntilSaveTasksFinish();
+
+			// Player actors are spawned again with other names
+			TestActor->Destroy();
+			TestActor = GetMainWorld()->SpawnActor<ATestActor>();
+			TestActor->SetOwner(Player);
+			TestTrue("Loaded", SaveManager->LoadPlayerShard(Player));
+			TickUntilSaveTasksFinish();
+			TestEqual("int32 was restored", TestActor->MyI32, 34);
+
+			Player->Destroy();
+		});
+
+		It("Doesn't save shards of players without a persistent id", [this]() {
+			APlayerState* Player = GetMainWorld()->SpawnActor<APlayerState>();
+			TestTrue("Player has no id", FSaveShards::GetPlayerId(Player).IsEmpty());
+			TestFalse("Not saved", SaveManager->SavePlayerShard(Player));
+
+			Player->Destroy();
+		});
+
 		xIt("Can save an actor asynchronously", [this]() {
 			TestNotImplemented();
 		});
@@ -182,6 +377,20 @@ void FSaveSpec_Preset::Define()
 				SaveManager->LoadSlot(0);
 				TestEqual("int64 was saved", TestActor->MyI64, 34);
 			});
+
+			It("Arrays of plain data", [this]()
+			{
+				TestActor->MyI32Array = { 3, 4, 5 };
+				TestActor->MyVectorArray = { FVector{ 1.f, 2.f, 3.f } };
+				SaveManager->SaveSlot(0);
+
+				TestActor->MyI32Array.Empty();
+				TestActor->MyVectorArray.Empty();
+				SaveManager->LoadSlot(0);
+
+				TestTrue("int32 array was saved", TestActor->MyI32Array == TArray<int32>{ 3, 4, 5 });
+				TestTrue("FVector array was saved", TestActor->MyVectorArray.Num() == 1 && TestActor->MyVectorArray[0] == FVector{ 1.f, 2.f, 3.f });
+			});
 		});
 
 		AfterEach([this]() {